@@ -0,0 +1,187 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines the ApproximateTimeSynchronizer class for synchronizing messages from multiple topics by their stamps.
+ */
+
+#ifndef APPROXIMATE_TIME_SYNCHRONIZER_H
+#define APPROXIMATE_TIME_SYNCHRONIZER_H
+
+#include <mrs_lib/subscribe_handler.h>
+#include <ros/message_traits.h>
+#include <array>
+#include <tuple>
+#include <mutex>
+
+namespace mrs_lib
+{
+
+  /* ApproximateTimeSynchronizer class //{ */
+  /**
+  * \brief Synchronizes messages from multiple topics by the stamps in their headers.
+  *
+  * Each topic is handled by a SubscribeHandler, whose messages are kept in a small preallocated queue. Whenever the
+  * oldest messages in all the queues have stamps within the \p max_slop duration of each other, they are removed from
+  * the queues and passed to the callback together. If the oldest messages are farther apart, the one with the oldest
+  * stamp can no longer be matched (all messages of the topic with the newest stamp are even newer), so it is dropped.
+  *
+  * The callback is therefore called as soon as the last message of a matching tuple is received. A message, which is
+  * not matched, waits in its queue at most until \p queue_length newer messages are received on its topic.
+  * Messages with a stamp older than the last message on the same topic are dropped.
+  *
+  * No memory is allocated when matching the messages (apart from the allocations done by ROS when receiving them).
+  * Counts of the matched and dropped messages may be obtained using the getStatistics() method.
+  *
+  * The class is thread-safe and the callback is called without the mutex protecting the queues locked, so new messages
+  * are queued while it runs. The calls of the callback are serialized (even with multiple spinner threads), so the
+  * matched tuples are delivered one at a time and in the order of their stamps.
+  *
+  */
+  template <typename... MessageTypes>
+  class ApproximateTimeSynchronizer
+  {
+    static_assert(sizeof...(MessageTypes) >= 2, "At least two topics are necessary for synchronization!");
+    static_assert((ros::message_traits::HasHeader<MessageTypes>::value && ...), "All the synchronized messages have to contain a header!");
+
+  public:
+    /*!
+      * \brief Number of the synchronized topics.
+      */
+    static constexpr size_t n_topics = sizeof...(MessageTypes);
+
+    /*!
+      * \brief Type for the callback function, which receives one message from each topic.
+      */
+    using callback_t = std::function<void(const typename MessageTypes::ConstPtr&...)>;
+
+    /*!
+      * \brief Counts of the matched and dropped messages.
+      */
+    struct statistics_t
+    {
+      uint64_t n_matched = 0;                       /*!< \brief Number of the tuples passed to the callback. */
+      std::array<uint64_t, n_topics> n_received{};  /*!< \brief Number of the messages received on each topic. */
+      std::array<uint64_t, n_topics> n_dropped{};   /*!< \brief Number of the messages of each topic, which were not matched. */
+      ros::Duration max_spread;                     /*!< \brief The largest difference between the stamps of the messages in a matched tuple. */
+    };
+
+  public:
+    /*!
+      * \brief The main constructor.
+      *
+      * \param options      The common options for the SubscribeHandler objects of all topics (see documentation of SubscribeHandlerOptions, the topic name is ignored).
+      * \param topic_names  Names of the synchronized topics in the same order as the \p MessageTypes.
+      * \param max_slop     The largest difference between the stamps of the messages, which are still considered to be matching.
+      * \param callback     The function to be called with each matched tuple of messages.
+      * \param queue_length Number of the last messages of each topic, which are kept for matching.
+      *
+      */
+    ApproximateTimeSynchronizer(const SubscribeHandlerOptions& options, const std::array<std::string, n_topics>& topic_names, const ros::Duration& max_slop,
+                                const callback_t& callback, const size_t queue_length = 10);
+
+    // the SubscribeHandler objects keep a pointer to this object in their callbacks
+    ApproximateTimeSynchronizer(const ApproximateTimeSynchronizer&) = delete;
+    ApproximateTimeSynchronizer& operator=(const ApproximateTimeSynchronizer&) = delete;
+
+    /*!
+      * \brief Returns the counts of the matched and dropped messages since the construction or since the last call to resetStatistics().
+      *
+      * \return the current statistics.
+      */
+    statistics_t getStatistics() const;
+
+    /*!
+      * \brief Resets all the counts of the matched and dropped messages to zero.
+      */
+    void resetStatistics();
+
+    /*!
+      * \brief Removes all messages from the queues without calling the callback.
+      *
+      * The removed messages are not counted as dropped.
+      */
+    void clear();
+
+    /*!
+      * \brief Enables the callbacks of the handlers of all topics (see SubscribeHandler::start()).
+      */
+    void start();
+
+    /*!
+      * \brief Disables the callbacks of the handlers of all topics (see SubscribeHandler::stop()).
+      */
+    void stop();
+
+  private:
+    // a preallocated ring buffer of the messages of a single topic
+    template <typename MessageType>
+    struct queue_t
+    {
+      std::vector<typename MessageType::ConstPtr> msgs;
+      std::vector<ros::Time> stamps;
+      size_t start = 0;
+      size_t size = 0;
+
+      bool empty() const
+      {
+        return size == 0;
+      }
+      bool full() const
+      {
+        return size == msgs.size();
+      }
+      const ros::Time& frontStamp() const
+      {
+        return stamps[start];
+      }
+      const ros::Time& backStamp() const
+      {
+        return stamps[(start + size - 1) % stamps.size()];
+      }
+      void push(const typename MessageType::ConstPtr& msg, const ros::Time& stamp)
+      {
+        const size_t index = (start + size) % msgs.size();
+        msgs[index] = msg;
+        stamps[index] = stamp;
+        size++;
+      }
+      typename MessageType::ConstPtr pop()
+      {
+        typename MessageType::ConstPtr ret = std::move(msgs[start]);
+        msgs[start] = nullptr;
+        start = (start + 1) % msgs.size();
+        size--;
+        return ret;
+      }
+    };
+
+    using messages_t = std::tuple<typename MessageTypes::ConstPtr...>;
+    using indices_t = std::index_sequence_for<MessageTypes...>;
+
+    mutable std::mutex m_mtx;
+    // serializes the matching and calls of the callback
+    std::mutex m_callback_mtx;
+    const ros::Duration m_max_slop;
+    const callback_t m_callback;
+    std::tuple<queue_t<MessageTypes>...> m_queues;
+    statistics_t m_statistics;
+
+    std::tuple<SubscribeHandler<MessageTypes>...> m_handlers;
+
+    template <size_t... Is>
+    void construct_handlers(const SubscribeHandlerOptions& options, const std::array<std::string, n_topics>& topic_names, std::index_sequence<Is...>);
+
+    // adds a new message of the I-th topic to its queue and calls the callback for all the matches found
+    template <size_t I>
+    void message_callback(const typename std::tuple_element_t<I, messages_t>& msg);
+
+    // finds the next matching tuple and removes it from the queues, returns false if there is none
+    template <size_t... Is>
+    bool find_match(messages_t& matched, std::index_sequence<Is...>);
+  };
+  //}
+
+}  // namespace mrs_lib
+
+#include <mrs_lib/impl/approximate_time_synchronizer.hpp>
+
+#endif  // APPROXIMATE_TIME_SYNCHRONIZER_H
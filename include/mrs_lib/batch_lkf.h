@@ -0,0 +1,390 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines BatchLKF - a class, implementing many Linear Kalman Filters with the same system model, updated at once.
+ */
+#ifndef BATCH_LKF_H
+#define BATCH_LKF_H
+
+#include <mrs_lib/lkf.h>
+#include <cmath>
+
+namespace mrs_lib
+{
+
+  /* class BatchLKF //{ */
+  /**
+  * \brief Implementation of a batch of Linear Kalman filters \cite LKF with shared system matrices.
+  *
+  * When tracking many independent targets with the same system model (eg. multiple objects with the same dynamics), it
+  * is inefficient to keep an LKF instance for each of them and to update them one by one. This class stores the states
+  * and covariances of N filters in a structure-of-arrays layout - each element of the state vector or the covariance
+  * matrix is stored as a contiguous row over all the filters. All the arithmetic of the predict() and correct() methods
+  * is thus expressed as operations on these rows, which the compiler vectorizes across the filters (using SIMD).
+  *
+  * The filters share the system matrices #A, #B and #H, and the process and measurement noise covariances passed
+  * to the predict() and correct() methods. The mathematics is the same as in the LKF class, so the results are
+  * identical (up to the floating-point rounding) to N separate LKF objects. The state and covariance of each filter may
+  * be accessed using the get() and set() methods with the same statecov_t semantics as for the LKF.
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements>
+  class BatchLKF
+  {
+    static_assert(n_states > 0 && n_inputs >= 0 && n_measurements > 0, "BatchLKF only supports fixed-size states, inputs and measurements!");
+
+  public:
+    /* BatchLKF definitions (typedefs, constants etc) //{ */
+    static constexpr int n = n_states;            /*!< \brief Length of the state vector of the system. */
+    static constexpr int m = n_inputs;            /*!< \brief Length of the input vector of the system. */
+    static constexpr int p = n_measurements;      /*!< \brief Length of the measurement vector of the system. */
+    using LKF_t = LKF<n, m, p>;                   /*!< \brief The corresponding single-filter LKF class. */
+
+    using x_t = typename LKF_t::x_t;                /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename LKF_t::u_t;                /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename LKF_t::z_t;                /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename LKF_t::P_t;                /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename LKF_t::R_t;                /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename LKF_t::Q_t;                /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using A_t = typename LKF_t::A_t;                /*!< \brief System transition matrix type \f$n \times n\f$ */
+    using B_t = typename LKF_t::B_t;                /*!< \brief Input to state mapping matrix type \f$n \times m\f$ */
+    using H_t = typename LKF_t::H_t;                /*!< \brief State to measurement mapping matrix type \f$p \times n\f$ */
+    using statecov_t = typename LKF_t::statecov_t;  /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using inverse_exception = typename LKF_t::inverse_exception;  /*!< \brief Thrown when the innovation covariance of some filter is not invertible. */
+
+    using Xs_t = Eigen::Matrix<double, n, Eigen::Dynamic, Eigen::RowMajor>;  /*!< \brief States of all the filters (one column per filter) \f$n \times N\f$ */
+    using Us_t = Eigen::Matrix<double, m, Eigen::Dynamic, Eigen::RowMajor>;  /*!< \brief Inputs of all the filters (one column per filter) \f$m \times N\f$ */
+    using Zs_t = Eigen::Matrix<double, p, Eigen::Dynamic, Eigen::RowMajor>;  /*!< \brief Measurements of all the filters (one column per filter) \f$p \times N\f$ */
+    using mask_t = Eigen::Array<bool, 1, Eigen::Dynamic>;                    /*!< \brief Mask selecting a subset of the filters \f$1 \times N\f$ */
+    //}
+
+  public:
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * before using this class, otherwise the BatchLKF object is invalid (not initialized).
+    */
+    BatchLKF(){};
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param A             The state transition matrix.
+    * \param B             The input to state mapping matrix.
+    * \param H             The state to measurement mapping matrix.
+    * \param n_filters     Number of the filters in the batch.
+    * \param x0            Initial state of all the filters.
+    * \param P0            Initial state covariance of all the filters.
+    */
+    BatchLKF(const A_t& A, const B_t& B, const H_t& H, const int n_filters, const x_t& x0, const P_t& P0)
+      : A(A), B(B), H(H), m_n_filters(n_filters), m_xs(n, n_filters), m_Ps(n * n, n_filters), m_xs_tmp(n, n_filters), m_tmp(n * n, n_filters), m_HPs(n * p, n_filters),
+        m_Ws(p * p, n_filters), m_Ks(n * p, n_filters), m_inns(p, n_filters)
+    {
+      for (int it = 0; it < n_filters; it++)
+        set(it, {x0, P0});
+    };
+
+    /* size() method //{ */
+  /*!
+    * \brief Returns the number of the filters in the batch.
+    *
+    * \return            The number of the filters.
+    */
+    int size() const
+    {
+      return m_n_filters;
+    }
+    //}
+
+    /* get() method //{ */
+  /*!
+    * \brief Returns the state and covariance of a single filter.
+    *
+    * \param idx         Index of the filter.
+    * \return            The state and covariance of the filter.
+    */
+    statecov_t get(const int idx) const
+    {
+      assert(idx >= 0 && idx < m_n_filters);
+      statecov_t ret;
+      ret.x = m_xs.col(idx);
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          ret.P(r, c) = m_Ps(r * n + c, idx);
+      return ret;
+    }
+    //}
+
+    /* set() method //{ */
+  /*!
+    * \brief Sets the state and covariance of a single filter (eg. to reset it when tracking of a new target starts).
+    *
+    * \param idx         Index of the filter.
+    * \param sc          The new state and covariance of the filter.
+    */
+    void set(const int idx, const statecov_t& sc)
+    {
+      assert(idx >= 0 && idx < m_n_filters);
+      m_xs.col(idx) = sc.x;
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          m_Ps(r * n + c, idx) = sc.P(r, c);
+    }
+    //}
+
+    /* states() method //{ */
+  /*!
+    * \brief Returns the states of all the filters.
+    *
+    * \return            The states (one column per filter).
+    */
+    const Xs_t& states() const
+    {
+      return m_xs;
+    }
+    //}
+
+    /* predict() method //{ */
+  /*!
+    * \brief Applies the prediction (time) step of the Kalman filter to all the filters.
+    *
+    * This is equivalent to calling LKF::predict() for each of the filters with the corresponding input.
+    *
+    * \param us          The input vectors of the filters (one column per filter).
+    * \param Q           The process noise covariance matrix to be used for prediction.
+    * \param dt          Used to scale the process noise covariance \p Q.
+    */
+    void predict(const Us_t& us, const Q_t& Q, const double dt)
+    {
+      assert(us.cols() == m_n_filters);
+      // x = A*x + B*u
+      m_xs_tmp.noalias() = A * m_xs;
+      if constexpr (m > 0)
+        m_xs_tmp.noalias() += B * us;
+      m_xs.swap(m_xs_tmp);
+      covariancePredict(Q, dt);
+    }
+
+  /*!
+    * \brief Applies the prediction (time) step of the Kalman filter to all the filters with the same input.
+    *
+    * \param u           The input vector to be used for all the filters.
+    * \param Q           The process noise covariance matrix to be used for prediction.
+    * \param dt          Used to scale the process noise covariance \p Q.
+    */
+    void predict(const u_t& u, const Q_t& Q, const double dt)
+    {
+      m_xs_tmp.noalias() = A * m_xs;
+      if constexpr (m > 0)
+        m_xs_tmp.colwise() += B * u;
+      m_xs.swap(m_xs_tmp);
+      covariancePredict(Q, dt);
+    }
+    //}
+
+    /* correct() method //{ */
+  /*!
+    * \brief Applies the correction (update, measurement, data) step of the Kalman filter to all the filters.
+    *
+    * This is equivalent to calling LKF::correct() for each of the filters with the corresponding measurement.
+    *
+    * \param zs          The measurement vectors of the filters (one column per filter).
+    * \param R           The measurement noise covariance matrix to be used for correction.
+    *
+    * \throws inverse_exception if the innovation covariance of some of the filters is not positive definite.
+    */
+    void correct(const Zs_t& zs, const R_t& R)
+    {
+      assert(zs.cols() == m_n_filters);
+      computeCorrection(zs, R);
+      for (int c = 0; c < p; c++)
+        if (!(m_Ws.row(c * p + c).array() > 0.0).all())
+          throw inverse_exception();
+      applyCorrection();
+    }
+
+  /*!
+    * \brief Applies the correction (update, measurement, data) step of the Kalman filter to a subset of the filters.
+    *
+    * The computation is still done for all the filters (to keep it vectorized), but only the filters selected by the mask are updated.
+    *
+    * \param zs          The measurement vectors of the filters (one column per filter, values of the unselected filters are ignored).
+    * \param R           The measurement noise covariance matrix to be used for correction.
+    * \param mask        Selects the filters, which should be corrected.
+    *
+    * \throws inverse_exception if the innovation covariance of some of the selected filters is not positive definite.
+    */
+    void correct(const Zs_t& zs, const R_t& R, const mask_t& mask)
+    {
+      assert(zs.cols() == m_n_filters && mask.cols() == m_n_filters);
+      // replace the measurements of the unselected filters with their expected values so that they do not produce NaNs
+      m_inns.noalias() = H * m_xs;
+      for (int r = 0; r < p; r++)
+        m_inns.row(r) = mask.select(zs.row(r), m_inns.row(r));
+      computeCorrection(m_inns, R);
+      // only the decompositions of the selected filters have to be valid
+      for (int c = 0; c < p; c++)
+        if (!(m_Ws.row(c * p + c).array() > 0.0 || !mask).all())
+          throw inverse_exception();
+      // zero-out the Kalman gains of the unselected filters
+      for (int r = 0; r < n * p; r++)
+        m_Ks.row(r) = mask.select(m_Ks.row(r), 0.0);
+      applyCorrection();
+    }
+    //}
+
+  public:
+    A_t A;  /*!< \brief The system transition matrix \f$n \times n\f$ */
+    B_t B;  /*!< \brief The input to state mapping matrix \f$n \times m\f$ */
+    H_t H;  /*!< \brief The state to measurement mapping matrix \f$p \times n\f$ */
+
+  private:
+    // rows of the covariance matrices of all the filters, indexed by (row, column) of the covariance matrix
+    using Ps_t = Eigen::Matrix<double, n * n, Eigen::Dynamic, Eigen::RowMajor>;
+    // helper n*p, p*p and p*1 matrices of all the filters in the same layout
+    using HPs_t = Eigen::Matrix<double, n * p, Eigen::Dynamic, Eigen::RowMajor>;
+    using Ws_t = Eigen::Matrix<double, p * p, Eigen::Dynamic, Eigen::RowMajor>;
+
+    int m_n_filters = 0;
+    Xs_t m_xs;
+    Ps_t m_Ps;
+    // preallocated temporaries to avoid allocations during the updates
+    Xs_t m_xs_tmp;
+    Ps_t m_tmp;
+    HPs_t m_HPs;
+    Ws_t m_Ws;
+    HPs_t m_Ks;
+    Zs_t m_inns;
+
+    /* covariancePredict() method //{ */
+    void covariancePredict(const Q_t& Q, const double dt)
+    {
+      // tmp = A*P
+      for (int r = 0; r < n; r++)
+      {
+        for (int c = 0; c < n; c++)
+        {
+          auto tmp_row = m_tmp.row(r * n + c);
+          tmp_row.setZero();
+          for (int k = 0; k < n; k++)
+            if (A(r, k) != 0.0)
+              tmp_row += A(r, k) * m_Ps.row(k * n + c);
+        }
+      }
+      // P = tmp*A^T + dt*Q
+      for (int r = 0; r < n; r++)
+      {
+        for (int c = 0; c < n; c++)
+        {
+          auto P_row = m_Ps.row(r * n + c);
+          P_row.setConstant(dt * Q(r, c));
+          for (int k = 0; k < n; k++)
+            if (A(c, k) != 0.0)
+              P_row += A(c, k) * m_tmp.row(r * n + k);
+        }
+      }
+    }
+    //}
+
+    /* computeCorrection() method //{ */
+    // calculates the Kalman gains (m_Ks) and innovations (m_inns) of all the filters
+    // (the diagonal of the decomposition in m_Ws is not positive for filters with an invalid innovation covariance,
+    // which has to be checked by the caller)
+    void computeCorrection(const Zs_t& zs, const R_t& R)
+    {
+      // HP = P*H^T (stored as n*p)
+      for (int r = 0; r < n; r++)
+      {
+        for (int c = 0; c < p; c++)
+        {
+          auto HP_row = m_HPs.row(r * p + c);
+          HP_row.setZero();
+          for (int k = 0; k < n; k++)
+            if (H(c, k) != 0.0)
+              HP_row += H(c, k) * m_Ps.row(r * n + k);
+        }
+      }
+
+      // W = H*P*H^T + R
+      for (int r = 0; r < p; r++)
+      {
+        for (int c = 0; c <= r; c++)
+        {
+          auto W_row = m_Ws.row(r * p + c);
+          W_row.setConstant(R(r, c));
+          for (int k = 0; k < n; k++)
+            if (H(r, k) != 0.0)
+              W_row += H(r, k) * m_HPs.row(k * p + c);
+        }
+      }
+
+      // in-place Cholesky decomposition W = L*L^T (only the lower triangle is used)
+      for (int c = 0; c < p; c++)
+      {
+        auto L_cc = m_Ws.row(c * p + c).array();
+        for (int k = 0; k < c; k++)
+          L_cc -= m_Ws.row(c * p + k).array().square();
+        L_cc = L_cc.sqrt();
+        for (int r = c + 1; r < p; r++)
+        {
+          auto L_rc = m_Ws.row(r * p + c).array();
+          for (int k = 0; k < c; k++)
+            L_rc -= m_Ws.row(r * p + k).array() * m_Ws.row(c * p + k).array();
+          L_rc /= L_cc;
+        }
+      }
+
+      // K = P*H^T*W^-1, so W*K^T = H*P - solve using the Cholesky decomposition for each row of K
+      for (int r = 0; r < n; r++)
+      {
+        // forward substitution L*y = (P*H^T)^T
+        for (int c = 0; c < p; c++)
+        {
+          auto K_rc = m_Ks.row(r * p + c).array();
+          K_rc = m_HPs.row(r * p + c).array();
+          for (int k = 0; k < c; k++)
+            K_rc -= m_Ws.row(c * p + k).array() * m_Ks.row(r * p + k).array();
+          K_rc /= m_Ws.row(c * p + c).array();
+        }
+        // backward substitution L^T*k = y
+        for (int c = p - 1; c >= 0; c--)
+        {
+          auto K_rc = m_Ks.row(r * p + c).array();
+          for (int k = c + 1; k < p; k++)
+            K_rc -= m_Ws.row(k * p + c).array() * m_Ks.row(r * p + k).array();
+          K_rc /= m_Ws.row(c * p + c).array();
+        }
+      }
+
+      // innovation z - H*x
+      m_inns = zs;
+      m_inns.noalias() -= H * m_xs;
+    }
+    //}
+
+    /* applyCorrection() method //{ */
+    // applies the Kalman gains (m_Ks) and innovations (m_inns) to the states and covariances of all the filters
+    void applyCorrection()
+    {
+      // x = x + K*(z - H*x)
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < p; c++)
+          m_xs.row(r) += m_Ks.row(r * p + c).cwiseProduct(m_inns.row(c));
+
+      // P = (I - K*H)*P = P - K*(P*H^T)^T
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          for (int k = 0; k < p; k++)
+            m_Ps.row(r * n + c) -= m_Ks.row(r * p + k).cwiseProduct(m_HPs.row(c * p + k));
+    }
+    //}
+  };
+  //}
+
+}  // namespace mrs_lib
+
+#endif  // BATCH_LKF_H
@@ -0,0 +1,274 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines ConcurrentRepredictor - a Repredictor with a lock-free intake for inputs and measurements from multiple threads.
+ */
+#ifndef CONCURRENT_REPREDICTOR_H
+#define CONCURRENT_REPREDICTOR_H
+
+#include <atomic>
+#include <vector>
+#include <ros/ros.h>
+#include <mrs_lib/repredictor.h>
+#include <mrs_lib/mpsc_queue.h>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Repredictor with a lock-free intake for system inputs and measurements from multiple threads.
+   *
+   * The standard Repredictor is not thread-safe, so all threads adding inputs or measurements to it have to synchronize
+   * with the thread, which requests the predictions. With this class, any thread (eg. a subscriber callback) may
+   * call the enqueue*() methods, which only push the data to a bounded lock-free queue and never block (if the queue
+   * is full, the data is dropped and only counted, see droppedCount()). The queued data are then added to the history buffer
+   * by the owner thread before each call to predictTo() (or explicitly using processQueued()), so the reprediction never
+   * blocks the callbacks. The dropped data are also reported by the owner thread.
+   *
+   * \note Only a single thread (the owner) may call predictTo(), processQueued() and the add*() methods inherited from the Repredictor.
+   *
+   * \tparam Model  the prediction and correction model (eg. a Kalman Filter).
+   *
+   */
+  template <class Model>
+  class ConcurrentRepredictor : public Repredictor<Model>
+  {
+  public:
+    /* states, inputs etc. definitions (typedefs, constants etc) //{ */
+
+    using Base_class = Repredictor<Model>;                 /*!< \brief Base class of this class. */
+    using x_t = typename Base_class::x_t;                  /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Base_class::u_t;                  /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename Base_class::z_t;                  /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename Base_class::P_t;                  /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename Base_class::R_t;                  /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename Base_class::Q_t;                  /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename Base_class::statecov_t;    /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using ModelPtr = typename Base_class::ModelPtr;        /*!< \brief Shorthand type for a shared pointer-to-Model */
+    using measurement_t = typename Base_class::measurement_t; /*!< \brief Helper struct for passing multiple measurements at once */
+
+    //}
+
+  public:
+    /* constructor //{ */
+    /*!
+     * \brief The main constructor.
+     *
+     * Initializes the ConcurrentRepredictor with the necessary initial and default values.
+     *
+     * \param x0             Initial state.
+     * \param P0             Covariance matrix of the initial state uncertainty.
+     * \param u0             Initial system input.
+     * \param Q0             Default covariance matrix of the process noise.
+     * \param t0             Time stamp of the initial state.
+     * \param model          Default prediction and correction model.
+     * \param hist_len       Length of the history buffer for system inputs and measurements.
+     * \param queue_len      Length of the intake queue (maximal number of inputs and measurements queued between two calls to processQueued()).
+     */
+    ConcurrentRepredictor(const x_t& x0, const P_t& P0, const u_t& u0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model, const unsigned hist_len,
+                          const unsigned queue_len)
+        : Base_class(x0, P0, u0, Q0, t0, model, hist_len), m_queue(queue_len), m_dropped(0)
+    {
+      m_measurements.reserve(m_queue.capacity());
+    };
+    //}
+
+    /* enqueue*() methods //{ */
+    /*!
+     * \brief Queues one system input to be added to the history buffer. May be called from any thread and never blocks.
+     *
+     * \param u      The system input vector to be added.
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the input vector and covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this input (nullptr means the default one).
+     * \return       true if the input was queued, false if the queue was full and the input was dropped.
+     */
+    bool enqueueInputChangeWithNoise(const u_t& u, const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      intake_t intake;
+      intake.type = intake_type_t::input_with_noise;
+      intake.u = u;
+      intake.Q = Q;
+      intake.stamp = stamp;
+      intake.model = model;
+      return enqueue(std::move(intake));
+    }
+
+    /*!
+     * \brief Queues one system input to be added to the history buffer. May be called from any thread and never blocks.
+     *
+     * \param u      The system input vector to be added.
+     * \param stamp  Time stamp of the input vector.
+     * \param model  Optional pointer to a specific Model to be used with this input (nullptr means the default one).
+     * \return       true if the input was queued, false if the queue was full and the input was dropped.
+     */
+    bool enqueueInputChange(const u_t& u, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      intake_t intake;
+      intake.type = intake_type_t::input;
+      intake.u = u;
+      intake.stamp = stamp;
+      intake.model = model;
+      return enqueue(std::move(intake));
+    }
+
+    /*!
+     * \brief Queues one process noise change to be added to the history buffer. May be called from any thread and never blocks.
+     *
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this covariance matrix (nullptr means the default one).
+     * \return       true if the process noise change was queued, false if the queue was full and it was dropped.
+     */
+    bool enqueueProcessNoiseChange(const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      intake_t intake;
+      intake.type = intake_type_t::process_noise;
+      intake.Q = Q;
+      intake.stamp = stamp;
+      intake.model = model;
+      return enqueue(std::move(intake));
+    }
+
+    /*!
+     * \brief Queues one measurement to be added to the history buffer. May be called from any thread and never blocks.
+     *
+     * \param z        The measurement vector to be added.
+     * \param R        The measurement noise covariance matrix, corresponding to the measurement vector.
+     * \param stamp    Time stamp of the measurement vector and covariance matrix.
+     * \param model    Optional pointer to a specific Model to be used with this measurement (nullptr means the default one).
+     * \param meas_id  Optional ID of the measurement.
+     * \return         true if the measurement was queued, false if the queue was full and the measurement was dropped.
+     */
+    bool enqueueMeasurement(const z_t& z, const R_t& R, const ros::Time& stamp, const ModelPtr& model = nullptr, const int meas_id = -1)
+    {
+      intake_t intake;
+      intake.type = intake_type_t::measurement;
+      intake.meas.z = z;
+      intake.meas.R = R;
+      intake.meas.stamp = stamp;
+      intake.meas.model = model;
+      intake.meas.meas_id = meas_id;
+      intake.stamp = stamp;
+      return enqueue(std::move(intake));
+    }
+    //}
+
+    /* processQueued() method //{ */
+    /*!
+     * \brief Adds all queued system inputs and measurements to the history buffer.
+     *
+     * This method is called automatically by predictTo(). It may only be called from the owner thread.
+     * The system inputs are added first in the order in which they were queued and then all the measurements
+     * are merged into the history buffer at once. If some data were dropped since the last call because
+     * the queue was full, a (throttled) warning is printed.
+     */
+    void processQueued()
+    {
+      intake_t intake;
+      while (m_queue.pop(intake))
+      {
+        switch (intake.type)
+        {
+          case intake_type_t::input_with_noise:
+            Base_class::addInputChangeWithNoise(intake.u, intake.Q, intake.stamp, intake.model);
+            break;
+          case intake_type_t::input:
+            Base_class::addInputChange(intake.u, intake.stamp, intake.model);
+            break;
+          case intake_type_t::process_noise:
+            Base_class::addProcessNoiseChange(intake.Q, intake.stamp, intake.model);
+            break;
+          case intake_type_t::measurement:
+            m_measurements.push_back(std::move(intake.meas));
+            break;
+        }
+      }
+      if (!m_measurements.empty())
+      {
+        Base_class::addMeasurements(m_measurements);
+        m_measurements.clear();
+      }
+
+      // the overflow is only counted by the producers to keep them cheap, so it is reported here
+      const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+      if (dropped != m_dropped_reported)
+      {
+        ROS_WARN_THROTTLE(1.0, "[ConcurrentRepredictor]: Intake queue was full (%zu elements), %lu inputs and measurements were dropped so far! Call predictTo() more often or increase the queue length.", m_queue.capacity(), static_cast<unsigned long>(dropped));
+        m_dropped_reported = dropped;
+      }
+    }
+    //}
+
+    /* predictTo() method //{ */
+    /*!
+     * \brief Adds all queued system inputs and measurements and estimates the system state and covariance matrix at the specified time.
+     *
+     * \param to_stamp   The desired time at which the state vector and covariance matrix should be estimated.
+     * \return           Returns the estimated state vector and covariance matrix in a single struct.
+     *
+     * \note May only be called from the owner thread.
+     */
+    statecov_t predictTo(const ros::Time& to_stamp)
+    {
+      processQueued();
+      return Base_class::predictTo(to_stamp);
+    }
+    //}
+
+    /* droppedCount() method //{ */
+    /*!
+     * \brief Returns the number of inputs and measurements dropped because the intake queue was full.
+     *
+     * \return  The number of dropped inputs and measurements since construction.
+     */
+    uint64_t droppedCount() const
+    {
+      return m_dropped.load(std::memory_order_relaxed);
+    }
+    //}
+
+  private:
+    enum class intake_type_t
+    {
+      input_with_noise,
+      input,
+      process_noise,
+      measurement,
+    };
+
+    struct intake_t
+    {
+      intake_type_t type;
+      ros::Time stamp;
+      u_t u;
+      Q_t Q;
+      ModelPtr model;
+      measurement_t meas;
+
+      // the members, which are not used by the given type of intake, are zeroed so that copying them to the queue is well-defined
+      intake_t()
+      {
+        u.setZero();
+        Q.setZero();
+        meas.z.setZero();
+        meas.R.setZero();
+      }
+    };
+
+    bool enqueue(intake_t&& intake)
+    {
+      if (m_queue.push(std::move(intake)))
+        return true;
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    MPSCQueue<intake_t> m_queue;
+    std::atomic<uint64_t> m_dropped;
+    // the number of dropped data already reported by the owner thread
+    uint64_t m_dropped_reported = 0;
+    // helper buffer for collecting the queued measurements (kept to avoid reallocations)
+    std::vector<measurement_t> m_measurements;
+  };
+}  // namespace mrs_lib
+
+#endif  // CONCURRENT_REPREDICTOR_H
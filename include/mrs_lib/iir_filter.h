@@ -5,6 +5,7 @@
 #define IIR_FILTER_H
 
 #include <ros/ros.h>
+#include <Eigen/Dense>
 
 namespace mrs_lib
 {
@@ -22,6 +23,132 @@ private:
   std::vector<double> b_;
   size_t              order_;
   std::vector<double> buffer_;
+  size_t              buffer_idx_;
+};
+
+/**
+ * \brief IIR filter implemented as a cascade of second-order sections (biquads).
+ *
+ * Each section is evaluated in the transposed direct form II, which keeps only two state variables per section.
+ * Compared to the \ref IirFilter, which evaluates the whole transfer function in the direct form, the cascade is
+ * numerically more robust for higher orders.
+ *
+ * The filter may process multiple independent channels (e.g. the axes of an IMU) with the same coefficients at once.
+ * The states of the channels are stored contiguously and the channels are processed in fixed-size chunks, so that each
+ * section is applied to several channels at once using vectorized instructions.
+ * Besides filtering a single sample at a time, a whole block of samples may be filtered in one call. For a single channel,
+ * the sections are then applied one after another to the whole block.
+ */
+class IirSosFilter {
+
+public:
+  /*!
+   * \brief Coefficients of the sections, one section per row.
+   *
+   * Each row contains the coefficients [b0, b1, b2, a1, a2] of the section transfer function
+   * (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2).
+   */
+  using sections_t = Eigen::Matrix<double, Eigen::Dynamic, 5, Eigen::RowMajor>;
+
+  /*!
+   * \brief Samples of multiple channels, one channel per row and one sample per column.
+   */
+  using samples_t = Eigen::MatrixXd;
+
+  /*!
+   * \brief The main constructor.
+   *
+   * \param sections    coefficients of the sections (see sections_t).
+   * \param n_channels  number of the independent channels to be filtered.
+   */
+  IirSosFilter(const sections_t& sections, const size_t n_channels = 1);
+
+  /*!
+   * \brief Converts a transfer function to a cascade of second-order sections.
+   *
+   * The transfer function is given in the same form as for the \ref IirFilter, i.e.
+   * (b[0] + b[1]*z^-1 + ... ) / (a[0] + a[1]*z^-1 + ...). Its poles and zeros are found as the eigenvalues of the
+   * companion matrices of the polynomials and complex conjugate pairs are combined into the sections. The poles closest
+   * to the unit circle are placed in the last section together with the closest zeros.
+   *
+   * \param a  coefficients of the denominator.
+   * \param b  coefficients of the numerator.
+   * \return   coefficients of the sections of the same filter.
+   */
+  static sections_t toSections(const std::vector<double>& a, const std::vector<double>& b);
+
+  /*!
+   * \brief Filters a single sample of a single-channel filter.
+   *
+   * \param input  the new sample.
+   * \return       the filtered sample.
+   */
+  double iterate(const double& input);
+
+  /*!
+   * \brief Filters a single sample of all channels.
+   *
+   * \param input   the new sample of each channel.
+   * \param output  the filtered sample of each channel (may be the same vector as the input).
+   */
+  void iterate(const Eigen::Ref<const Eigen::VectorXd>& input, Eigen::Ref<Eigen::VectorXd> output);
+
+  /*!
+   * \brief Filters a block of samples of a single-channel filter.
+   *
+   * \param input      pointer to the first of the new samples.
+   * \param output     pointer to the first of the filtered samples (may be the same as the input).
+   * \param n_samples  number of the samples.
+   */
+  void filter(const double* input, double* output, const size_t n_samples);
+
+  /*!
+   * \brief Filters a block of samples of all channels.
+   *
+   * \param input   the new samples, one channel per row and one sample per column.
+   * \param output  the filtered samples of the same size as the input (may be the same matrix as the input).
+   */
+  void filter(const Eigen::Ref<const samples_t>& input, Eigen::Ref<samples_t> output);
+
+  /*!
+   * \brief Resets the state of all sections and channels to zero.
+   */
+  void reset();
+
+  /*!
+   * \brief Returns the number of channels of the filter.
+   */
+  size_t channels() const;
+
+  /*!
+   * \brief Returns the coefficients of the sections.
+   */
+  const sections_t& sections() const;
+
+  /*!
+   * \brief Changes the coefficients of a single section without resetting its state.
+   *
+   * This allows re-tuning the filter at runtime (e.g. tracking a varying frequency) without any memory allocation.
+   *
+   * \param index   index of the section.
+   * \param coeffs  the new coefficients [b0, b1, b2, a1, a2] of the section.
+   */
+  void setSection(const int index, const Eigen::Matrix<double, 1, 5>& coeffs);
+
+private:
+  // number of channels processed at once using vectorized instructions
+  static constexpr int chunk_size = 4;
+  using chunk_t                   = Eigen::Array<double, chunk_size, 1>;
+
+  sections_t sections_;
+  size_t     n_channels_;
+
+  // state of the sections, one channel per row (padded to a multiple of chunk_size) and one section per column
+  Eigen::ArrayXXd s1_;
+  Eigen::ArrayXXd s2_;
+
+  // filters a single sample of all channels (the input and output may point to the same memory)
+  void iterateChunks(const double* input, double* output);
 };
 
 }  // namespace mrs_lib
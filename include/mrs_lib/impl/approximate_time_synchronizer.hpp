@@ -0,0 +1,179 @@
+// clang: MatousFormat
+
+#ifndef APPROXIMATE_TIME_SYNCHRONIZER_HPP
+#define APPROXIMATE_TIME_SYNCHRONIZER_HPP
+
+#include <mrs_lib/approximate_time_synchronizer.h>
+#include <algorithm>
+
+namespace mrs_lib
+{
+
+  /* ApproximateTimeSynchronizer() constructor //{ */
+  template <typename... MessageTypes>
+  ApproximateTimeSynchronizer<MessageTypes...>::ApproximateTimeSynchronizer(const SubscribeHandlerOptions& options,
+                                                                            const std::array<std::string, n_topics>& topic_names,
+                                                                            const ros::Duration& max_slop, const callback_t& callback, const size_t queue_length)
+      : m_max_slop(max_slop), m_callback(callback)
+  {
+    // preallocate the queues so that no memory is allocated when receiving the messages
+    std::apply(
+        [queue_length](auto&... queues) {
+          ((queues.msgs.resize(std::max(queue_length, size_t(1))), queues.stamps.resize(std::max(queue_length, size_t(1)))), ...);
+        },
+        m_queues);
+
+    // the handlers are constructed last, because they may start receiving the messages immediately
+    construct_handlers(options, topic_names, indices_t());
+  }
+  //}
+
+  /* getStatistics() method //{ */
+  template <typename... MessageTypes>
+  typename ApproximateTimeSynchronizer<MessageTypes...>::statistics_t ApproximateTimeSynchronizer<MessageTypes...>::getStatistics() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_statistics;
+  }
+  //}
+
+  /* resetStatistics() method //{ */
+  template <typename... MessageTypes>
+  void ApproximateTimeSynchronizer<MessageTypes...>::resetStatistics()
+  {
+    std::scoped_lock lck(m_mtx);
+    m_statistics = statistics_t();
+  }
+  //}
+
+  /* clear() method //{ */
+  template <typename... MessageTypes>
+  void ApproximateTimeSynchronizer<MessageTypes...>::clear()
+  {
+    std::scoped_lock lck(m_mtx);
+    std::apply(
+        [](auto&... queues) {
+          ((
+               [&queues]() {
+                 while (!queues.empty())
+                   queues.pop();
+               }()),
+           ...);
+        },
+        m_queues);
+  }
+  //}
+
+  /* start() method //{ */
+  template <typename... MessageTypes>
+  void ApproximateTimeSynchronizer<MessageTypes...>::start()
+  {
+    std::apply([](auto&... handlers) { (handlers.start(), ...); }, m_handlers);
+  }
+  //}
+
+  /* stop() method //{ */
+  template <typename... MessageTypes>
+  void ApproximateTimeSynchronizer<MessageTypes...>::stop()
+  {
+    std::apply([](auto&... handlers) { (handlers.stop(), ...); }, m_handlers);
+  }
+  //}
+
+  /* construct_handlers() method //{ */
+  template <typename... MessageTypes>
+  template <size_t... Is>
+  void ApproximateTimeSynchronizer<MessageTypes...>::construct_handlers(const SubscribeHandlerOptions& options,
+                                                                        const std::array<std::string, n_topics>& topic_names, std::index_sequence<Is...>)
+  {
+    ((std::get<Is>(m_handlers) = std::tuple_element_t<Is, decltype(m_handlers)>(
+          options, topic_names.at(Is),
+          typename std::tuple_element_t<Is, decltype(m_handlers)>::message_callback_t(
+              [this](const std::tuple_element_t<Is, messages_t> msg) { message_callback<Is>(msg); }))),
+     ...);
+  }
+  //}
+
+  /* message_callback() method //{ */
+  template <typename... MessageTypes>
+  template <size_t I>
+  void ApproximateTimeSynchronizer<MessageTypes...>::message_callback(const typename std::tuple_element_t<I, messages_t>& msg)
+  {
+    {
+      std::scoped_lock lck(m_mtx);
+      auto& queue = std::get<I>(m_queues);
+      const ros::Time stamp = ros::message_traits::header(*msg)->stamp;
+      m_statistics.n_received.at(I)++;
+
+      // a message older than the last one on the same topic would break the ordering of the queue
+      if (!queue.empty() && stamp < queue.backStamp())
+      {
+        m_statistics.n_dropped.at(I)++;
+        return;
+      }
+
+      if (queue.full())
+      {
+        queue.pop();
+        m_statistics.n_dropped.at(I)++;
+      }
+      queue.push(msg, stamp);
+    }
+
+    // call the callback for all the found matches (usually just one) without locking the mutex of the queues
+    // the matching and the delivery are serialized, so that the matches are passed to the callback in order
+    std::scoped_lock cb_lck(m_callback_mtx);
+    messages_t matched;
+    while (true)
+    {
+      {
+        std::scoped_lock lck(m_mtx);
+        if (!find_match(matched, indices_t()))
+          return;
+      }
+      std::apply(m_callback, matched);
+      matched = messages_t();
+    }
+  }
+  //}
+
+  /* find_match() method //{ */
+  template <typename... MessageTypes>
+  template <size_t... Is>
+  bool ApproximateTimeSynchronizer<MessageTypes...>::find_match(messages_t& matched, std::index_sequence<Is...>)
+  {
+    while (true)
+    {
+      if ((std::get<Is>(m_queues).empty() || ...))
+        return false;
+
+      const std::array<ros::Time, n_topics> stamps = {std::get<Is>(m_queues).frontStamp()...};
+      const auto [oldest_it, newest_it] = std::minmax_element(std::begin(stamps), std::end(stamps));
+      const ros::Duration spread = *newest_it - *oldest_it;
+
+      if (spread <= m_max_slop)
+      {
+        ((std::get<Is>(matched) = std::get<Is>(m_queues).pop()), ...);
+        m_statistics.n_matched++;
+        m_statistics.max_spread = std::max(m_statistics.max_spread, spread);
+        return true;
+      }
+
+      // the oldest message can't be matched, because all the messages of the topic with the newest stamp are even newer
+      const size_t oldest = std::distance(std::begin(stamps), oldest_it);
+      (
+          [this, oldest]() {
+            if (Is == oldest)
+            {
+              std::get<Is>(m_queues).pop();
+              m_statistics.n_dropped.at(Is)++;
+            }
+          }(),
+          ...);
+    }
+  }
+  //}
+
+}  // namespace mrs_lib
+
+#endif  // APPROXIMATE_TIME_SYNCHRONIZER_HPP
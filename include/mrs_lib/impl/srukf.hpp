@@ -0,0 +1,333 @@
+// clang: MatousFormat
+
+#ifndef SRUKF_HPP
+#define SRUKF_HPP
+
+/**  \file
+     \brief Implements SRUKF - a class implementing the Square-Root Unscented Kalman Filter.
+ */
+
+#include <ros/ros.h>
+#include <mrs_lib/srukf.h>
+
+namespace mrs_lib
+{
+  /* constructor //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  SRUKF<n_states, n_inputs, n_measurements>::SRUKF()
+  {
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  SRUKF<n_states, n_inputs, n_measurements>::SRUKF(const transition_model_t& transition_model, const observation_model_t& observation_model, const double alpha, const double kappa, const double beta)
+    : m_alpha(alpha), m_kappa(kappa), m_beta(beta), m_Wm(W_t::Zero()), m_Wc(W_t::Zero()), m_transition_model(transition_model), m_observation_model(observation_model)
+  {
+    assert(alpha > 0.0);
+    computeWeights();
+  }
+
+  //}
+
+  /* computeWeights() //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void SRUKF<n_states, n_inputs, n_measurements>::computeWeights()
+  {
+    // initialize lambda
+    m_lambda = m_alpha*m_alpha*(double(n) + m_kappa) - double(n);
+
+    // initialize first terms of the weights
+    m_Wm(0) = m_lambda / (double(n) + m_lambda);
+    m_Wc(0) = m_Wm(0) + (1.0 - m_alpha*m_alpha + m_beta);
+
+    // initialize the rest of the weights
+    for (int i = 1; i < w; i++)
+    {
+      m_Wm(i) = (1.0 - m_Wm(0))/(w - 1.0);
+      m_Wc(i) = m_Wm(i);
+    }
+  }
+
+  //}
+
+  /* setConstants() //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  // update the SRUKF constants
+  void SRUKF<n_states, n_inputs, n_measurements>::setConstants(const double alpha, const double kappa, const double beta)
+  {
+    m_alpha = alpha;
+    m_kappa = kappa;
+    m_beta  = beta;
+
+    computeWeights();
+  }
+
+  //}
+
+  /* setTransitionModel() method //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void SRUKF<n_states, n_inputs, n_measurements>::setTransitionModel(const transition_model_t& transition_model)
+  {
+    m_transition_model = transition_model;
+  }
+
+  //}
+
+  /* setObservationModel() method //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void SRUKF<n_states, n_inputs, n_measurements>::setObservationModel(const observation_model_t& observation_model)
+  {
+    m_observation_model = observation_model;
+  }
+
+  //}
+
+  /* toSqrtStatecov() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t SRUKF<n_states, n_inputs, n_measurements>::toSqrtStatecov(const statecov_t& sc)
+  {
+    const Eigen::LLT<P_t> llt(sc.P);
+    if (llt.info() != Eigen::Success)
+    {
+      ROS_WARN("SRUKF: taking the square root of the state covariance failed.");
+      throw square_root_exception();
+    }
+    sqrt_statecov_t ret;
+    ret.x = sc.x;
+    ret.S = llt.matrixL();
+    ret.stamp = sc.stamp;
+    return ret;
+  }
+  //}
+
+  /* fromSqrtStatecov() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::statecov_t SRUKF<n_states, n_inputs, n_measurements>::fromSqrtStatecov(const sqrt_statecov_t& sc)
+  {
+    statecov_t ret;
+    ret.x = sc.x;
+    ret.P = sc.S * sc.S.transpose();
+    ret.stamp = sc.stamp;
+    return ret;
+  }
+  //}
+
+  /* computeQRSqrt() method //{ */
+  // returns a lower-triangular L such that L*L^T = A*A^T (using the QR decomposition of A^T)
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows, int cols>
+  Eigen::Matrix<double, rows, rows> SRUKF<n_states, n_inputs, n_measurements>::computeQRSqrt(const Eigen::Matrix<double, rows, cols>& A)
+  {
+    const Eigen::HouseholderQR<Eigen::Matrix<double, cols, rows>> qr(A.transpose());
+    Eigen::Matrix<double, rows, rows> L = qr.matrixQR().template topRows<rows>().template triangularView<Eigen::Upper>().transpose();
+    // the QR decomposition is unique only up to the signs of the diagonal, but the Cholesky update requires it positive
+    for (int it = 0; it < rows; it++)
+      if (L(it, it) < 0.0)
+        L.col(it) = -L.col(it);
+    return L;
+  }
+  //}
+
+  /* computeNoiseSqrt() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows>
+  Eigen::Matrix<double, rows, rows> SRUKF<n_states, n_inputs, n_measurements>::computeNoiseSqrt(const Eigen::Matrix<double, rows, rows>& Q)
+  {
+    using mat_t = Eigen::Matrix<double, rows, rows>;
+    // noise covariances are usually diagonal, in which case the decomposition is trivial
+    const bool is_diagonal = (Q - mat_t(Q.diagonal().asDiagonal())).isZero(0.0);
+    if (is_diagonal && (Q.diagonal().array() >= 0.0).all())
+      return Q.diagonal().cwiseSqrt().asDiagonal();
+
+    const Eigen::LLT<mat_t> llt(Q);
+    if (llt.info() != Eigen::Success)
+    {
+      ROS_WARN("SRUKF: taking the square root of the noise covariance failed.");
+      throw square_root_exception();
+    }
+    return llt.matrixL();
+  }
+  //}
+
+  /* choleskyUpdate() method //{ */
+  // updates the lower-triangular L so that L*L^T = L*L^T + weight*v*v^T (a downdate if the weight is negative)
+  // returns false if the result would not be positive definite
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows>
+  bool SRUKF<n_states, n_inputs, n_measurements>::choleskyUpdate(Eigen::Matrix<double, rows, rows>& L, Eigen::Matrix<double, rows, 1> v, const double weight)
+  {
+    if (weight == 0.0 || v.isZero(0.0))
+      return true;
+    const double sign = weight > 0.0 ? 1.0 : -1.0;
+    v *= std::sqrt(std::abs(weight));
+    for (int k = 0; k < rows; k++)
+    {
+      const double L_kk = L(k, k);
+      const double r2 = L_kk * L_kk + sign * v(k) * v(k);
+      if (!(L_kk > 0.0) || !(r2 > 0.0))
+        return false;
+      const double r = std::sqrt(r2);
+      const double c = r / L_kk;
+      const double s = v(k) / L_kk;
+      L(k, k) = r;
+      for (int i = k + 1; i < rows; i++)
+      {
+        L(i, k) = (L(i, k) + sign * s * v(i)) / c;
+        v(i) = c * v(i) - s * L(i, k);
+      }
+    }
+    return true;
+  }
+  //}
+
+  /* computeSigmas() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::X_t SRUKF<n_states, n_inputs, n_measurements>::computeSigmas(const x_t& x, const P_t& S) const
+  {
+    // calculate sigma points directly from the Cholesky factor (no decomposition is necessary)
+    // fill in the middle of the elipsoid
+    X_t X;
+    X.col(0) = x;
+
+    const P_t Pa_sqrt = std::sqrt(double(n) + m_lambda)*S;
+    const auto xrep = x.replicate(1, n);
+
+    // positive sigma points
+    X.template block<n, n>(0, 1) = xrep + Pa_sqrt;
+
+    // negative sigma points
+    X.template block<n, n>(0, n+1) = xrep - Pa_sqrt;
+
+    return X;
+  }
+  //}
+
+  /* computeMean() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows>
+  Eigen::Matrix<double, rows, 1> SRUKF<n_states, n_inputs, n_measurements>::computeMean(const Eigen::Matrix<double, rows, w>& X) const
+  {
+    // the weights sum up to one, but they may be very large with opposite signs, so the mean is computed
+    // relative to the central sigma point to avoid a catastrophic cancellation
+    const Eigen::Matrix<double, rows, 1> x0 = X.col(0);
+    return x0 + (X.template rightCols<w - 1>().colwise() - x0) * m_Wm.template tail<w - 1>();
+  }
+  //}
+
+  /* predict() method //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t SRUKF<n_states, n_inputs, n_measurements>::predict(const sqrt_statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+  {
+    const X_t S = computeSigmas(sc.x, sc.S);
+
+    // propagate sigmas through the transition model
+    X_t X;
+    for (int i = 0; i < w; i++)
+    {
+      X.col(i) = m_transition_model(S.col(i), u, dt);
+    }
+
+    // recompute the state vector
+    sqrt_statecov_t ret;
+    ret.x = computeMean(X);
+
+    // recompute the covariance factor from the sigma points with positive weights and the process noise
+    XQ_t XQ;
+    XQ.template leftCols<w - 1>() = std::sqrt(m_Wc(1)) * (X.template rightCols<w - 1>().colwise() - ret.x);
+    XQ.template rightCols<n>() = computeNoiseSqrt(Q);
+    ret.S = computeQRSqrt(XQ);
+
+    // the weight of the central sigma point may be negative, so it is added using a rank-1 update (or downdate)
+    if (!choleskyUpdate<n>(ret.S, X.col(0) - ret.x, m_Wc(0)))
+    {
+      ROS_WARN("SRUKF: updating the Cholesky factor of the covariance during prediction failed.");
+      throw square_root_exception();
+    }
+
+    return ret;
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::statecov_t SRUKF<n_states, n_inputs, n_measurements>::predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+  {
+    return fromSqrtStatecov(predict(toSqrtStatecov(sc), u, Q, dt));
+  }
+
+  //}
+
+  /* correct() method //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t SRUKF<n_states, n_inputs, n_measurements>::correct(const sqrt_statecov_t& sc, const z_t& z, const R_t& R) const
+  {
+    const auto& x = sc.x;
+    const X_t S = computeSigmas(x, sc.S);
+
+    // propagate sigmas through the observation model
+    Z_t Z_exp;
+    for (int i = 0; i < w; i++)
+    {
+      Z_exp.col(i) = m_observation_model(S.col(i));
+    }
+
+    // compute expected measurement
+    const z_t z_exp = computeMean(Z_exp);
+
+    // compute the Cholesky factor of the covariance of measurement
+    ZR_t ZR;
+    ZR.template leftCols<w - 1>() = std::sqrt(m_Wc(1)) * (Z_exp.template rightCols<w - 1>().colwise() - z_exp);
+    ZR.template rightCols<p>() = computeNoiseSqrt(R);
+    Pzz_t Szz = computeQRSqrt(ZR);
+    if (!choleskyUpdate<p>(Szz, Z_exp.col(0) - z_exp, m_Wc(0)))
+    {
+      ROS_WARN("SRUKF: updating the Cholesky factor of the measurement covariance failed.");
+      throw square_root_exception();
+    }
+
+    // compute cross covariance (the central sigma point does not contribute because it is equal to x)
+    const K_t Pxz = m_Wc(1) * (S.template rightCols<w - 1>().colwise() - x) * (Z_exp.template rightCols<w - 1>().colwise() - z_exp).transpose();
+
+    // compute Kalman gain K = Pxz*(Szz*Szz^T)^-1 using two triangular solves
+    const Eigen::Matrix<double, p, n> tmp = Szz.template triangularView<Eigen::Lower>().solve(Pxz.transpose());
+    const K_t K = Szz.transpose().template triangularView<Eigen::Upper>().solve(tmp).transpose();
+
+    // check whether the inverse produced valid numbers
+    if (!K.array().isFinite().all())
+    {
+      ROS_ERROR("SRUKF: inverting of Pzz in correction update produced non-finite numbers!!! Fix your covariances (the measurement's is probably too low...)");
+      throw inverse_exception();
+    }
+
+    // correct
+    sqrt_statecov_t ret;
+    ret.x = x + K * (z - z_exp);
+    // P = P - K*Pzz*K^T = S*S^T - U*U^T, where U = K*Szz, so the factor is downdated by each column of U
+    ret.S = sc.S;
+    const K_t U = K * Szz;
+    for (int it = 0; it < p; it++)
+    {
+      if (!choleskyUpdate<n>(ret.S, U.col(it), -1.0))
+      {
+        ROS_WARN("SRUKF: downdating the Cholesky factor of the covariance during correction failed.");
+        throw square_root_exception();
+      }
+    }
+    return ret;
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  typename SRUKF<n_states, n_inputs, n_measurements>::statecov_t SRUKF<n_states, n_inputs, n_measurements>::correct(const statecov_t& sc, const z_t& z, const R_t& R) const
+  {
+    return fromSqrtStatecov(correct(toSqrtStatecov(sc), z, R));
+  }
+
+  //}
+
+}  // namespace mrs_lib
+
+#endif
@@ -5,7 +5,9 @@
 
 #include <mrs_lib/subscribe_handler.h>
 #include <mrs_lib/timer.h>
+#include <ros/message_traits.h>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 
 namespace mrs_lib
@@ -36,6 +38,10 @@ namespace mrs_lib
           m_latest_message_time(0),
           m_latest_message(nullptr),
           m_message_callback(message_callback),
+          m_history(options.history_length),
+          m_history_start(0),
+          m_history_size(0),
+          m_history_header_stamp(options.history_header_stamp),
           m_queue_size(options.queue_size),
           m_transport_hints(options.transport_hints)
     {
@@ -108,6 +114,36 @@ namespace mrs_lib
     }
     //}
 
+    /* getMsgAt() method //{ */
+    virtual typename MessageType::ConstPtr getMsgAt(const ros::Time& stamp) const
+    {
+      if (m_history_size == 0)
+        return nullptr;
+      // the closest message is either the first one with a stamp after the specified time or the one just before it
+      const size_t after = history_lower_bound(stamp);
+      if (after == 0)
+        return history_at(0).msg;
+      if (after == m_history_size)
+        return history_at(m_history_size - 1).msg;
+      const history_entry_t& entry_before = history_at(after - 1);
+      const history_entry_t& entry_after = history_at(after);
+      if (stamp - entry_before.stamp <= entry_after.stamp - stamp)
+        return entry_before.msg;
+      else
+        return entry_after.msg;
+    }
+    //}
+
+    /* getMsgsInterval() method //{ */
+    virtual std::vector<typename MessageType::ConstPtr> getMsgsInterval(const ros::Time& from, const ros::Time& to) const
+    {
+      std::vector<typename MessageType::ConstPtr> ret;
+      for (size_t it = history_lower_bound(from); it < m_history_size && history_at(it).stamp <= to; it++)
+        ret.push_back(history_at(it).msg);
+      return ret;
+    }
+    //}
+
     /* waitForNew() method //{ */
     virtual typename MessageType::ConstPtr waitForNew(const ros::WallDuration& timeout)
     {
@@ -186,6 +222,18 @@ namespace mrs_lib
     typename MessageType::ConstPtr m_latest_message;
     message_callback_t m_message_callback;
 
+  protected:
+    struct history_entry_t
+    {
+      ros::Time stamp;
+      typename MessageType::ConstPtr msg;
+    };
+    // a preallocated ring buffer of the last messages, sorted by their stamps from m_history_start
+    std::vector<history_entry_t> m_history;
+    size_t m_history_start;
+    size_t m_history_size;
+    bool m_history_header_stamp;
+
   private:
     uint32_t m_queue_size;
     ros::TransportHints m_transport_hints;
@@ -205,11 +253,81 @@ namespace mrs_lib
     }
     //}
 
+    /* history_at() method //{ */
+    // returns the history entry with the specified index, where zero corresponds to the oldest stamp
+    history_entry_t& history_at(const size_t index)
+    {
+      return m_history[(m_history_start + index) % m_history.size()];
+    }
+    const history_entry_t& history_at(const size_t index) const
+    {
+      return m_history[(m_history_start + index) % m_history.size()];
+    }
+    //}
+
+    /* history_lower_bound() method //{ */
+    // returns the index of the first history entry with a stamp not before the specified time (or the size of the history)
+    size_t history_lower_bound(const ros::Time& stamp) const
+    {
+      size_t first = 0;
+      size_t count = m_history_size;
+      while (count > 0)
+      {
+        const size_t step = count / 2;
+        if (history_at(first + step).stamp < stamp)
+        {
+          first += step + 1;
+          count -= step + 1;
+        }
+        else
+        {
+          count = step;
+        }
+      }
+      return first;
+    }
+    //}
+
+    /* add_to_history() method //{ */
+    void add_to_history(const typename MessageType::ConstPtr& msg, const ros::Time& receive_time)
+    {
+      if (m_history.empty())
+        return;
+
+      ros::Time stamp = receive_time;
+      if (m_history_header_stamp)
+      {
+        // messages without a header are indexed by the time of their reception
+        const auto header = ros::message_traits::header(*msg);
+        if (header)
+          stamp = header->stamp;
+      }
+
+      // if the history is full, the message with the oldest stamp is dropped (unless the new one is even older)
+      if (m_history_size == m_history.size())
+      {
+        if (stamp < history_at(0).stamp)
+          return;
+        history_at(0).msg = nullptr;
+        m_history_start = (m_history_start + 1) % m_history.size();
+        m_history_size--;
+      }
+
+      // the new message usually has the newest stamp, so it's just appended, otherwise the newer messages are shifted
+      size_t index = m_history_size;
+      for (; index > 0 && stamp < history_at(index - 1).stamp; index--)
+        history_at(index) = std::move(history_at(index - 1));
+      history_at(index) = {stamp, msg};
+      m_history_size++;
+    }
+    //}
+
     /* process_new_message() method //{ */
     void process_new_message(const typename MessageType::ConstPtr& msg)
     {
       m_latest_message_time = ros::Time::now();
       m_latest_message = msg;
+      add_to_history(msg, m_latest_message_time);
       // If the message callback is registered, the new data will immediately be processed,
       // so reset the flag. Otherwise, set the flag.
       m_new_data = !m_message_callback;
@@ -281,6 +399,16 @@ namespace mrs_lib
       std::lock_guard lck(m_mtx);
       return impl_class_t::peekMsg();
     }
+    virtual typename MessageType::ConstPtr getMsgAt(const ros::Time& stamp) const override
+    {
+      std::lock_guard lck(m_mtx);
+      return impl_class_t::getMsgAt(stamp);
+    }
+    virtual std::vector<typename MessageType::ConstPtr> getMsgsInterval(const ros::Time& from, const ros::Time& to) const override
+    {
+      std::lock_guard lck(m_mtx);
+      return impl_class_t::getMsgsInterval(from, to);
+    }
     virtual ros::Time lastMsgTime() const override
     {
       std::lock_guard lck(m_mtx);
@@ -324,6 +452,163 @@ namespace mrs_lib
   };
   //}
 
+  /* SubscribeHandler_lockfree class //{ */
+  // publishes the latest message as an immutable snapshot through an atomic shared pointer (RCU-style)
+  // so that the polling methods never wait for the data callback
+  template <typename MessageType>
+  class SubscribeHandler<MessageType>::ImplLockfree : public SubscribeHandler<MessageType>::Impl
+  {
+  private:
+    using impl_class_t = SubscribeHandler<MessageType>::Impl;
+
+  public:
+    using timeout_callback_t = typename impl_class_t::timeout_callback_t;
+    using message_callback_t = typename impl_class_t::message_callback_t;
+
+    friend class SubscribeHandler<MessageType>;
+
+  public:
+    ImplLockfree(const SubscribeHandlerOptions& options, const message_callback_t& message_callback = message_callback_t())
+        : impl_class_t::Impl(options, message_callback), m_latest(nullptr), m_received_seq(0), m_read_seq(0), m_used(false)
+    {
+    }
+
+  public:
+    virtual bool hasMsg() const override
+    {
+      return m_received_seq.load(std::memory_order_acquire) > 0;
+    }
+    virtual bool newMsg() const override
+    {
+      // if the message callback is registered, the new data are immediately processed by it
+      if (this->m_message_callback)
+        return false;
+      return m_received_seq.load(std::memory_order_acquire) > m_read_seq.load(std::memory_order_acquire);
+    }
+    virtual bool usedMsg() const override
+    {
+      return m_used.load(std::memory_order_acquire);
+    }
+    virtual typename MessageType::ConstPtr getMsg() override
+    {
+      m_used.store(true, std::memory_order_release);
+      const auto latest = std::atomic_load(&m_latest);
+      if (!latest)
+        return nullptr;
+      // the sequence number of the returned snapshot only ever increases, even with multiple concurrent readers
+      uint64_t read_seq = m_read_seq.load(std::memory_order_relaxed);
+      while (read_seq < latest->seq && !m_read_seq.compare_exchange_weak(read_seq, latest->seq, std::memory_order_acq_rel))
+        ;
+      return latest->msg;
+    }
+    virtual typename MessageType::ConstPtr peekMsg() const override
+    {
+      const auto latest = std::atomic_load(&m_latest);
+      return latest ? latest->msg : nullptr;
+    }
+    virtual typename MessageType::ConstPtr waitForNew(const ros::WallDuration& timeout) override
+    {
+      // convert the ros type to chrono type
+      const std::chrono::duration<float> chrono_timeout(timeout.toSec());
+      // the mutex is only shared with the data callback for the notification, the polling methods don't use it
+      std::unique_lock lock(this->m_new_data_mtx);
+      if (this->m_new_data_cv.wait_for(lock, chrono_timeout, [this] { return newMsg(); }))
+        return getMsg();
+      else
+        return nullptr;
+    };
+    virtual typename MessageType::ConstPtr getMsgAt(const ros::Time& stamp) const override
+    {
+      std::lock_guard lck(m_history_mtx);
+      return impl_class_t::getMsgAt(stamp);
+    }
+    virtual std::vector<typename MessageType::ConstPtr> getMsgsInterval(const ros::Time& from, const ros::Time& to) const override
+    {
+      std::lock_guard lck(m_history_mtx);
+      return impl_class_t::getMsgsInterval(from, to);
+    }
+    virtual ros::Time lastMsgTime() const override
+    {
+      const auto latest = std::atomic_load(&m_latest);
+      return latest ? latest->time : ros::Time(0);
+    };
+    virtual std::string topicName() const override
+    {
+      std::lock_guard lck(m_mtx);
+      return impl_class_t::topicName();
+    };
+    virtual void start() override
+    {
+      std::lock_guard lck(m_mtx);
+      return impl_class_t::start();
+    }
+    virtual void stop() override
+    {
+      std::lock_guard lck(m_mtx);
+      return impl_class_t::stop();
+    }
+
+    virtual ~ImplLockfree() override = default;
+
+  protected:
+    virtual void data_callback(const typename MessageType::ConstPtr& msg) override
+    {
+      {
+        // serializes only concurrent data callbacks, the polling methods never take this mutex
+        std::lock_guard lck(m_callback_mtx);
+        if (this->m_timeout_manager)
+          this->m_timeout_manager->reset(this->m_timeout_id);
+        const uint64_t seq = m_received_seq.load(std::memory_order_relaxed) + 1;
+        const ros::Time now = ros::Time::now();
+        std::atomic_store(&m_latest, std::make_shared<const latest_t>(latest_t{msg, now, seq}));
+        m_received_seq.store(seq, std::memory_order_release);
+
+        // the history is searched under a mutex, which is not used by the polling methods
+        if (!this->m_history.empty())
+        {
+          std::lock_guard history_lck(m_history_mtx);
+          impl_class_t::add_to_history(msg, now);
+        }
+      }
+
+      // wake up the threads blocked in waitForNew()
+      if (!this->m_message_callback)
+      {
+        {
+          std::lock_guard lck(this->m_new_data_mtx);
+        }
+        this->m_new_data_cv.notify_all();
+      }
+
+      // execute the callback after unlocking the mutex to enable multi-threaded callback execution
+      if (this->m_message_callback)
+        impl_class_t::m_message_callback(msg);
+    }
+
+  private:
+    // an immutable snapshot of the latest message, which is replaced as a whole whenever a new message arrives
+    struct latest_t
+    {
+      typename MessageType::ConstPtr msg;
+      ros::Time time;
+      uint64_t seq;
+    };
+
+    // guards the subscriber in start(), stop() and topicName()
+    mutable std::mutex m_mtx;
+    std::mutex m_callback_mtx;
+    // guards the history
+    mutable std::mutex m_history_mtx;
+
+    std::shared_ptr<const latest_t> m_latest;
+    // sequence number of the latest received message (zero if no message was received yet)
+    std::atomic<uint64_t> m_received_seq;
+    // sequence number of the latest message returned by getMsg()
+    std::atomic<uint64_t> m_read_seq;
+    std::atomic<bool> m_used;
+  };
+  //}
+
 }  // namespace mrs_lib
 
 #endif  // SUBSCRIBE_HANDLER_HPP
@@ -37,6 +37,10 @@ public:
   void start();
   void stop();
   void setPeriod(const ros::Duration& duration, const bool reset = true);
+  statistics_t getStatistics();
+  void resetStatistics();
+  bool setPriority(const int priority);
+  bool setAffinity(const std::vector<int>& cpus);
 
   friend class ThreadTimer;
 
@@ -53,8 +57,15 @@ private:
   bool oneshot_;
 
   bool breakableSleep(const ros::Time& until);
+  bool breakableSleepTimerfd(const ros::Time& until);
+  void wakeUp();
+  void updateStatistics(const ros::Time& expected, const ros::Time& real, const uint64_t n_missed);
   void threadFcn();
 
+  // file descriptors of the timerfd used for sleeping and of the eventfd used to interrupt it (-1 if not available)
+  int timer_fd_;
+  int event_fd_;
+
   std::mutex mutex_wakeup_;
   std::condition_variable wakeup_cond_;
   std::recursive_mutex mutex_state_;
@@ -65,6 +76,13 @@ private:
   ros::Time last_expected_;
   ros::Time last_real_;
 
+  std::mutex mutex_stats_;
+  statistics_t stats_;
+  // ring buffer of the lateness of the last lateness_window callbacks (in nanoseconds)
+  std::vector<int64_t> lateness_window_;
+  size_t lateness_idx_;
+  double lateness_sum_s_;
+
 };
 
 //}
@@ -62,7 +62,7 @@ namespace mrs_lib
   /* transformImpl() //{ */
 
   template <class T>
-  std::optional<T> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const T& what)
+  std::optional<T> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const T& what, const std::string& latlon_frame)
   {
     const std::string from_frame = frame_from(tf);
     const std::string to_frame = frame_to(tf);
@@ -70,14 +70,15 @@ namespace mrs_lib
     if (from_frame == to_frame)
       return copyChangeFrame(what, from_frame);
 
-    const std::string latlon_frame_name = resolveFrameImpl(LATLON_ORIGIN);
+    const bool from_latlon = !latlon_frame.empty() && from_frame == latlon_frame;
+    const bool to_latlon = !latlon_frame.empty() && to_frame == latlon_frame;
 
     // First, check if the transformation is from/to the latlon frame
     // if conversion between UVM and LatLon coordinates is defined for this message, it may be resolved
     if constexpr (UTMLL_exists_v<Transformer, T>)
     {
       // check for transformation from LAT-LON GPS
-      if (from_frame == latlon_frame_name)
+      if (from_latlon)
       {
         const std::optional<T> tmp = LLtoUTM(what, getFramePrefix(from_frame));
         if (!tmp.has_value())
@@ -85,7 +86,7 @@ namespace mrs_lib
         return doTransform(tmp.value(), tf);
       }
       // check for transformation to LAT-LON GPS
-      else if (to_frame == latlon_frame_name)
+      else if (to_latlon)
       {
         const std::optional<T> tmp = doTransform(what, tf);
         if (!tmp.has_value())
@@ -96,7 +97,7 @@ namespace mrs_lib
     else
     {
       // by default, transformation from/to LATLON is undefined, so return nullopt if it's attempted
-      if (from_frame == latlon_frame_name || to_frame == latlon_frame_name)
+      if (from_latlon || to_latlon)
       {
         ROS_ERROR_STREAM_THROTTLE(1.0, "[" << node_name_ << "]: Transformer: cannot transform message of this type (" << typeid(T).name() << ") to/from latitude/longitude coordinates!");
         return std::nullopt;
@@ -144,6 +145,11 @@ namespace mrs_lib
   template <class T>
   std::optional<T> Transformer::transformSingle(const std::string& from_frame_raw, const T& what, const std::string& to_frame_raw, const ros::Time& time_stamp)
   {
+    // static transforms are served from the cache without locking the mutex
+    const auto static_tf_opt = getStaticTransform(from_frame_raw, to_frame_raw, time_stamp);
+    if (static_tf_opt.has_value())
+      return transformImpl(static_tf_opt.value(), what, "");
+
     std::scoped_lock lck(mutex_);
 
     if (!initialized_)
@@ -157,14 +163,14 @@ namespace mrs_lib
     const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
 
     // get the transform
-    const auto tf_opt = getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+    const auto tf_opt = getTransformCached(from_frame_raw, to_frame_raw, from_frame, to_frame, time_stamp, latlon_frame);
     if (!tf_opt.has_value())
       return std::nullopt;
     const geometry_msgs::TransformStamped& tf = tf_opt.value();
 
     // do the transformation
     const geometry_msgs::TransformStamped tf_resolved = create_transform(from_frame, to_frame, tf.header.stamp, tf.transform);
-    return transformImpl(tf_resolved, what);
+    return transformImpl(tf_resolved, what, latlon_frame);
   }
 
   //}
@@ -184,9 +190,10 @@ namespace mrs_lib
 
     const std::string from_frame = resolveFrameImpl(frame_from(tf));
     const std::string to_frame = resolveFrameImpl(frame_to(tf));
+    const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
     const geometry_msgs::TransformStamped tf_resolved = create_transform(from_frame, to_frame, tf.header.stamp, tf.transform);
 
-    return transformImpl(tf_resolved, what);
+    return transformImpl(tf_resolved, what, latlon_frame);
   }
 
   /* //} */
@@ -23,7 +23,7 @@ namespace mrs_lib
 
   template <int n_states, int n_inputs, int n_measurements>
   UKF<n_states, n_inputs, n_measurements>::UKF(const transition_model_t& transition_model, const observation_model_t& observation_model, const double alpha, const double kappa, const double beta)
-    : m_alpha(alpha), m_kappa(kappa), m_beta(beta), m_Wm(W_t::Zero()), m_Wc(W_t::Zero()), m_transition_model(transition_model), m_observation_model(observation_model)
+    : m_alpha(alpha), m_kappa(kappa), m_beta(beta), m_transition_model(transition_model), m_observation_model(observation_model)
   {
     assert(alpha > 0.0);
     computeWeights();
@@ -36,20 +36,67 @@ namespace mrs_lib
   template <int n_states, int n_inputs, int n_measurements>
   void UKF<n_states, n_inputs, n_measurements>::computeWeights()
   {
-    // initialize lambda
-    /* m_lambda = double(n) * (m_alpha * m_alpha - 1.0); */
-    m_lambda = m_alpha*m_alpha*(double(n) + m_kappa) - double(n);
+    // for dynamic sizes, the weights are only calculated in the workspace once the dimension is known
+    if constexpr (n >= 0)
+    {
+      m_Wm = W_t::Zero();
+      m_Wc = W_t::Zero();
+
+      // initialize lambda
+      /* m_lambda = double(n) * (m_alpha * m_alpha - 1.0); */
+      m_lambda = m_alpha*m_alpha*(double(n) + m_kappa) - double(n);
+
+      // initialize first terms of the weights
+      m_Wm(0) = m_lambda / (double(n) + m_lambda);
+      m_Wc(0) = m_Wm(0) + (1.0 - m_alpha*m_alpha + m_beta);
+
+      // initialize the rest of the weights
+      for (int i = 1; i < w; i++)
+      {
+        m_Wm(i) = (1.0 - m_Wm(0))/(w - 1.0);
+        m_Wc(i) = m_Wm(i);
+      }
+
+      // the helper variables of predict() and correct() are prepared here so that they are not recalculated on each call
+      prepareWorkspace(n, std::max(p, 0), m_ws);
+    }
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::computeWeights(const int n_dim, workspace_t& ws) const
+  {
+    const int w_dim = 2 * n_dim + 1;
+    ws.lambda = m_alpha*m_alpha*(double(n_dim) + m_kappa) - double(n_dim);
 
     // initialize first terms of the weights
-    m_Wm(0) = m_lambda / (double(n) + m_lambda);
-    m_Wc(0) = m_Wm(0) + (1.0 - m_alpha*m_alpha + m_beta);
+    ws.Wm(0) = ws.lambda / (double(n_dim) + ws.lambda);
+    ws.Wc(0) = ws.Wm(0) + (1.0 - m_alpha*m_alpha + m_beta);
 
     // initialize the rest of the weights
-    for (int i = 1; i < w; i++)
+    for (int i = 1; i < w_dim; i++)
     {
-      m_Wm(i) = (1.0 - m_Wm(0))/(w - 1.0);
-      m_Wc(i) = m_Wm(i);
+      ws.Wm(i) = (1.0 - ws.Wm(0))/(w_dim - 1.0);
+      ws.Wc(i) = ws.Wm(i);
     }
+
+    ws.alpha = m_alpha;
+    ws.kappa = m_kappa;
+    ws.beta = m_beta;
+  }
+
+  //}
+
+  /* prepareWorkspace() //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::prepareWorkspace(const int n_dim, const int p_dim, workspace_t& ws) const
+  {
+    // only allocate when the dimensions change (which for fixed sizes happens only on the first use)
+    const bool resized = ws.n_x != n_dim || ws.n_z != p_dim;
+    if (resized)
+      ws.resize(n_dim, p_dim);
+    if (resized || ws.alpha != m_alpha || ws.kappa != m_kappa || ws.beta != m_beta)
+      computeWeights(n_dim, ws);
   }
 
   //}
@@ -89,6 +136,26 @@ namespace mrs_lib
 
     //}
 
+    /* setTransitionModelInPlace() method //{ */
+
+    template <int n_states, int n_inputs, int n_measurements>
+    void UKF<n_states, n_inputs, n_measurements>::setTransitionModelInPlace(const transition_model_inplace_t& transition_model)
+    {
+      m_transition_model_inplace = transition_model;
+    }
+
+    //}
+
+    /* setObservationModelInPlace() method //{ */
+
+    template <int n_states, int n_inputs, int n_measurements>
+    void UKF<n_states, n_inputs, n_measurements>::setObservationModelInPlace(const observation_model_inplace_t& observation_model)
+    {
+      m_observation_model_inplace = observation_model;
+    }
+
+    //}
+
   /* computePaSqrt() method //{ */
   template <int n_states, int n_inputs, int n_measurements>
   typename UKF<n_states, n_inputs, n_measurements>::P_t UKF<n_states, n_inputs, n_measurements>::computePaSqrt(const P_t& P) const
@@ -100,7 +167,7 @@ namespace mrs_lib
     Eigen::LLT<P_t> llt(Pa);
     if (llt.info() != Eigen::Success)
     {
-      P_t tmp = Pa + (double(n) + m_lambda)*1e-9*P_t::Identity();
+      P_t tmp = Pa + (double(n) + m_lambda)*1e-9*P_t::Identity(P.rows(), P.cols());
       llt.compute(tmp);
       if (llt.info() != Eigen::Success)
       {
@@ -153,17 +220,17 @@ namespace mrs_lib
   {
     // calculate sigma points
     // fill in the middle of the elipsoid
-    X_t S;
+    X_t S(x.rows(), 2*x.rows() + 1);
     S.col(0) = x;
 
     const P_t P_sqrt = computePaSqrt(P);
-    const auto xrep = x.replicate(1, n);
+    const auto xrep = x.replicate(1, x.rows());
 
     // positive sigma points
-    S.template block<n, n>(0, 1) = xrep + P_sqrt;
+    S.template block<n, n>(0, 1, x.rows(), x.rows()) = xrep + P_sqrt;
 
     // negative sigma points
-    S.template block<n, n>(0, n+1) = xrep - P_sqrt;
+    S.template block<n, n>(0, x.rows()+1, x.rows(), x.rows()) = xrep - P_sqrt;
 
     /* std::cout << "x: " << std::endl << x << std::endl; */
     /* std::cout << "S rowmean: " << std::endl << S.rowwise().mean() << std::endl; */
@@ -172,46 +239,110 @@ namespace mrs_lib
   }
   //}
 
+  /* computeSigmas() method (workspace) //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::computeSigmas(const x_t& x, const P_t& P, workspace_t& ws) const
+  {
+    const int n_dim = x.rows();
+
+    // calculate the square root of the covariance matrix
+    ws.Pa = (double(n_dim) + ws.lambda)*P;
+    ws.llt.compute(ws.Pa);
+    if (ws.llt.info() != Eigen::Success)
+    {
+      ws.Pa.diagonal().array() += (double(n_dim) + ws.lambda)*1e-9;
+      ws.llt.compute(ws.Pa);
+      if (ws.llt.info() != Eigen::Success)
+      {
+        ROS_WARN("UKF: taking the square root of covariance during sigma point generation failed.");
+        throw square_root_exception();
+      }
+    }
+    ws.Pa_sqrt = ws.llt.matrixL();
+
+    // calculate sigma points
+    // fill in the middle of the elipsoid
+    ws.S.col(0) = x;
+
+    // positive sigma points
+    ws.S.template block<n, n>(0, 1, n_dim, n_dim) = ws.Pa_sqrt.colwise() + x;
+
+    // negative sigma points
+    ws.S.template block<n, n>(0, n_dim+1, n_dim, n_dim) = (-ws.Pa_sqrt).colwise() + x;
+  }
+  //}
+
+  /* computeKalmanGain() method (workspace) //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::computeKalmanGain([[maybe_unused]] const x_t& x, workspace_t& ws) const
+  {
+    ws.llt_zz.compute(ws.Pzz);
+    if (ws.llt_zz.info() != Eigen::Success)
+    {
+      // Pzz is not positive definite, use the general inverse (which allocates for dynamic sizes, but this should not happen normally)
+      ws.K.noalias() = ws.Pxz * computeInverse(ws.Pzz);
+      return;
+    }
+
+    // K = Pxz*Pzz^-1 is obtained without the inverse by solving Pzz*K^T = Pxz^T in-place (Pzz is symmetric)
+    ws.K = ws.Pxz;
+    ws.llt_zz.solveInPlace(ws.K.transpose());
+  }
+  //}
+
   /* predict() method //{ */
 
   template <int n_states, int n_inputs, int n_measurements>
-  typename UKF<n_states, n_inputs, n_measurements>::statecov_t UKF<n_states, n_inputs, n_measurements>::predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+  void UKF<n_states, n_inputs, n_measurements>::predictInPlace(statecov_t& sc, const u_t& u, const Q_t& Q, double dt, workspace_t& ws) const
   {
-    const auto& x = sc.x;
-    const auto& P = sc.P;
-    statecov_t ret;
+    const int n_dim = sc.x.rows();
+    const int w_dim = 2 * n_dim + 1;
+    // the measurement dimension is not known during prediction, so keep the last one
+    const int p_dim = ws.n_z >= 0 ? ws.n_z : std::max(p, 0);
+    prepareWorkspace(n_dim, p_dim, ws);
 
-    const X_t S = computeSigmas(x, P);
+    computeSigmas(sc.x, sc.P, ws);
 
     // propagate sigmas through the transition model
-    X_t X;
-    for (int i = 0; i < w; i++)
+    for (int i = 0; i < w_dim; i++)
     {
-      X.col(i) = m_transition_model(S.col(i), u, dt);
+      ws.x_sigma = ws.S.col(i);
+      if (m_transition_model_inplace)
+        m_transition_model_inplace(ws.x_sigma, u, dt, ws.x_model);
+      else
+        ws.x_model = m_transition_model(ws.x_sigma, u, dt);
+      ws.X.col(i) = ws.x_model;
     }
 
-    /* std::cout << "x: " << std::endl << x << std::endl; */
-    /* std::cout << "X rowmean: " << std::endl << X.rowwise().mean() << std::endl; */
-    /* std::cout << "m_Wm sum: " << m_Wm.sum() << std::endl; */
-
     // recompute the state vector
-    ret.x = x_t::Zero();
-    for (int i = 0; i < w; i++)
+    ws.x.setZero();
+    for (int i = 0; i < w_dim; i++)
     {
       //TODO: WHY DOES THIS SHIT WORK IF I SUBSTITUTE m_Wm(i) FOR 1.0/w ??
-      x_t tmp = 1.0/w * X.col(i);
-      /* x_t tmp = m_Wm(i) * X.col(i); */
-      ret.x += tmp;
+      ws.x += 1.0/w_dim * ws.X.col(i);
+      /* ws.x += ws.Wm(i) * ws.X.col(i); */
     }
 
     // recompute the covariance
-    ret.P = P_t::Zero();
-    for (int i = 0; i < w; i++)
+    ws.P.setZero();
+    for (int i = 0; i < w_dim; i++)
     {
-      ret.P += m_Wc(i) * (X.col(i) - ret.x) * (X.col(i) - ret.x).transpose();
+      ws.dx = ws.X.col(i) - ws.x;
+      ws.P.noalias() += ws.Wc(i) * ws.dx * ws.dx.transpose();
     }
-    ret.P += Q;
+    ws.P += Q;
+
+    sc.x = ws.x;
+    sc.P = ws.P;
+  }
 
+  template <int n_states, int n_inputs, int n_measurements>
+  typename UKF<n_states, n_inputs, n_measurements>::statecov_t UKF<n_states, n_inputs, n_measurements>::predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+  {
+    statecov_t ret;
+    ret.x = sc.x;
+    ret.P = sc.P;
+    predictInPlace(ret, u, Q, dt, m_ws);
     return ret;
   }
 
@@ -219,57 +350,89 @@ namespace mrs_lib
 
   /* correct() method //{ */
 
+  // calculates the innovation ws.inn and the covariances ws.Pzz and ws.Pxz
   template <int n_states, int n_inputs, int n_measurements>
-  typename UKF<n_states, n_inputs, n_measurements>::statecov_t UKF<n_states, n_inputs, n_measurements>::correct(const statecov_t& sc, const z_t& z, const R_t& R) const
+  void UKF<n_states, n_inputs, n_measurements>::prepareCorrection(const statecov_t& sc, const z_t& z, const R_t& R, workspace_t& ws) const
   {
-    const auto& x = sc.x;
-    const auto& P = sc.P;
-    const X_t S = computeSigmas(x, P);
+    const int n_dim = sc.x.rows();
+    const int w_dim = 2 * n_dim + 1;
+    prepareWorkspace(n_dim, z.rows(), ws);
+
+    computeSigmas(sc.x, sc.P, ws);
 
     // propagate sigmas through the observation model
-    Z_t Z_exp(z.rows(), w);
-    for (int i = 0; i < w; i++)
+    for (int i = 0; i < w_dim; i++)
     {
-      Z_exp.col(i) = m_observation_model(S.col(i));
+      ws.x_sigma = ws.S.col(i);
+      if (m_observation_model_inplace)
+        m_observation_model_inplace(ws.x_sigma, ws.z_model);
+      else
+        ws.z_model = m_observation_model(ws.x_sigma);
+      ws.Z.col(i) = ws.z_model;
     }
 
     // compute expected measurement
-    z_t z_exp = z_t::Zero(z.rows());
-    for (int i = 0; i < w; i++)
+    ws.z_exp.setZero();
+    for (int i = 0; i < w_dim; i++)
     {
-      z_exp += m_Wm(i) * Z_exp.col(i);
+      ws.z_exp += ws.Wm(i) * ws.Z.col(i);
     }
 
     // compute the covariance of measurement
-    Pzz_t Pzz = Pzz_t::Zero(z.rows(), z.rows());
-    for (int i = 0; i < w; i++)
+    ws.Pzz.setZero();
+    for (int i = 0; i < w_dim; i++)
     {
-      Pzz += m_Wc(i) * (Z_exp.col(i) - z_exp) * (Z_exp.col(i) - z_exp).transpose();
+      ws.dz = ws.Z.col(i) - ws.z_exp;
+      ws.Pzz.noalias() += ws.Wc(i) * ws.dz * ws.dz.transpose();
     }
-    Pzz += R;
+    ws.Pzz += R;
 
     // compute cross covariance
-    K_t Pxz = K_t::Zero(n, z.rows());
-    for (int i = 0; i < w; i++)
+    ws.Pxz.setZero();
+    for (int i = 0; i < w_dim; i++)
     {
-      Pxz += m_Wc(i) * (S.col(i) - x) * (Z_exp.col(i) - z_exp).transpose();
+      ws.dx = ws.S.col(i) - sc.x;
+      ws.dz = ws.Z.col(i) - ws.z_exp;
+      ws.Pxz.noalias() += ws.Wc(i) * ws.dx * ws.dz.transpose();
     }
 
-    // compute Kalman gain
-    const z_t inn = (z - z_exp); // innovation
-    const K_t K = computeKalmanGain(sc.x, inn, Pxz, Pzz);
+    ws.inn = z - ws.z_exp; // innovation
+  }
 
+  // corrects the state and covariance using the Kalman gain ws.K
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::applyCorrection(statecov_t& sc, workspace_t& ws) const
+  {
     // check whether the inverse produced valid numbers
-    if (!K.array().isFinite().all())
+    if (!ws.K.array().isFinite().all())
     {
       ROS_ERROR("UKF: inverting of Pzz in correction update produced non-finite numbers!!! Fix your covariances (the measurement's is probably too low...)");
       throw inverse_exception();
     }
 
     // correct
+    sc.x.noalias() += ws.K * ws.inn;
+    ws.KPzz.noalias() = ws.K * ws.Pzz;
+    sc.P.noalias() -= ws.KPzz * ws.K.transpose();
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::correctInPlace(statecov_t& sc, const z_t& z, const R_t& R, workspace_t& ws) const
+  {
+    prepareCorrection(sc, z, R, ws);
+    computeKalmanGain(sc.x, ws);
+    applyCorrection(sc, ws);
+  }
+
+  template <int n_states, int n_inputs, int n_measurements>
+  typename UKF<n_states, n_inputs, n_measurements>::statecov_t UKF<n_states, n_inputs, n_measurements>::correct(const statecov_t& sc, const z_t& z, const R_t& R) const
+  {
     statecov_t ret;
-    ret.x = x + K * inn;
-    ret.P = P - K * Pzz * K.transpose();
+    ret.x = sc.x;
+    ret.P = sc.P;
+    prepareCorrection(ret, z, R, m_ws);
+    m_ws.K = computeKalmanGain(ret.x, m_ws.inn, m_ws.Pxz, m_ws.Pzz);
+    applyCorrection(ret, m_ws);
     return ret;
   }
 
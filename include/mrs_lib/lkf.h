@@ -75,6 +75,17 @@ namespace mrs_lib
         return "LKF: could not compute matrix inversion!!! Fix your covariances (the measurement's is probably too low...)";
       }
     };
+
+  /*!
+    * \brief Selects how the correction step is computed (see setCorrectionMode()).
+    */
+    enum class correction_mode_t
+    {
+      standard,     /*!< \brief Kalman gain using the inverse of the innovation covariance and the simple \f$ (\mathbf{I} - \mathbf{K}\mathbf{H})\mathbf{P} \f$ covariance update. */
+      joseph,       /*!< \brief Same Kalman gain as #standard, but the numerically more robust Joseph form of the covariance update. */
+      information,  /*!< \brief Information (inverse covariance) form, which only inverts \f$ n \times n \f$ matrices (cheaper when \f$ p \gg n \f$, especially with a diagonal \f$ \mathbf{R} \f$). */
+      sequential,   /*!< \brief Measurements are processed one by one as scalars, which avoids any matrix inverse (a non-diagonal \f$ \mathbf{R} \f$ is decorrelated first). */
+    };
     //}
 
   public:
@@ -111,10 +122,49 @@ namespace mrs_lib
     virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override
     {
       /* return correct_optimized(sc, z, R, H); */
-      return correction_impl(sc, z, R, H);
+      switch (m_correction_mode)
+      {
+        case correction_mode_t::joseph:
+          return correction_joseph(sc, z, R, H);
+        case correction_mode_t::information:
+          return correction_information(sc, z, R, H);
+        case correction_mode_t::sequential:
+          return correction_sequential(sc, z, R, H);
+        default:
+          return correction_impl(sc, z, R, H);
+      }
     };
     //}
 
+    /* setCorrectionMode() method //{ */
+  /*!
+    * \brief Selects how the correction step is computed by this instance.
+    *
+    * All the modes are mathematically equivalent, they only differ in the computational cost and numerical properties.
+    * The #correction_mode_t::information mode is cheaper for many measurements of a small state and
+    * the #correction_mode_t::sequential mode avoids inverting any matrix for a diagonal measurement covariance.
+    *
+    * \param mode        The new correction mode (#correction_mode_t::standard by default).
+    *
+    * \note The #correction_mode_t::information and #correction_mode_t::sequential modes do not use the computeKalmanGain() method,
+    * so they should not be used with derived classes, which override it (such as the NCLKF).
+    */
+    void setCorrectionMode(const correction_mode_t mode)
+    {
+      m_correction_mode = mode;
+    }
+
+  /*!
+    * \brief Returns the correction mode used by this instance.
+    *
+    * \return            The current correction mode.
+    */
+    correction_mode_t getCorrectionMode() const
+    {
+      return m_correction_mode;
+    }
+    //}
+
     /* predict() method //{ */
   /*!
     * \brief Applies the prediction (time) step of the Kalman filter.
@@ -149,6 +199,9 @@ namespace mrs_lib
     B_t B;  /*!< \brief The input to state mapping matrix \f$n \times m\f$ */
     H_t H;  /*!< \brief The state to measurement mapping matrix \f$p \times n\f$ */
 
+  protected:
+    correction_mode_t m_correction_mode = correction_mode_t::standard;
+
   protected:
     /* covariance_predict() method //{ */
     static P_t covariance_predict(const A_t& A, const P_t& P, const Q_t& Q, const double dt)
@@ -229,6 +282,89 @@ namespace mrs_lib
     }
     //}
 
+    /* correction_joseph() method //{ */
+    statecov_t correction_joseph(const statecov_t& sc, const z_t& z, const R_t& R, const H_t& H) const
+    {
+      statecov_t ret;
+      const K_t K = computeKalmanGain(sc, z, R, H);
+      ret.x = sc.x + K * (z - (H * sc.x));
+      const P_t IKH = P_t::Identity(sc.P.rows(), sc.P.cols()) - K * H;
+      ret.P = IKH * sc.P * IKH.transpose() + K * R * K.transpose();
+      return ret;
+    }
+    //}
+
+    /* correction_information() method //{ */
+    statecov_t correction_information(const statecov_t& sc, const z_t& z, const R_t& R, const H_t& H) const
+    {
+      // R^-1*H is the only operation with the measurement-sized matrices (trivial for a diagonal R)
+      H_t RiH;
+      if (R.isDiagonal(0.0))
+      {
+        if (!(R.diagonal().array() > 0.0).all())
+          throw inverse_exception();
+        RiH = R.diagonal().cwiseInverse().asDiagonal() * H;
+      } else
+      {
+        const Eigen::LLT<R_t> R_llt(R);
+        if (R_llt.info() != Eigen::Success)
+          throw inverse_exception();
+        RiH = R_llt.solve(H);
+      }
+
+      // the posterior information matrix P^-1 + H^T*R^-1*H
+      const P_t I = P_t::Identity(sc.P.rows(), sc.P.cols());
+      const Eigen::LLT<P_t> P_llt(sc.P);
+      if (P_llt.info() != Eigen::Success)
+        throw inverse_exception();
+      const P_t Y = P_llt.solve(I) + H.transpose() * RiH;
+      const Eigen::LLT<P_t> Y_llt(Y);
+      if (Y_llt.info() != Eigen::Success)
+        throw inverse_exception();
+
+      statecov_t ret;
+      ret.P = Y_llt.solve(I);
+      ret.x = sc.x + ret.P * (RiH.transpose() * (z - H * sc.x));
+      if (!ret.x.allFinite() || !ret.P.allFinite())
+        throw inverse_exception();
+      return ret;
+    }
+    //}
+
+    /* correction_sequential() method //{ */
+    statecov_t correction_sequential(const statecov_t& sc, const z_t& z, const R_t& R, const H_t& H) const
+    {
+      statecov_t ret = sc;
+      const auto update = [&ret](const auto& h, const double z, const double r)
+      {
+        const x_t PHt = ret.P * h.transpose();
+        const double s = h.dot(PHt) + r;
+        if (!(s > 0.0))
+          throw inverse_exception();
+        const x_t K = PHt / s;
+        ret.x += K * (z - h.dot(ret.x));
+        ret.P -= K * PHt.transpose();
+      };
+
+      if (R.isDiagonal(0.0))
+      {
+        for (int it = 0; it < z.rows(); it++)
+          update(H.row(it), z(it), R(it, it));
+      } else
+      {
+        // decorrelate the measurements using the Cholesky factor of R, so that their covariance becomes identity
+        const Eigen::LLT<R_t> R_llt(R);
+        if (R_llt.info() != Eigen::Success)
+          throw inverse_exception();
+        const H_t Hw = R_llt.matrixL().solve(H);
+        const z_t zw = R_llt.matrixL().solve(z);
+        for (int it = 0; it < z.rows(); it++)
+          update(Hw.row(it), zw(it), 1.0);
+      }
+      return ret;
+    }
+    //}
+
     // NOT USED METHODS
     /* correction_optimized() method //{ */
     // No notable performance gain was observed for the matrix sizes we use, so this is not used.
@@ -8,20 +8,39 @@
  */
 
 #include <boost/circular_buffer.hpp>
+#include <atomic>
 #include <mutex>
 #include <cmath>
-#include <vector>
-#include <optional>
+#include <set>
 
 namespace mrs_lib
 {
   /**
    * \brief Implementation of a median filter with a fixed-length buffer.
    *
+   * The buffered values are additionally kept sorted in two halves (a lower and an upper one), which are updated
+   * incrementally whenever a value is added and the oldest one is evicted. Adding a value thus costs O(log n)
+   * and obtaining the median costs O(1), where n is the buffer length. Once the buffer is full, the nodes
+   * of the evicted values are reused, so no memory is allocated when adding new values.
+   *
+   * By default, all methods are thread-safe and may be called from any thread. If the values are only added from
+   * a single thread while the median is read from other threads, the threading_mode_t::single_writer mode may be
+   * used instead (see setThreadingMode()). In this mode, the writer does not lock any mutex and the median is published
+   * to the readers through a sequence lock, so the readers never block the writer.
+   *
    */
   class MedianFilter
   {
     public:
+      /*!
+       * \brief Determines how the filter is protected against concurrent access.
+       */
+      enum class threading_mode_t
+      {
+        locking,       /*!< \brief All methods lock a mutex, so they may be called from any thread (the default). */
+        single_writer, /*!< \brief Only median(), full() and initialized() may be called from other threads than the single writer thread. None of the methods lock a mutex. */
+      };
+
       /*!
        * \brief The main constructor.
        *
@@ -85,7 +104,7 @@ namespace mrs_lib
       /*!
        * \brief Add a new value to the buffer.
        *
-       * \note The median value will not be updated until the median() method is called (lazy evaluation).
+       * If the buffer is full, the oldest value is removed from it.
        *
        * \param value   the new value to be added to the buffer.
        */
@@ -108,8 +127,6 @@ namespace mrs_lib
        * The value is compliant if it's above the \p min_value, below the \p max_value
        * and its (absolute) difference from the current mean is below \p max_diff.
        *
-       * \note The median value will not be updated until the median() method is called (lazy evaluation).
-       *
        * \param value   the new value to be added to the buffer and checked.
        * \return        true if the value is compliant, false otherwise.
        */
@@ -134,10 +151,9 @@ namespace mrs_lib
       /*!
        * \brief Obtain the median.
        *
-       * If an up-to-date median value is available, it's not recalculated.
-       * Otherwise, the new median value is calculated and then returned (lazy evaluation).
+       * For an even number of buffered values, the mean of the two middle values is returned.
        *
-       * \return        the current median value (returns \p nan if the input buffer is empty).
+       * \return        the current median value (returns \p nan if the input buffer is empty or contains a \p nan).
        */
       double median() const;
 
@@ -184,15 +200,63 @@ namespace mrs_lib
        */
       void setMaxDifference(const double max_diff);
 
+      /*!
+       * \brief Set how the filter is protected against concurrent access.
+       *
+       * In the threading_mode_t::single_writer mode, all methods except for median(), full() and initialized() have to be
+       * called from the same (writer) thread. The remaining methods may be called concurrently from any number of reader
+       * threads - they return the state published after the last modification of the filter and never block the writer.
+       *
+       * \warning Only change the mode before the filter is accessed from multiple threads.
+       *
+       * \param mode   the new threading mode.
+       */
+      void setThreadingMode(const threading_mode_t mode);
+
+      /*!
+       * \brief Get the current threading mode.
+       *
+       * \return the current threading mode.
+       */
+      threading_mode_t getThreadingMode() const;
+
     private:
       // for thread-safety
       mutable std::recursive_mutex m_mtx;
+
+      // the state published for the readers in the single_writer mode (protected by a sequence lock)
+      // it is kept in a separate cache line together with the threading mode, so that the readers don't interfere
+      // with the data modified by the writer
+      alignas(64) std::atomic<uint64_t> m_snapshot_seq;
+      std::atomic<double> m_snapshot_median;
+      std::atomic<size_t> m_snapshot_size;
+      std::atomic<size_t> m_snapshot_capacity;
+      std::atomic<threading_mode_t> m_threading_mode;
       // the input buffer
-      boost::circular_buffer<double> m_buffer;
-      // a helper buffer for sorting the input buffer
-      mutable std::vector<double> m_buffer_sorted;
-      // the last median value for lazy evaluation
-      mutable std::optional<double> m_median;
+      alignas(64) boost::circular_buffer<double> m_buffer;
+      // the lower half of the sorted buffer (contains one more element than the upper half for an odd number of elements)
+      std::multiset<double> m_lower;
+      // the upper half of the sorted buffer
+      std::multiset<double> m_upper;
+      // number of nan values in the buffer (these are not kept in the sorted halves)
+      size_t m_n_nans;
+
+      // inserts the value to the sorted halves, reusing the node of the removed value if available
+      void insertSorted(const double value, std::multiset<double>::node_type&& node);
+      // removes the value from the sorted halves and returns its node for reuse
+      std::multiset<double>::node_type eraseSorted(const double value);
+      // moves elements between the sorted halves so that their sizes differ by at most one
+      void rebalanceSorted();
+      // rebuilds the sorted halves from the current buffer
+      void rebuildSorted();
+      // calculates the median from the sorted halves
+      double calculateMedian() const;
+      // locks the mutex unless in the single_writer mode
+      std::unique_lock<std::recursive_mutex> lock() const;
+      // publishes the current state for the readers (does nothing unless in the single_writer mode)
+      void publishSnapshot();
+      // reads the last published state
+      void readSnapshot(double& median, size_t& size, size_t& capacity) const;
 
       // parameters specified by the user
       double m_min_valid;
@@ -0,0 +1,136 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines MPSCQueue - a bounded lock-free multi-producer single-consumer queue.
+ */
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Bounded lock-free multi-producer single-consumer queue.
+   *
+   * The queue is implemented as a ring buffer of preallocated slots, each of which holds a sequence number used
+   * to synchronize the producers with the consumer (a variant of the Dmitry Vyukov's bounded queue). Pushing and popping
+   * never blocks and never allocates memory (except for what the copy of \p T itself may do). If the queue is full,
+   * push() fails instead of waiting for the consumer.
+   *
+   * Any number of threads may call push() concurrently, but only a single thread may call pop() at a time.
+   *
+   * \tparam T  type of the elements stored in the queue (has to be default-constructible and copy- or move-assignable).
+   *
+   */
+  template <typename T>
+  class MPSCQueue
+  {
+  public:
+    /*!
+     * \brief The main constructor.
+     *
+     * \param capacity  Minimal number of elements that the queue can hold (it is rounded up to the nearest power of two).
+     */
+    MPSCQueue(const size_t capacity)
+      : m_capacity(roundUpPow2(capacity)), m_mask(m_capacity - 1), m_slots(std::make_unique<slot_t[]>(m_capacity)), m_head(0), m_tail(0)
+    {
+      for (size_t it = 0; it < m_capacity; it++)
+        m_slots[it].seq.store(it, std::memory_order_relaxed);
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /*!
+     * \brief Adds a new element to the queue. May be called from any thread.
+     *
+     * \param value  The element to be added.
+     * \return       true if the element was added, false if the queue was full.
+     */
+    template <typename U>
+    bool push(U&& value)
+    {
+      size_t pos = m_head.load(std::memory_order_relaxed);
+      slot_t* slot;
+      while (true)
+      {
+        slot = &m_slots[pos & m_mask];
+        const size_t seq = slot->seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0)
+        {
+          // the slot is free, try to claim it
+          if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        } else if (diff < 0)
+        {
+          // the slot still contains an element, which was not popped yet - the queue is full
+          return false;
+        } else
+        {
+          // another producer claimed the slot in the meantime, try again
+          pos = m_head.load(std::memory_order_relaxed);
+        }
+      }
+      slot->value = std::forward<U>(value);
+      // publish the element to the consumer
+      slot->seq.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /*!
+     * \brief Removes the oldest element from the queue. May only be called from a single thread at a time.
+     *
+     * \param value  Output variable, which will be set to the removed element.
+     * \return       true if an element was removed, false if the queue was empty.
+     */
+    bool pop(T& value)
+    {
+      slot_t& slot = m_slots[m_tail & m_mask];
+      const size_t seq = slot.seq.load(std::memory_order_acquire);
+      if (seq != m_tail + 1)
+        return false;
+      value = std::move(slot.value);
+      // release the slot to the producers for the next round
+      slot.seq.store(m_tail + m_capacity, std::memory_order_release);
+      m_tail++;
+      return true;
+    }
+
+    /*!
+     * \brief Returns the maximal number of elements that the queue can hold.
+     *
+     * \return  The capacity of the queue.
+     */
+    size_t capacity() const
+    {
+      return m_capacity;
+    }
+
+  private:
+    struct slot_t
+    {
+      std::atomic<size_t> seq;
+      T value;
+    };
+
+    static size_t roundUpPow2(const size_t value)
+    {
+      size_t ret = 1;
+      while (ret < value)
+        ret <<= 1;
+      return ret;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<slot_t[]> m_slots;
+    // the producers and the consumer positions are kept on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) size_t m_tail;
+  };
+}  // namespace mrs_lib
+
+#endif  // MPSC_QUEUE_H
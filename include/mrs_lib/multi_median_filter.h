@@ -0,0 +1,266 @@
+#ifndef MULTI_MEDIAN_FILTER
+#define MULTI_MEDIAN_FILTER
+
+/**  \file
+     \brief Defines the MultiMedianFilter class.
+ */
+
+#include <Eigen/Dense>
+#include <mutex>
+#include <cmath>
+#include <vector>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Implementation of a median filter with a fixed-length buffer for multiple independent channels.
+   *
+   * This class behaves as a number of \ref MedianFilter objects with the same buffer length, which are all updated
+   * at once with a vector of new values (one value per channel), e.g. the beams of a multi-beam rangefinder. The values
+   * are validated against the minimal and maximal thresholds and against the maximal difference from the median
+   * separately for each channel, and the thresholds may be set either for all channels at once or for each channel separately.
+   *
+   * The values of all channels are stored in a single buffer, where each row contains one sample of all the channels.
+   * For short buffers, the medians of all channels are calculated at once using a sorting network, which compares
+   * and swaps whole rows of the buffer using vectorized instructions. The network is pruned to the comparators
+   * necessary for obtaining the middle elements. For longer buffers, the values of each channel are instead kept sorted
+   * in a contiguous column, which is updated by a binary search and a shift whenever new values are added.
+   *
+   * \note Unlike the \ref MedianFilter, the newest values are kept when the buffer length is decreased.
+   *
+   */
+  class MultiMedianFilter
+  {
+    public:
+      //! vector of one value per channel typedef
+      using values_t = Eigen::VectorXd;
+      //! vector of one flag per channel typedef
+      using mask_t = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+      //! the longest buffer, for which the medians are calculated using a sorting network
+      static constexpr size_t max_network_length = 16;
+
+      /*!
+       * \brief The main constructor.
+       *
+       * \param n_channels      the number of independent channels.
+       * \param buffer_length   the number of last values to be kept in the buffer of each channel.
+       * \param min_value       values below this threshold will be discarded (won't be added to the buffer).
+       * \param max_value       values above this threshold will be discarded.
+       * \param max_diff        values that differ from the current median of their channel by more than this threshold will be discarded.
+       */
+      MultiMedianFilter(const size_t n_channels, const size_t buffer_length, const double min_value = -std::numeric_limits<double>::infinity(), const double max_value = std::numeric_limits<double>::infinity(), const double max_diff = std::numeric_limits<double>::infinity());
+
+      /*!
+       * \brief A convenience empty constructor that will construct an invalid filter.
+       *
+       * \warning This constructor will construct an unusable filter with zero channels and a zero-length buffer.
+       * To actually initialize this object, use the main constructor.
+       * You can use the initialized() method to check whether the object is valid.
+       *
+       */
+      MultiMedianFilter();
+
+      /*!
+       * \brief A convenience copy constructor.
+       *
+       * This constructor copies all data from the object that is being assigned from in a thread-safe manner.
+       *
+       * \param  other  the object to assign from.
+       *
+       */
+      MultiMedianFilter(const MultiMedianFilter& other);
+
+      /**
+       * \brief A convenience copy assignment operator.
+       *
+       * This operator copies all data from the object that is being assigned from in a thread-safe manner.
+       *
+       * \param  other  the object to assign from.
+       * \return        a reference to the object being assigned to.
+       */
+      MultiMedianFilter& operator=(const MultiMedianFilter& other);
+
+      /*!
+       * \brief Add new values of all channels to the buffer.
+       *
+       * If the buffer is full, the oldest values are removed from it.
+       *
+       * \note The median values will not be updated until the median() method is called (lazy evaluation).
+       *
+       * \param values   the new values to be added to the buffer (one per channel).
+       */
+      void add(const values_t& values);
+
+      /*!
+       * \brief Check whether the values comply with the constraints of their channel.
+       *
+       * A value is compliant if it's above the \p min_value, below the \p max_value
+       * and its (absolute) difference from the current median of its channel is below \p max_diff.
+       *
+       * \param values   the values to be checked (one per channel).
+       * \return         a flag for each channel, which is true if the value is compliant, false otherwise.
+       */
+      mask_t check(const values_t& values);
+
+      /*!
+       * \brief Add new values of all channels to the buffer and check if they comply with the constraints of their channel.
+       *
+       * A value is compliant if it's above the \p min_value, below the \p max_value
+       * and its (absolute) difference from the current median of its channel is below \p max_diff.
+       *
+       * \param values   the new values to be added to the buffer and checked (one per channel).
+       * \return         a flag for each channel, which is true if the value is compliant, false otherwise.
+       */
+      mask_t addCheck(const values_t& values);
+
+      /*!
+       * \brief Clear the buffer of all values.
+       *
+       * Doesn't change the buffer's length, the number of channels or any other parameters, only clears all stored values.
+       */
+      void clear();
+
+      /*!
+       * \brief Check whether the buffer is filled with values.
+       *
+       * If true, adding new values will remove the oldest values in the buffer.
+       *
+       * \return        true if the buffer contains \p buffer_length values of each channel.
+       */
+      bool full() const;
+
+      /*!
+       * \brief Obtain the medians of all channels.
+       *
+       * If up-to-date median values are available, they're not recalculated.
+       * Otherwise, the new median values are calculated and then returned (lazy evaluation).
+       * For an even number of buffered values, the mean of the two middle values is returned.
+       *
+       * \return        the current median value of each channel (\p nan for channels with an empty buffer or with a \p nan in the buffer).
+       */
+      values_t median() const;
+
+      /*!
+       * \brief Check whether the filter was initialized with a valid buffer length and number of channels.
+       *
+       * \return true if the buffer length and the number of channels are larger than zero.
+       */
+      bool initialized() const;
+
+      /*!
+       * \brief Get the number of channels.
+       *
+       * \return the number of independent channels of the filter.
+       */
+      size_t channels() const;
+
+      /*!
+       * \brief Set a new size of the buffer.
+       *
+       * \note The median values may change.
+       *
+       * \param buffer_length   the new size of the buffer.
+       */
+      void setBufferLength(const size_t buffer_length);
+
+      /*!
+       * \brief Set a new minimal threshold for new values of all channels.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param min_value   the new minimal value of new buffer elements.
+       */
+      void setMinValue(const double min_value);
+
+      /*!
+       * \brief Set new minimal thresholds for new values of each channel.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param min_values   the new minimal values of new buffer elements (one per channel).
+       */
+      void setMinValue(const values_t& min_values);
+
+      /*!
+       * \brief Set a new maximal threshold for new values of all channels.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_value   the new maximal value of new buffer elements.
+       */
+      void setMaxValue(const double max_value);
+
+      /*!
+       * \brief Set new maximal thresholds for new values of each channel.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_values   the new maximal values of new buffer elements (one per channel).
+       */
+      void setMaxValue(const values_t& max_values);
+
+      /*!
+       * \brief Set a new maximal difference from median for new values of all channels.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_diff   the new maximal difference of new buffer elements from the current median of their channel.
+       */
+      void setMaxDifference(const double max_diff);
+
+      /*!
+       * \brief Set new maximal differences from median for new values of each channel.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_diffs   the new maximal differences of new buffer elements from the current median of their channel (one per channel).
+       */
+      void setMaxDifference(const values_t& max_diffs);
+
+    private:
+      using buffer_t = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+      using comparator_t = std::pair<int, int>;
+      using network_t = std::vector<comparator_t>;
+
+      // for thread-safety
+      mutable std::recursive_mutex m_mtx;
+      // the input buffer - each row contains values of all channels added at once
+      buffer_t m_buffer;
+      // index of the row, to which the next values will be written
+      size_t m_next;
+      // number of the values of each channel in the buffer
+      size_t m_size;
+      // number of nan values of each channel in the buffer
+      Eigen::ArrayXi m_n_nans;
+
+      // a helper buffer for sorting the input buffer using the sorting networks
+      mutable buffer_t m_buffer_sorted;
+      // a helper row for swapping the rows of the sorted buffer
+      mutable Eigen::RowVectorXd m_row_min;
+      // for long buffers, the values of each channel (except for nans) are kept sorted in a column
+      Eigen::MatrixXd m_channels_sorted;
+      // the last median values for lazy evaluation
+      mutable values_t m_median;
+      mutable bool m_median_valid;
+      // sorting networks pruned to the middle elements for each number of buffered values up to max_network_length
+      std::vector<network_t> m_networks;
+
+      // parameters specified by the user
+      values_t m_min_valid;
+      values_t m_max_valid;
+      values_t m_max_diff;
+
+      // calculates the medians of all channels and caches them
+      void calculateMedian() const;
+      // removes the values that will be overwritten from the sorted channels and inserts the new values
+      void updateChannelsSorted(const values_t& values, const bool full);
+      // generates the sorting networks for the current buffer length
+      void generateNetworks();
+      // generates a sorting network for n elements pruned to the comparators affecting the middle elements
+      static network_t generateMedianNetwork(const int n);
+  };
+
+}  // namespace mrs_lib
+
+#endif
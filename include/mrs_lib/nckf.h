@@ -387,6 +387,12 @@ namespace mrs_lib
     
       return K;
     }
+
+    // the norm-constrained gain is also used by correctInPlace()
+    virtual void computeKalmanGain(const x_t& x, typename Base_class::workspace_t& ws) const override
+    {
+      ws.K = computeKalmanGain(x, ws.inn, ws.Pxz, ws.Pzz);
+    }
     //}
 
   };
@@ -6,6 +6,7 @@
 
 #include <Eigen/Dense>
 #include <ros/ros.h>
+#include <memory>
 
 #include <mrs_lib/iir_filter.h>
 
@@ -24,6 +25,116 @@ private:
   std::unique_ptr<mrs_lib::IirFilter> filter;
 };
 
+/**
+ * \brief A bank of second-order notch filters applied in series to one or more channels.
+ *
+ * Each notch is designed in the same way as the \ref NotchFilter and realized as one section of an \ref IirSosFilter,
+ * so multiple notches (e.g. harmonics of the motor frequency) are removed from multiple channels (e.g. the gyro axes)
+ * by a single filter. Whole blocks of samples of all channels may be filtered in one call.
+ *
+ * The center frequencies and bandwidths of the notches may be changed at runtime without resetting the filter state
+ * and without any memory allocation.
+ */
+class NotchFilterBank {
+
+public:
+  /*!
+   * \brief The main constructor.
+   *
+   * \param sample_rate     sampling frequency of the filtered signal [Hz].
+   * \param frequencies_in  center frequencies of the notches [Hz].
+   * \param bandwidths_in   bandwidths of the notches [Hz], one per notch.
+   * \param n_channels      number of the independent channels to be filtered.
+   */
+  NotchFilterBank(const double& sample_rate, const std::vector<double>& frequencies_in, const std::vector<double>& bandwidths_in, const size_t n_channels = 1);
+
+  /*!
+   * \brief Filters a single sample of a single-channel filter.
+   *
+   * \param sample_in  the new sample.
+   * \return           the filtered sample.
+   */
+  double iterate(const double& sample_in);
+
+  /*!
+   * \brief Filters a single sample of all channels.
+   *
+   * \param samples_in   the new sample of each channel.
+   * \param samples_out  the filtered sample of each channel (may be the same vector as the input).
+   */
+  void iterate(const Eigen::Ref<const Eigen::VectorXd>& samples_in, Eigen::Ref<Eigen::VectorXd> samples_out);
+
+  /*!
+   * \brief Filters a block of samples of a single-channel filter.
+   *
+   * \param samples_in   pointer to the first of the new samples.
+   * \param samples_out  pointer to the first of the filtered samples (may be the same as the input).
+   * \param n_samples    number of the samples.
+   */
+  void filter(const double* samples_in, double* samples_out, const size_t n_samples);
+
+  /*!
+   * \brief Filters a block of samples of all channels.
+   *
+   * \param samples_in   the new samples, one channel per row and one sample per column.
+   * \param samples_out  the filtered samples of the same size as the input (may be the same matrix as the input).
+   */
+  void filter(const Eigen::Ref<const IirSosFilter::samples_t>& samples_in, Eigen::Ref<IirSosFilter::samples_t> samples_out);
+
+  /*!
+   * \brief Changes the center frequency of a single notch.
+   *
+   * \param index      index of the notch.
+   * \param frequency  the new center frequency [Hz].
+   * \return           false if the index or the frequency is invalid (the notch is not changed), true otherwise.
+   */
+  bool setFrequency(const size_t index, const double& frequency);
+
+  /*!
+   * \brief Changes the center frequency and the bandwidth of a single notch.
+   *
+   * \param index      index of the notch.
+   * \param frequency  the new center frequency [Hz].
+   * \param bandwidth  the new bandwidth [Hz].
+   * \return           false if the index, the frequency or the bandwidth is invalid (the notch is not changed), true otherwise.
+   */
+  bool setFrequency(const size_t index, const double& frequency, const double& bandwidth);
+
+  /*!
+   * \brief Changes the center frequencies of all notches.
+   *
+   * \param frequencies  the new center frequencies [Hz], one per notch.
+   * \return             false if the number of frequencies doesn't match or some of them is invalid (such notches are not changed), true otherwise.
+   */
+  bool setFrequencies(const std::vector<double>& frequencies);
+
+  /*!
+   * \brief Resets the state of the filter to zero.
+   */
+  void reset();
+
+  /*!
+   * \brief Returns the number of notches.
+   */
+  size_t size() const;
+
+  /*!
+   * \brief Returns the center frequency of a notch [Hz].
+   */
+  double getFrequency(const size_t index) const;
+
+private:
+  double              sample_rate_;
+  std::vector<double> frequencies_;
+  std::vector<double> bandwidths_;
+  IirSosFilter        filter_;
+
+  // designs the coefficients of a single notch
+  static Eigen::Matrix<double, 1, 5> designNotch(const double& sample_rate, const double& frequency, const double& bandwidth);
+  // returns true if the parameters of a notch are valid
+  bool checkNotch(const double& frequency, const double& bandwidth) const;
+};
+
 }  // namespace mrs_lib
 
 #endif
@@ -8,10 +8,15 @@
 #include <ros/ros.h>
 #include <mrs_msgs/ProfilerUpdate.h>
 #include <mutex>
+#include <chrono>
 
 namespace mrs_lib
 {
 
+// aggregates the durations of the routines in the aggregation mode of the Profiler (defined in profiler.cpp)
+class ProfilerAggregator;
+struct ProfilerHistogram;
+
 class Routine {
 
 public:
@@ -19,6 +24,8 @@ public:
           bool profiler_enabled);
   Routine(std::string name, std::string node_name, double expected_rate, double threshold, std::shared_ptr<ros::Publisher> publisher,
           std::shared_ptr<std::mutex> mutex_publisher, bool profiler_enabled, ros::TimerEvent event);
+  Routine(const std::string& name, std::shared_ptr<ProfilerAggregator> aggregator);
+  Routine(const std::string& name, double expected_rate, double threshold, std::shared_ptr<ProfilerAggregator> aggregator, const ros::TimerEvent& event);
   ~Routine();
 
   void end(void);
@@ -41,6 +48,19 @@ private:
 
   // this will be published
   mrs_msgs::ProfilerUpdate msg_out_;
+
+  // in the aggregation mode, the duration is recorded to the histogram of the routine for the thread ending it
+  std::shared_ptr<ProfilerAggregator>   aggregator_;
+  ProfilerHistogram*                    histogram_ = nullptr;
+  std::chrono::steady_clock::time_point aggregated_start_;
+  double                                period_ = 0;
+  bool                                  late_   = false;
+
+  // if tracing is enabled, the routine is recorded as a trace event when it ends
+  const char*                           trace_name_ = nullptr;
+  std::chrono::steady_clock::time_point trace_start_;
+
+  void startTrace(const std::string& name);
 };
 
 class Profiler {
@@ -57,8 +77,15 @@ public:
    * @param nh node handle
    * @param node_name the node name
    * @param profiler_enabled if profiling is enabled
+   * @param summary_rate if positive, the profiler runs in the aggregation mode and publishes the summaries at this rate in Hz
+   *
+   * By default, each routine publishes a mrs_msgs::ProfilerUpdate message on the "profiler" topic when it starts and when it ends.
+   * In the aggregation mode, the routines only record their durations to preallocated per-thread histograms without any locking.
+   * A background thread then publishes a diagnostic_msgs::DiagnosticArray on the "profiler_summary" topic at the \p summary_rate.
+   * It contains one status per routine with the number of runs, the mean, p50, p95, p99 and max durations
+   * and the number of deadline misses (late starts and overruns of the period of periodic routines) since the previous summary.
    */
-  Profiler(ros::NodeHandle& nh, std::string node_name, bool profiler_enabled);
+  Profiler(ros::NodeHandle& nh, std::string node_name, bool profiler_enabled, double summary_rate = 0.0);
 
   /**
    * @brief the copy constructor
@@ -103,6 +130,9 @@ private:
   std::string                     _node_name_;
   bool                            _profiler_enabled_ = false;
 
+  // shared by the copies of the profiler in the aggregation mode
+  std::shared_ptr<ProfilerAggregator> aggregator_;
+
   std::shared_ptr<ros::NodeHandle> nh_;
 
   bool is_initialized_ = false;
@@ -5,6 +5,7 @@
 #include <boost/circular_buffer.hpp>
 #include <std_msgs/Time.h>
 #include <functional>
+#include <limits>
 #include <ros/ros.h>
 #include <mrs_lib/utils.h>
 
@@ -22,8 +23,11 @@ namespace mrs_lib
    *
    * To accomodate this, the Repredictor keeps a buffer of N last inputs and measurements (N is specified
    * in the constructor). This buffer is then used to re-predict the desired state to a specific time, as
-   * requested by the user. Note that the re-prediction is evaluated in a lazy manner only when the user requests it,
-   * so it goes through the whole history buffer every time a prediction is requested.
+   * requested by the user. Note that the re-prediction is evaluated in a lazy manner only when the user requests it.
+   * To avoid going through the whole history buffer every time a prediction is requested, each element of the buffer caches
+   * the posterior state and covariance estimate at its time stamp. The cache is only invalidated from the oldest element
+   * modified since the last prediction (eg. by an out-of-order measurement), so a prediction after an in-order update
+   * only costs the new predict/correct steps.
    *
    * The Repredictor utilizes a fusion Model (specified as the template parameter), which should implement
    * the predict() and correct() methods. This Model is used for fusing the system inputs and measurements
@@ -50,6 +54,18 @@ namespace mrs_lib
     using statecov_t = typename Model::statecov_t;    /*!< \brief Helper struct for passing around the state and its covariance in one variable */
     using ModelPtr = typename std::shared_ptr<Model>; /*!< \brief Shorthand type for a shared pointer-to-Model */
 
+    /*!
+     * \brief Helper struct for passing multiple measurements at once to the addMeasurements() method.
+     */
+    struct measurement_t
+    {
+      z_t z;                     /*!< \brief The measurement vector. */
+      R_t R;                     /*!< \brief The measurement noise covariance matrix, corresponding to the measurement vector. */
+      ros::Time stamp;           /*!< \brief Time stamp of the measurement vector and covariance matrix. */
+      ModelPtr model = nullptr;  /*!< \brief Optional pointer to a specific Model to be used with this measurement (nullptr means the default one). */
+      int meas_id = -1;          /*!< \brief Optional ID of the measurement. */
+    };
+
     //}
 
     /* predictTo() method //{ */
@@ -67,38 +83,16 @@ namespace mrs_lib
     std::enable_if_t<!check, statecov_t> predictTo(const ros::Time& to_stamp)
     {
       assert(!m_history.empty());
-      auto hist_it = std::begin(m_history);
-      if (hist_it->is_measurement)
-      {
-        // if the first history point is measurement, don't use it for correction (to prevent it from being used twice)
-        hist_it->is_measurement = false;
-      }
-      // cur_stamp corresponds to the time point of cur_sc estimation
-      auto cur_stamp = hist_it->stamp;
-      // cur_sc is the current state and covariance estimate
-      auto cur_sc = m_sc;
-      do
-      {
-        cur_sc.stamp = hist_it->stamp;
-        // do the correction if current history point is a measurement
-        if ((hist_it->is_measurement))
-          cur_sc = correctFrom(cur_sc, *hist_it);
-
-        // decide whether to predict to the next history point or straight to the desired stamp already
-        // (whichever comes sooner or directly to the desired stamp if no further history point is available)
-        ros::Time next_stamp = to_stamp;
-        if ((hist_it + 1) != std::end(m_history) && (hist_it + 1)->stamp <= to_stamp)
-          next_stamp = (hist_it + 1)->stamp;
-
-        // do the prediction
-        cur_sc = predictFrom(cur_sc, *hist_it, cur_stamp, next_stamp);
-        cur_stamp = next_stamp;
-
-        // increment the history pointer
-        hist_it++;
-      } while (hist_it != std::end(m_history) && hist_it->stamp <= to_stamp);
-      cur_sc.stamp = to_stamp;
-      return cur_sc;
+      // find the last history point, which is not newer than the desired stamp (or the first one to avoid out of bounds)
+      const auto next_it = std::upper_bound(std::begin(m_history), std::end(m_history), to_stamp, &Repredictor<Model>::earlier);
+      const size_t last_idx = next_it == std::begin(m_history) ? 0 : (next_it - std::begin(m_history)) - 1;
+      // make sure that the cached posteriors are valid up to the last history point
+      updateCache(last_idx);
+      // predict from the cached posterior of the last history point directly to the desired stamp
+      const auto& info = m_history.at(last_idx);
+      auto sc = predictFrom(info.sc, info, info.stamp, to_stamp);
+      sc.stamp = to_stamp;
+      return sc;
     }
 
     /*!
@@ -140,7 +134,7 @@ namespace mrs_lib
     template<bool check=disable_reprediction>
     std::enable_if_t<!check> addInputChangeWithNoise(const u_t& u, const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
     {
-      const info_t info(stamp, u, Q, model);
+      const info_t info(stamp, u, Q, modelIndex(model));
       // find the next point in the history buffer
       const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), info, &Repredictor<Model>::earlier);
       // add the point to the history buffer
@@ -171,7 +165,7 @@ namespace mrs_lib
       m_history.front().u = u;
       m_history.front().Q = Q;
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
+      m_history.front().predict_model = modelIndex(model);
     }
     //}
 
@@ -196,7 +190,7 @@ namespace mrs_lib
       // get the previous history point (or the first one to avoid out of bounds)
       const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
       // initialize a new history info point
-      const info_t info(stamp, u, prev_it->Q, model);
+      const info_t info(stamp, u, prev_it->Q, modelIndex(model));
       // add the point to the history buffer
       const auto added = addInfo(info, next_it);
       // update all measurements following the newly added system input up to the next system input
@@ -223,7 +217,7 @@ namespace mrs_lib
         m_history.push_back({stamp});
       m_history.front().u = u;
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
+      m_history.front().predict_model = modelIndex(model);
     }
     //}
 
@@ -248,7 +242,7 @@ namespace mrs_lib
       // get the previous history point (or the first one to avoid out of bounds)
       const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
       // initialize a new history info point
-      const info_t info(stamp, prev_it->u, Q, model);
+      const info_t info(stamp, prev_it->u, Q, modelIndex(model));
       // add the point to the history buffer
       const auto added = addInfo(info, next_it);
       // update all measurements following the newly added system input up to the next system input
@@ -275,7 +269,7 @@ namespace mrs_lib
         m_history.push_back({stamp});
       m_history.front().Q = Q;
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
+      m_history.front().predict_model = modelIndex(model);
     }
     //}
 
@@ -301,7 +295,7 @@ namespace mrs_lib
       // get the previous history point (or the first one to avoid out of bounds)
       const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
       // initialize a new history info point
-      const info_t info(stamp, z, R, model, *prev_it, meas_id);
+      const info_t info(stamp, z, R, modelIndex(model), *prev_it, meas_id);
       // add the point to the history buffer
       addInfo(info, next_it);
     }
@@ -331,11 +325,163 @@ namespace mrs_lib
       info.stamp = to_stamp;
       info.is_measurement = true;
       info.meas_id = meas_id;
-      info.correct_model = model;
+      info.correct_model = modelIndex(model);
       m_sc = correctFrom(sc, info);
     }
     //}
 
+    /* addMeasurements() method //{ */
+    /*!
+     * \brief Adds multiple measurements to the history buffer at once, removing the oldest elements in the buffer if it is full.
+     *
+     * The measurements are sorted by their time stamps and merged into the history buffer in a single pass,
+     * so the cost of adding a burst of (possibly delayed and out-of-order) measurements is similar to adding a single
+     * one instead of scaling with their number. Only a single reprediction from the oldest added measurement will be
+     * done on the next call to predictTo().
+     *
+     * \param begin  Iterator pointing to the first measurement to be added (the value type has to be measurement_t).
+     * \param end    Iterator pointing one past the last measurement to be added.
+     *
+     * \note Measurements older than the oldest element in the history buffer will not be added.
+     *
+     */
+    template<typename Iterator, bool check=disable_reprediction>
+    std::enable_if_t<!check> addMeasurements(const Iterator begin, const Iterator end)
+    {
+      assert(!m_history.empty());
+      // prepare the new history points, sorted by their time stamps
+      m_batch.clear();
+      for (auto it = begin; it != end; it++)
+      {
+        const measurement_t& meas = *it;
+        // check if the new element would be added before the first element of the history buffer and ignore it if so
+        if (meas.stamp <= m_history.front().stamp)
+        {
+          ROS_WARN_STREAM_THROTTLE(1.0, "[Repredictor]: Added history point is older than the oldest by "
+                                            << (m_history.front().stamp - meas.stamp).toSec()
+                                            << "s. Ignoring it! Consider increasing the history buffer size (currently: " << m_history.size() << ")");
+          continue;
+        }
+        m_batch.emplace_back(meas.stamp, meas.z, meas.R, modelIndex(meas.model), m_history.front(), meas.meas_id);
+      }
+      if (m_batch.empty())
+        return;
+      std::stable_sort(std::begin(m_batch), std::end(m_batch), &Repredictor<Model>::earlier);
+
+      // find the first point in the history buffer that will be affected
+      const auto first_it = std::lower_bound(std::begin(m_history), std::end(m_history), m_batch.front(), &Repredictor<Model>::earlier);
+      const size_t first_idx = first_it - std::begin(m_history);
+      // move the affected part of the history buffer out of it so that it can be merged with the new points
+      m_merged.assign(first_it, std::end(m_history));
+      m_history.erase_end(m_history.size() - first_idx);
+      m_dirty_idx = std::min(m_dirty_idx, first_idx);
+
+      // merge the two sorted sequences back to the history buffer
+      auto hist_it = std::begin(m_merged);
+      auto batch_it = std::begin(m_batch);
+      while (hist_it != std::end(m_merged) || batch_it != std::end(m_batch))
+      {
+        // new points go before the old ones with the same stamp (same as with addMeasurement())
+        if (batch_it != std::end(m_batch) && (hist_it == std::end(m_merged) || !earlier(*hist_it, *batch_it)))
+        {
+          // the measurement uses the system input-related information of the previous history point
+          batch_it->updateUsing(m_history.back());
+          pushBackInfo(*batch_it);
+          batch_it++;
+        } else
+        {
+          pushBackInfo(*hist_it);
+          hist_it++;
+        }
+      }
+      m_merged.clear();
+      m_batch.clear();
+    }
+
+    /*!
+     * \brief Adds multiple measurements to the history buffer at once, removing the oldest elements in the buffer if it is full.
+     *
+     * \param begin  Iterator pointing to the first measurement to be added (the value type has to be measurement_t).
+     * \param end    Iterator pointing one past the last measurement to be added.
+     *
+     * \note This is the variant of the method when reprediction is disabled and will function like a dumb LKF.
+     *
+     */
+    template<typename Iterator, bool check=disable_reprediction>
+    std::enable_if_t<check> addMeasurements(const Iterator begin, const Iterator end)
+    {
+      std::vector<measurement_t> sorted(begin, end);
+      std::stable_sort(std::begin(sorted), std::end(sorted), [](const measurement_t& a, const measurement_t& b) { return a.stamp < b.stamp; });
+      for (const auto& meas : sorted)
+        addMeasurement(meas.z, meas.R, meas.stamp, meas.model, meas.meas_id);
+    }
+
+    /*!
+     * \brief Adds multiple measurements to the history buffer at once, removing the oldest elements in the buffer if it is full.
+     *
+     * Convenience overload of the method for a whole container of measurements.
+     *
+     * \param measurements  The measurements to be added (the value type of the container has to be measurement_t).
+     *
+     */
+    template<typename Container>
+    void addMeasurements(const Container& measurements)
+    {
+      addMeasurements(std::begin(measurements), std::end(measurements));
+    }
+    //}
+
+    /* smooth() method //{ */
+    /*!
+     * \brief Estimates the smoothed system states and covariance matrices at the time stamps of the history buffer elements.
+     *
+     * Runs a single backward Rauch-Tung-Striebel (RTS) pass over the history buffer, starting from the newest element,
+     * using the cached forward (filtered) posteriors. The history buffer thus acts as a fixed-lag smoother with a lag
+     * corresponding to its length. The state transition Jacobian, which is needed for the RTS gain, is obtained from
+     * the Model's predict() method using finite differences (which is exact for linear models, such as the LKF).
+     *
+     * \param from_stamp  Only the smoothed estimates for history elements with this or a newer stamp are returned (and computed).
+     * \return            The smoothed states and covariance matrices for the history elements, ordered from the oldest to the newest one.
+     *
+     */
+    template<bool check=disable_reprediction>
+    std::enable_if_t<!check, std::vector<statecov_t>> smooth(const ros::Time& from_stamp = ros::Time(0))
+    {
+      assert(!m_history.empty());
+      // make sure that all the forward posteriors are valid
+      updateCache(m_history.size() - 1);
+      // find the oldest element to be smoothed
+      const auto from_it = std::lower_bound(std::begin(m_history), std::end(m_history), from_stamp, &Repredictor<Model>::earlier);
+      const size_t from_idx = from_it - std::begin(m_history);
+
+      std::vector<statecov_t> ret(m_history.size() - from_idx);
+      if (ret.empty())
+        return ret;
+      // the newest smoothed estimate is equal to the filtered one
+      ret.back() = m_history.back().sc;
+      for (size_t it = m_history.size() - 1; it > from_idx; it--)
+      {
+        const auto& info = m_history.at(it - 1);
+        const auto& next_info = m_history.at(it);
+        const statecov_t& filt = info.sc;
+        const statecov_t& next_smooth = ret.at(it - from_idx);
+
+        // the predicted (prior) estimate at the next element and the corresponding state transition Jacobian
+        const auto dt = (next_info.stamp - info.stamp).toSec();
+        P_t A;
+        const statecov_t pred = predictWithJacobian(filt, info, dt, A);
+
+        // the RTS gain C = P_filt * A^T * P_pred^-1 (P_pred is symmetric, so C^T = P_pred^-1 * A * P_filt)
+        const P_t C = pred.P.ldlt().solve(A * filt.P).transpose();
+        statecov_t& smooth = ret.at(it - 1 - from_idx);
+        smooth.x = filt.x + C * (next_smooth.x - pred.x);
+        smooth.P = filt.P + C * (next_smooth.P - pred.P) * C.transpose();
+        smooth.stamp = info.stamp;
+      }
+      return ret;
+    }
+    //}
+
   public:
     /* constructor //{ */
 
@@ -353,7 +499,7 @@ namespace mrs_lib
      * \param hist_len       Length of the history buffer for system inputs and measurements.
      */
     Repredictor(const x_t& x0, const P_t& P0, const u_t& u0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model, const unsigned hist_len)
-        : m_sc{x0, P0}, m_default_model(model), m_history(history_t(hist_len))
+        : m_sc{x0, P0}, m_default_model(model), m_history(history_t(hist_len)), m_dirty_idx(0)
     {
       assert(hist_len > 0);
       addInputChangeWithNoise(u0, Q0, t0, model);
@@ -363,7 +509,7 @@ namespace mrs_lib
      * \brief Empty constructor.
      *
      */
-    Repredictor(){};
+    Repredictor() : m_dirty_idx(0){};
 
     /*!
      * \brief Variation of the constructor for cases without a system input.
@@ -379,7 +525,7 @@ namespace mrs_lib
      * \param hist_len       Length of the history buffer for system inputs and measurements.
      */
     Repredictor(const x_t& x0, const P_t& P0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model, const unsigned hist_len)
-        : m_sc{x0, P0}, m_default_model(model), m_history(history_t(hist_len))
+        : m_sc{x0, P0}, m_default_model(model), m_history(history_t(hist_len)), m_dirty_idx(0)
     {
       assert(hist_len > 0);
       const u_t u0{0};
@@ -396,6 +542,9 @@ namespace mrs_lib
   private:
     /* helper structs and usings //{ */
 
+    // index of a model in the registry of models (0 corresponds to the default model)
+    using model_idx_t = uint16_t;
+
     struct info_t
     {
       ros::Time stamp;
@@ -403,24 +552,27 @@ namespace mrs_lib
       // system input-related information
       u_t u;
       Q_t Q;
-      ModelPtr predict_model;
+      model_idx_t predict_model = 0;
 
       // measurement-related information (unused in case is_measurement=false)
       z_t z;
       R_t R;
-      ModelPtr correct_model;
+      model_idx_t correct_model = 0;
       bool is_measurement;
       int meas_id;
 
+      // cached posterior state and covariance at this stamp (only valid for elements before m_dirty_idx)
+      statecov_t sc;
+
       // constructor for a dummy info (for searching in the history)
       info_t(const ros::Time& stamp) : stamp(stamp), is_measurement(false){};
 
       // constructor for a system input
-      info_t(const ros::Time& stamp, const u_t& u, const Q_t& Q, const ModelPtr& model)
+      info_t(const ros::Time& stamp, const u_t& u, const Q_t& Q, const model_idx_t model)
           : stamp(stamp), u(u), Q(Q), predict_model(model), is_measurement(false){};
 
       // constructor for a measurement
-      info_t(const ros::Time& stamp, const z_t& z, const R_t& R, const ModelPtr& model, const info_t& prev_info, const int& meas_id)
+      info_t(const ros::Time& stamp, const z_t& z, const R_t& R, const model_idx_t model, const info_t& prev_info, const int& meas_id)
           : stamp(stamp), z(z), R(R), correct_model(model), is_measurement(true), meas_id(meas_id)
       {
         updateUsing(prev_info);
@@ -442,6 +594,15 @@ namespace mrs_lib
     using history_t = boost::circular_buffer<info_t>;
     // the history buffer
     history_t m_history;
+    // index of the first history element with an invalid cached posterior
+    size_t m_dirty_idx;
+    // registry of the non-default models used by the history elements (the history only stores their indices to avoid copying of the shared pointers)
+    std::vector<ModelPtr> m_models;
+    // size of the registry at which unused models are removed from it
+    size_t m_models_gc_size = 16;
+    // helper buffers for merging multiple measurements into the history (kept to avoid reallocations)
+    std::vector<info_t> m_batch;
+    std::vector<info_t> m_merged;
 
     // | ---------------- helper debugging methods ---------------- |
     /* checkMonotonicity() method //{ */
@@ -488,24 +649,36 @@ namespace mrs_lib
       }
 
       // check if adding a new element would throw out the oldest one
-      if (m_history.size() == m_history.capacity())
-      {  // if so, first update m_sc
-        // figure out, what will be the oldest element in the buffer after inserting the newly received one
-        auto new_oldest = m_history.front();
-        if (m_history.size() == 1 || (m_history.size() > 1 && info.stamp > m_history.at(0).stamp && info.stamp < m_history.at(1).stamp))
+      const bool evicting = m_history.size() == m_history.capacity();
+      // whether the new element will become the oldest one in the buffer after inserting it
+      const bool new_is_oldest = evicting && (m_history.size() == 1 || (info.stamp > m_history.at(0).stamp && info.stamp < m_history.at(1).stamp));
+      if (evicting)
+      {  // if so, first update m_sc to the time of the new oldest element (after inserting the new element)
+        if (new_is_oldest)
         {
-          new_oldest = info;
-        } else if (m_history.size() > 1)
+          m_sc = predictTo(info.stamp);
+        } else
         {
-          new_oldest = m_history.at(1);
+          // the second element will become the oldest one, so just use its cached posterior
+          updateCache(1);
+          m_sc = m_history.at(1).sc;
         }
-        // update m_sc to the time of the new oldest element (after inserting the new element)
-        m_sc = predictTo(new_oldest.stamp);
-        // insert the new element into the history buffer, causing the original oldest element to be removed
       }
 
-      // add the new point finally
+      // add the new point finally (if the buffer is full, this removes the original oldest element)
       const auto ret = m_history.insert(next_it, info);
+      const size_t ret_idx = ret - std::begin(m_history);
+      // invalidate the cached posteriors from the new element onwards (indices are shifted by one if an element was removed)
+      if (evicting)
+        m_dirty_idx = std::min(m_dirty_idx - 1, ret_idx);
+      else
+        m_dirty_idx = std::min(m_dirty_idx, ret_idx);
+      // the oldest element corresponds to m_sc
+      if (new_is_oldest)
+      {
+        m_history.front().sc = m_sc;
+        m_dirty_idx = 1;
+      }
       /* debug check //{ */
 
 #ifdef REPREDICTOR_DEBUG
@@ -521,6 +694,127 @@ namespace mrs_lib
     }
     //}
 
+    /* pushBackInfo() method //{ */
+    // adds a new element to the end of the history buffer, removing the oldest one if it is full
+    void pushBackInfo(const info_t& info)
+    {
+      // check if adding a new element would throw out the oldest one
+      if (m_history.full())
+      {
+        // if so, first update m_sc to the time of the new oldest element (after inserting the new element)
+        if (m_history.size() == 1)
+        {
+          m_sc = predictTo(info.stamp);
+          m_history.push_back(info);
+          m_history.front().sc = m_sc;
+          m_dirty_idx = 1;
+          return;
+        }
+        updateCache(1);
+        m_sc = m_history.at(1).sc;
+        m_history.push_back(info);
+        m_dirty_idx--;
+        return;
+      }
+      m_history.push_back(info);
+    }
+    //}
+
+    /* updateCache() method //{ */
+    // makes sure that the cached posteriors are valid for all history elements up to (including) the one at up_to_idx
+    void updateCache(const size_t up_to_idx)
+    {
+      // the oldest element always corresponds to m_sc (its measurement, if any, is already included)
+      if (m_dirty_idx == 0)
+      {
+        m_history.front().sc = m_sc;
+        m_history.front().sc.stamp = m_history.front().stamp;
+        m_dirty_idx = 1;
+      }
+
+      for (size_t it = m_dirty_idx; it <= up_to_idx && it < m_history.size(); it++)
+      {
+        const auto& prev_info = m_history.at(it - 1);
+        auto& info = m_history.at(it);
+        // predict from the previous history point to this one
+        info.sc = predictFrom(prev_info.sc, prev_info, prev_info.stamp, info.stamp);
+        info.sc.stamp = info.stamp;
+        // do the correction if current history point is a measurement
+        if (info.is_measurement)
+        {
+          info.sc = correctFrom(info.sc, info);
+          info.sc.stamp = info.stamp;
+        }
+        m_dirty_idx = it + 1;
+      }
+    }
+    //}
+
+    /* modelIndex() method //{ */
+    // returns index of the model in the registry, adding it if necessary
+    model_idx_t modelIndex(const ModelPtr& model)
+    {
+      // comparing the shared pointers only compares the raw pointers, so no reference counting happens here
+      if (model == nullptr || model == m_default_model)
+        return 0;
+      for (size_t it = 0; it < m_models.size(); it++)
+        if (m_models[it] == model)
+          return it + 1;
+
+      // the model is not registered yet
+      if (m_models.size() >= m_models_gc_size)
+      {
+        removeUnusedModels();
+        m_models_gc_size = std::max(m_models_gc_size, 2 * m_models.size());
+      }
+      if (m_models.size() >= std::numeric_limits<model_idx_t>::max())
+      {
+        ROS_ERROR_STREAM("[Repredictor]: Too many different models used (" << m_models.size() << ")! Using the default model instead.");
+        return 0;
+      }
+      m_models.push_back(model);
+      return m_models.size();
+    }
+    //}
+
+    /* removeUnusedModels() method //{ */
+    // removes models, which are not used by any history element, from the registry and remaps the indices in the history
+    // (the batch of points being added by addMeasurements() is remapped as well, as this may be called while it is being built)
+    void removeUnusedModels()
+    {
+      std::vector<model_idx_t> remap(m_models.size() + 1, 0);
+      const auto mark_used = [&remap](const info_t& info) {
+        remap.at(info.predict_model) = 1;
+        remap.at(info.correct_model) = 1;
+      };
+      std::for_each(std::begin(m_history), std::end(m_history), mark_used);
+      std::for_each(std::begin(m_batch), std::end(m_batch), mark_used);
+      std::vector<ModelPtr> used_models;
+      for (size_t it = 0; it < m_models.size(); it++)
+      {
+        if (remap.at(it + 1))
+        {
+          used_models.push_back(m_models.at(it));
+          remap.at(it + 1) = used_models.size();
+        }
+      }
+      const auto remap_info = [&remap](info_t& info) {
+        info.predict_model = remap.at(info.predict_model);
+        info.correct_model = remap.at(info.correct_model);
+      };
+      std::for_each(std::begin(m_history), std::end(m_history), remap_info);
+      std::for_each(std::begin(m_batch), std::end(m_batch), remap_info);
+      m_models = std::move(used_models);
+    }
+    //}
+
+    /* getModel() method //{ */
+    Model& getModel(const model_idx_t idx)
+    {
+      return idx == 0 ? *m_default_model : *m_models[idx - 1];
+    }
+    //}
+
     /* earlier() method //{ */
     static bool earlier(const info_t& ob1, const info_t& ob2)
     {
@@ -528,12 +822,33 @@ namespace mrs_lib
     }
     //}
 
+    /* predictWithJacobian() method //{ */
+    // predicts the state and covariance by dt using the model of inpt and estimates the Jacobian of the predicted state w.r.t. the original one
+    statecov_t predictWithJacobian(const statecov_t& sc, const info_t& inpt, const double dt, P_t& A)
+    {
+      Model& model = getModel(inpt.predict_model);
+      const statecov_t pred = model.predict(sc, inpt.u, inpt.Q, dt);
+      const auto n = sc.x.size();
+      A = P_t::Zero(n, n);
+      statecov_t perturbed = sc;
+      for (int it = 0; it < n; it++)
+      {
+        const double step = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(1.0, std::abs(sc.x(it)));
+        perturbed.x(it) = sc.x(it) + step;
+        A.col(it) = (model.predict(perturbed, inpt.u, inpt.Q, dt).x - pred.x) / step;
+        perturbed.x(it) = sc.x(it);
+      }
+      return pred;
+    }
+    //}
+
+  protected:
     /* predictFrom() method //{ */
     statecov_t predictFrom(const statecov_t& sc, const info_t& inpt, const ros::Time& from_stamp, const ros::Time& to_stamp)
     {
-      const auto model = inpt.predict_model == nullptr ? m_default_model : inpt.predict_model;
+      Model& model = getModel(inpt.predict_model);
       const auto dt = (to_stamp - from_stamp).toSec();
-      return model->predict(sc, inpt.u, inpt.Q, dt);
+      return model.predict(sc, inpt.u, inpt.Q, dt);
     }
     //}
 
@@ -541,9 +856,9 @@ namespace mrs_lib
     statecov_t correctFrom(const statecov_t& sc, const info_t& meas)
     {
       assert(meas.is_measurement);
-      const auto model = meas.correct_model == nullptr ? m_default_model : meas.correct_model;
+      Model& model = getModel(meas.correct_model);
       auto sc_tmp = sc;
-      return model->correct(sc_tmp, meas.z, meas.R);
+      return model.correct(sc_tmp, meas.z, meas.R);
     }
     //}
   };
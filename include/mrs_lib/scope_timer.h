@@ -11,6 +11,11 @@
 #include <fstream>
 #include <iomanip>
 #include <mutex>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
 /* #include <ctime> */
 
 namespace mrs_lib
@@ -20,14 +25,23 @@ namespace mrs_lib
 
 /**
  * @brief Simple file logger of scope timer and its checkpoints
+ *
+ * By default, each logged time is written to the logger file as a CSV line from the thread which logs it.
+ * In the binary mode, the times are instead written as fixed-size records to a lock-free ring buffer of the logging thread
+ * and the labels are interned to integer IDs. A background thread periodically drains the ring buffers of all threads
+ * and appends their records to the logger file in large blocks. The binary log may be converted to the CSV format
+ * using the convertToCsv() method (or the scope_timer_log_converter executable). Records of different threads may be
+ * ordered differently than in a CSV log. If a ring buffer is full, its new records are dropped (the timed thread never blocks).
  */
 class ScopeTimerLogger {
 
 public:
   /**
    * @brief The basic constructor with a user-defined path to the logger file, enable flag and float-logging precision
+   *
+   * @param binary if true, the binary mode is used (the \p log_precision is then ignored, see convertToCsv())
    */
-  ScopeTimerLogger(const std::string& logfile, const bool enable_logging = true, const int log_precision = 10);
+  ScopeTimerLogger(const std::string& logfile, const bool enable_logging = true, const int log_precision = 10, const bool binary = false);
 
   /**
    * @brief The basic destructor which closes the logging file
@@ -68,12 +82,77 @@ public:
    */
   void log(const std::string& scope, const std::string& label_from, const std::string& label_to, const chrono_tp& time_start, const chrono_tp& time_end);
 
+  /**
+   * @brief Returns the integer ID of a label for the log() method (the same label always gets the same ID).
+   */
+  uint32_t internLabel(const std::string& label);
+
+  /**
+   * @brief Returns the integer ID of a label (the same label always gets the same ID).
+   *
+   * The IDs are cached by the address of the label, so a label stored at the same address (e.g. a string literal) is only compared
+   * with the cached text instead of being hashed again when used repeatedly from the same thread.
+   */
+  uint32_t internLabel(const char* label);
+
+  /**
+   * @brief Writes the time data of the given scope and checkpoint labels, which were interned using internLabel(), into the logger stream.
+   */
+  void log(const uint32_t scope, const uint32_t label_from, const uint32_t label_to, const chrono_tp& time_start, const chrono_tp& time_end);
+
+  /**
+   * @brief Converts a binary log to the CSV format, which is written by the logger in the default mode.
+   *
+   * @param binary_logfile path to the binary log.
+   * @param csv_logfile    path to the converted CSV log.
+   * @param log_precision  float-logging precision of the CSV log.
+   *
+   * @return true if the whole binary log was successfully converted.
+   */
+  static bool convertToCsv(const std::string& binary_logfile, const std::string& csv_logfile, const int log_precision = 10);
+
 private:
   bool          _logging_enabled_ = false;
   bool          _should_log_      = false;
+  bool          _binary_          = false;
   std::string   _log_filepath_;
   std::ofstream _logstream_;
   std::mutex    _mutex_logstream_;
+
+  // | ----------------------- binary mode ---------------------- |
+
+  struct record_t;
+  struct ring_t;
+  struct thread_cache_t;
+
+  // distinguishes the loggers in the per-thread caches of the labels and ring buffers (the caches of the destroyed
+  // loggers are dropped when a thread first uses another logger)
+  static std::atomic<uint64_t> last_id_;
+  const uint64_t               id_;
+
+  std::mutex                                _mutex_labels_;
+  std::unordered_map<std::string, uint32_t> label_ids_;
+  std::vector<std::string>                  labels_;
+
+  std::mutex                           _mutex_rings_;
+  std::vector<std::unique_ptr<ring_t>> rings_;
+
+  int                     log_fd_ = -1;
+  std::thread             writer_thread_;
+  std::mutex              _mutex_writer_;
+  std::condition_variable writer_cv_;
+  bool                    writer_stop_ = false;
+
+  // used only by the writer thread
+  std::vector<char> label_buffer_;
+  std::vector<char> record_buffer_;
+  size_t            n_labels_written_ = 0;
+  uint64_t          n_dropped_        = 0;
+
+  thread_cache_t& threadCache();
+  void            writerThread();
+  // drains the ring buffers and appends their records and the new labels to the file
+  void writeRecords();
 };
 
 /*//}*/
@@ -145,18 +224,102 @@ public:
 
   /**
    * @brief The basic destructor which prints out or logs the scope times, if enabled.
+   *
+   * The scope and its checkpoints are traced by the Tracer even if the timer is disabled, if tracing was enabled when it was created.
    */
   ~ScopeTimer();
 
 private:
   std::string             _timer_label_;
   bool                    _enable_print_or_log;
+  bool                    _trace_ = false;
   ros::Duration           _throttle_period_;
   std::vector<time_point> checkpoints;
 
   std::shared_ptr<ScopeTimerLogger> _logger_ = nullptr;
 
   static std::unordered_map<std::string, ros::Time> last_print_times;
+  static std::mutex                                 mutex_last_print_times;
+};
+
+/**
+ * @brief A low-overhead variant of the ScopeTimer with a fixed maximal number of checkpoints.
+ *
+ * The labels of the timer and its checkpoints are not copied, only their addresses are stored, so they have to stay valid
+ * during the lifetime of the timer. Use string literals or labels returned by the intern() method (e.g. for labels composed at runtime).
+ * The checkpoints are kept in an inline array and only the steady clock is read, so no memory is allocated and no ROS time
+ * is read until the timer is destroyed. Checkpoints above the \ref max_checkpoints are ignored (and reported when printing).
+ * The printing is throttled using a thread-safe table shared by all timers with the same label.
+ */
+class FastScopeTimer {
+public:
+  //! the maximal number of checkpoints including the start of the timer
+  static constexpr size_t max_checkpoints = 32;
+
+  /**
+   * @brief The basic constructor with a user-defined label of the timer, throttled period and file logger.
+   */
+  FastScopeTimer(const char* label, const ros::Duration& throttle_period = ros::Duration(0), const bool enable = true,
+                 const std::shared_ptr<ScopeTimerLogger> scope_timer_logger = nullptr);
+
+  /**
+   * @brief The basic constructor with a user-defined label of the timer and file logger.
+   */
+  FastScopeTimer(const char* label, const std::shared_ptr<ScopeTimerLogger> scope_timer_logger, const bool enable = true);
+
+  /**
+   * @brief Returns a label with the same text, which stays valid until the end of the program.
+   *
+   * The same pointer is returned for the same text, so it may be obtained once and then used repeatedly.
+   */
+  static const char* intern(const std::string& label);
+
+  /**
+   * @brief Checkpoint, stores the time passed until the point this function is called.
+   */
+  void checkpoint(const char* label) {
+    if (!_enable_print_or_log_ && !_trace_) {
+      return;
+    }
+    if (n_checkpoints_ < max_checkpoints) {
+      checkpoints_[n_checkpoints_++] = {label, std::chrono::steady_clock::now()};
+    } else {
+      n_ignored_++;
+    }
+  }
+
+  /**
+   * @brief Getter for scope timer lifetime
+   *
+   * @return lifetime as floating point milliseconds
+   */
+  float getLifetime();
+
+  /**
+   * @brief The basic destructor which prints out or logs the scope times, if enabled.
+   *
+   * The scope and its checkpoints are traced by the Tracer even if the timer is disabled, if tracing was enabled when it was created.
+   */
+  ~FastScopeTimer();
+
+  FastScopeTimer(const FastScopeTimer&) = delete;
+  FastScopeTimer& operator=(const FastScopeTimer&) = delete;
+
+private:
+  struct checkpoint_t
+  {
+    const char*                                        label;
+    std::chrono::time_point<std::chrono::steady_clock> time;
+  };
+
+  const char*                               _timer_label_;
+  bool                                      _enable_print_or_log_;
+  bool                                      _trace_ = false;
+  std::chrono::steady_clock::duration       _throttle_period_;
+  std::shared_ptr<ScopeTimerLogger>         _logger_;
+  std::array<checkpoint_t, max_checkpoints> checkpoints_;
+  size_t                                    n_checkpoints_ = 0;
+  size_t                                    n_ignored_     = 0;
 };
 
 }  // namespace mrs_lib
@@ -0,0 +1,259 @@
+// clang: MatousFormat
+#ifndef SRUKF_H
+#define SRUKF_H
+
+/**  \file
+     \brief Defines SRUKF - a class implementing the Square-Root Unscented Kalman Filter \cite UKF.
+ */
+
+#include <mrs_lib/kalman_filter.h>
+
+namespace mrs_lib
+{
+
+  /**
+  * \brief Implementation of the Square-Root Unscented Kalman filter \cite UKF.
+  *
+  * This is a variant of the \ref UKF, which propagates the lower-triangular Cholesky factor \f$ \mathbf{S} \f$ of the state
+  * covariance (so that \f$ \mathbf{P} = \mathbf{S}\mathbf{S}^\intercal \f$) instead of the covariance itself. The factor
+  * is updated directly in the prediction and correction steps using QR decompositions and rank-1 Cholesky updates, so the
+  * sigma points are obtained without a full Cholesky decomposition of the covariance in each step. This is also numerically
+  * more robust, because the covariance represented by the factor is positive semi-definite by construction.
+  *
+  * To fully benefit from the square-root form, use the predict() and correct() overloads working with the sqrt_statecov_t,
+  * which keeps the Cholesky factor between the steps. The overloads working with the standard statecov_t have the same
+  * semantics as those of the \ref UKF, but they have to factorize the covariance once on the input, so they are mainly
+  * useful as a drop-in replacement (e.g. in the Repredictor).
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements>
+  class SRUKF : public KalmanFilter<n_states, n_inputs, n_measurements>
+  {
+    static_assert(n_states > 0 && n_measurements > 0, "SRUKF only supports fixed-size states and measurements!");
+
+  protected:
+    /* protected SRUKF definitions (typedefs, constants etc) //{ */
+    static constexpr int n = n_states;            /*!< \brief Length of the state vector of the system. */
+    static constexpr int m = n_inputs;            /*!< \brief Length of the input vector of the system. */
+    static constexpr int p = n_measurements;      /*!< \brief Length of the measurement vector of the system. */
+    static constexpr int w = 2 * n + 1;           /*!< \brief Number of sigma points/weights. */
+
+    using Base_class = KalmanFilter<n, m, p>; /*!< \brief Base class of this class. */
+
+    using X_t = typename Eigen::Matrix<double, n, w>;    /*!< \brief State sigma points matrix. */
+    using Z_t = typename Eigen::Matrix<double, p, w>;    /*!< \brief Measurement sigma points matrix. */
+    using Pzz_t = typename Eigen::Matrix<double, p, p>;  /*!< \brief Pzz helper matrix. */
+    using K_t = typename Eigen::Matrix<double, n, p>;    /*!< \brief Kalman gain matrix. */
+    using XQ_t = typename Eigen::Matrix<double, n, 3 * n>;  /*!< \brief Weighted state sigma point deviations with the process noise factor. */
+    using ZR_t = typename Eigen::Matrix<double, p, 2 * n + p>;  /*!< \brief Weighted measurement sigma point deviations with the measurement noise factor. */
+    //}
+
+  public:
+    /* public SRUKF definitions (typedefs, constants etc) //{ */
+    //! state vector n*1 typedef
+    using x_t = typename Base_class::x_t;
+    //! input vector m*1 typedef
+    using u_t = typename Base_class::u_t;
+    //! measurement vector p*1 typedef
+    using z_t = typename Base_class::z_t;
+    //! state covariance n*n typedef
+    using P_t = typename Base_class::P_t;
+    //! measurement covariance p*p typedef
+    using R_t = typename Base_class::R_t;
+    //! process covariance n*n typedef
+    using Q_t = typename Base_class::Q_t;
+    //! weights vector (2n+1)*1 typedef
+    using W_t = typename Eigen::Matrix<double, w, 1>;
+    //! typedef of a helper struct for state and covariance
+    using statecov_t = typename Base_class::statecov_t;
+    //! function of the state transition model typedef
+    using transition_model_t = typename std::function<x_t(const x_t&, const u_t&, double)>;
+    //! function of the observation model typedef
+    using observation_model_t = typename std::function<z_t(const x_t&)>;
+
+    //! helper struct for passing around the state and the Cholesky factor of its covariance in one variable
+    struct sqrt_statecov_t
+    {
+      x_t x;  /*!< \brief State vector. */
+      P_t S;  /*!< \brief Lower-triangular Cholesky factor of the state covariance matrix. */
+      ros::Time stamp = ros::Time(0); /*!< \brief ROS time stamp */
+    };
+
+    //! is thrown when the Cholesky factor of a covariance cannot be computed or updated
+    struct square_root_exception : public std::exception
+    {
+      const char* what() const throw()
+      {
+        return "SRUKF: the covariance is not positive definite, its Cholesky factor cannot be computed!!!";
+      }
+    };
+
+    //! is thrown when taking the inverse of a matrix fails during kalman gain calculation
+    struct inverse_exception : public std::exception
+    {
+      const char* what() const throw()
+      {
+        return "SRUKF: inverting of Pzz in correction update produced NANs!!!";
+      }
+    };
+    //}
+
+  public:
+    /* SRUKF constructor //{ */
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * otherwise the SRUKF object is invalid (not initialized).
+    */
+    SRUKF();
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param alpha             Scaling parameter of the sigma generation (a small positive value, e.g. 1e-3).
+    * \param kappa             Secondary scaling parameter of the sigma generation (usually set to 0 or 1).
+    * \param beta              Incorporates prior knowledge about the distribution (for Gaussian distribution, 2 is optimal).
+    * \param transition_model  State transition model function.
+    * \param observation_model Observation model function.
+    */
+    SRUKF(const transition_model_t& transition_model, const observation_model_t& observation_model, const double alpha = 1e-3, const double kappa = 1, const double beta = 2);
+    //}
+
+    /* correct() method //{ */
+  /*!
+    * \brief Implements the state correction step (measurement update).
+    *
+    * The covariance is factorized on the input and the result is converted back to the full covariance.
+    *
+    * \param sc     Previous estimate of the state and covariance.
+    * \param z      Measurement vector.
+    * \param R      Measurement covariance matrix.
+    * \returns      The state and covariance after applying the correction step.
+    */
+    virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override;
+
+  /*!
+    * \brief Implements the state correction step (measurement update) in the square-root form.
+    *
+    * \param sc     Previous estimate of the state and Cholesky factor of the covariance.
+    * \param z      Measurement vector.
+    * \param R      Measurement covariance matrix.
+    * \returns      The state and Cholesky factor of the covariance after applying the correction step.
+    */
+    sqrt_statecov_t correct(const sqrt_statecov_t& sc, const z_t& z, const R_t& R) const;
+    //}
+
+    /* predict() method //{ */
+  /*!
+    * \brief Implements the state prediction step (time update).
+    *
+    * The covariance is factorized on the input and the result is converted back to the full covariance.
+    *
+    * \param sc     Previous estimate of the state and covariance.
+    * \param u      Input vector.
+    * \param Q      Process noise covariance matrix.
+    * \param dt     Duration since the previous estimate.
+    * \returns      The state and covariance after applying the prediction step.
+    */
+    virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override;
+
+  /*!
+    * \brief Implements the state prediction step (time update) in the square-root form.
+    *
+    * \param sc     Previous estimate of the state and Cholesky factor of the covariance.
+    * \param u      Input vector.
+    * \param Q      Process noise covariance matrix.
+    * \param dt     Duration since the previous estimate.
+    * \returns      The state and Cholesky factor of the covariance after applying the prediction step.
+    */
+    sqrt_statecov_t predict(const sqrt_statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const;
+    //}
+
+    /* toSqrtStatecov() and fromSqrtStatecov() methods //{ */
+  /*!
+    * \brief Converts the state and covariance to the state and Cholesky factor of the covariance.
+    *
+    * \param sc     The state and covariance to be converted.
+    * \returns      The state and Cholesky factor of the covariance.
+    *
+    * \throws square_root_exception if the covariance is not positive definite.
+    */
+    static sqrt_statecov_t toSqrtStatecov(const statecov_t& sc);
+
+  /*!
+    * \brief Converts the state and Cholesky factor of the covariance to the state and covariance.
+    *
+    * \param sc     The state and Cholesky factor of the covariance to be converted.
+    * \returns      The state and covariance.
+    */
+    static statecov_t fromSqrtStatecov(const sqrt_statecov_t& sc);
+    //}
+
+    /* setConstants() method //{ */
+  /*!
+    * \brief Changes the Unscented Transform parameters.
+    *
+    * \param alpha  Scaling parameter of the sigma generation (a small positive value - e.g. 1e-3).
+    * \param kappa  Secondary scaling parameter of the sigma generation (usually set to 0 or 1).
+    * \param beta   Incorporates prior knowledge about the distribution (for Gaussian distribution, 2 is optimal).
+    */
+    void setConstants(const double alpha, const double kappa, const double beta);
+    //}
+
+    /* setTransitionModel() method //{ */
+  /*!
+    * \brief Changes the transition model function.
+    *
+    * \param transition_model   the new transition model
+    */
+    void setTransitionModel(const transition_model_t& transition_model);
+    //}
+
+    /* setObservationModel() method //{ */
+  /*!
+    * \brief Changes the observation model function.
+    *
+    * \param observation_model   the new observation model
+    */
+    void setObservationModel(const observation_model_t& observation_model);
+    //}
+
+  protected:
+    /* protected methods and member variables //{ */
+
+    void computeWeights();
+
+    X_t computeSigmas(const x_t& x, const P_t& S) const;
+
+    template <int rows>
+    Eigen::Matrix<double, rows, 1> computeMean(const Eigen::Matrix<double, rows, w>& X) const;
+
+    template <int rows, int cols>
+    static Eigen::Matrix<double, rows, rows> computeQRSqrt(const Eigen::Matrix<double, rows, cols>& A);
+
+    template <int rows>
+    static Eigen::Matrix<double, rows, rows> computeNoiseSqrt(const Eigen::Matrix<double, rows, rows>& Q);
+
+    template <int rows>
+    static bool choleskyUpdate(Eigen::Matrix<double, rows, rows>& L, Eigen::Matrix<double, rows, 1> v, const double weight);
+
+    double m_alpha, m_kappa, m_beta, m_lambda;
+    W_t m_Wm;
+    W_t m_Wc;
+
+    transition_model_t m_transition_model;
+    observation_model_t m_observation_model;
+
+    //}
+  };
+
+}  // namespace mrs_lib
+
+#include <mrs_lib/impl/srukf.hpp>
+
+#endif
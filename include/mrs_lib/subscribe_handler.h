@@ -44,9 +44,15 @@ namespace mrs_lib
     std::function<void(const std::string& topic_name, const ros::Time& last_msg)> timeout_callback = {};  /*!< \brief This function will be called if no new message is received for the \p no_message_timeout duration. If this variable is empty, an error message will be printed to the console. */
   
     bool threadsafe = true;  /*!< \brief If true, all methods of the SubscribeHandler will be mutexed (using a recursive mutex) to avoid data races. */
+
+    bool lockfree = false;  /*!< \brief If true, the latest message and its flags are published through atomics instead of a mutex, so that polling the SubscribeHandler (getMsg(), peekMsg(), hasMsg(), newMsg(), usedMsg() and lastMsgTime()) never waits for the message callback. The SubscribeHandler is thread-safe also in this mode and this option takes precedence over \p threadsafe. */
   
     bool autostart = true;  /*!< \brief If true, the SubscribeHandler will be started after construction. Otherwise it has to be started using the start() method */
   
+    size_t history_length = 0;  /*!< \brief If larger than zero, this number of the last received messages is kept in a preallocated ring buffer, which may be searched using the getMsgAt() and getMsgsInterval() methods. */
+
+    bool history_header_stamp = true;  /*!< \brief If true, the messages in the history are indexed by the stamps in their headers (messages without a header are indexed by the time of their reception). Otherwise, they are indexed by the time of their reception. */
+
     uint32_t queue_size = 3;  /*!< \brief This parameter is passed to the NodeHandle when subscribing to the topic */
   
     ros::TransportHints transport_hints = ros::TransportHints();  /*!< \brief This parameter is passed to the NodeHandle when subscribing to the topic */
@@ -133,6 +139,29 @@ namespace mrs_lib
       */
       virtual bool usedMsg() const {assert(m_pimpl); return m_pimpl->usedMsg();};
 
+    /*!
+      * \brief Returns the message from the history with the stamp closest to the specified time.
+      *
+      * The history has to be enabled by setting \p history_length in the SubscribeHandlerOptions.
+      * The messages are not copied and the flags of newMsg() and usedMsg() are not modified.
+      *
+      * \param stamp the time to which the closest message is searched.
+      * \return the message with the closest stamp or \p nullptr if the history is empty.
+      */
+      virtual typename MessageType::ConstPtr getMsgAt(const ros::Time& stamp) const {assert(m_pimpl); return m_pimpl->getMsgAt(stamp);};
+
+    /*!
+      * \brief Returns all messages from the history with stamps in the specified interval.
+      *
+      * The history has to be enabled by setting \p history_length in the SubscribeHandlerOptions.
+      * The messages are not copied and the flags of newMsg() and usedMsg() are not modified.
+      *
+      * \param from the start of the interval (inclusive).
+      * \param to   the end of the interval (inclusive).
+      * \return the messages with stamps in the interval, sorted from the oldest stamp to the newest.
+      */
+      virtual std::vector<typename MessageType::ConstPtr> getMsgsInterval(const ros::Time& from, const ros::Time& to) const {assert(m_pimpl); return m_pimpl->getMsgsInterval(from, to);};
+
     /*!
       * \brief Blocks until new data becomes available or until the timeout runs out or until a spurious wake-up.
       *
@@ -225,7 +254,15 @@ namespace mrs_lib
             const message_callback_t& message_callback = {}
           )
       {
-        if (options.threadsafe)
+        if (options.lockfree)
+        {
+          m_pimpl = std::make_unique<ImplLockfree>
+            (
+              options,
+              message_callback
+            );
+        }
+        else if (options.threadsafe)
         {
           m_pimpl = std::make_unique<ImplThreadsafe>
             (
@@ -430,6 +467,7 @@ namespace mrs_lib
     private:
       class Impl;
       class ImplThreadsafe;
+      class ImplLockfree;
       std::unique_ptr<Impl> m_pimpl;
   };
   //}
@@ -8,12 +8,28 @@
 #define TIMEOUT_MANAGER_H
 
 #include <ros/ros.h>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <memory>
 
 namespace mrs_lib
 {
   /* TimeoutManager class //{ */
   /**
-  * \brief TODO
+  * \brief Calls the registered callbacks whenever the respective timeouts are not reset in time.
+  *
+  * The timeouts are checked periodically with the rate specified in the constructor. Instead of checking all the
+  * timeouts on every update, each timeout is kept in a hierarchical timer wheel at the update (tick), when it may expire
+  * at the earliest, so that only the timeouts expiring around the current time are checked.
+  *
+  * Resetting a timeout doesn't move it in the wheel - only the time of the reset is atomically stored and the timeout is
+  * moved to a later tick when it is checked. The reset() and lastReset() methods are therefore lock-free and never wait
+  * for the other methods. The callbacks of the expired timeouts are called without any internal mutex locked, so the
+  * methods of the TimeoutManager may be called from within the callbacks.
+  *
+  * \note Resetting a timeout with an earlier time than the last reset doesn't make it expire sooner than it was
+  * already scheduled.
   *
   */
   class TimeoutManager
@@ -54,25 +70,66 @@ namespace mrs_lib
       
       private:
         // | ---------------------- private types --------------------- |
+        // all members except for last_reset_ns are guarded by m_mtx
         struct timeout_info_t
         {
           bool oneshot;
           bool started;
-          callback_t callback;
+          std::shared_ptr<const callback_t> callback;
           ros::Duration timeout;
-          ros::Time last_reset;
+          std::atomic<uint64_t> last_reset_ns;
           ros::Time last_callback;
+          // incremented whenever the timeout is paused or rescheduled to invalidate its older entries in the wheel
+          uint64_t generation;
+        };
+
+        struct wheel_entry_t
+        {
+          timeout_id_t id;
+          uint64_t generation;
+          uint64_t tick;
         };
+
+        // number of slots in each level of the timer wheel (a power of two)
+        static constexpr int wheel_bits = 6;
+        static constexpr uint64_t wheel_size = uint64_t(1) << wheel_bits;
+        static constexpr int wheel_levels = 4;
+        static constexpr uint64_t wheel_ticks = uint64_t(1) << (wheel_bits * wheel_levels);
+        // the timeouts are stored in segments of increasing length, which are never reallocated
+        static constexpr size_t first_segment_size = 64;
+        static constexpr size_t n_segments = 48;
       
       private:
         // | --------------------- private methods -------------------- |
         void main_timer_callback([[maybe_unused]] const ros::TimerEvent& evt);
+
+        timeout_info_t& info(const timeout_id_t id);
+        uint64_t tick(const ros::Time& time) const;
+        void schedule(const timeout_id_t id);
+        void insert(const wheel_entry_t& entry);
+        void process(const wheel_entry_t& entry, const ros::Time& now);
+        void processSlot(std::vector<wheel_entry_t>& slot, const ros::Time& now);
       
       private:
         // | ------------------------- members ------------------------ |
-        std::recursive_mutex m_mtx;
-        timeout_id_t m_last_id;
-        std::vector<timeout_info_t> m_timeouts;
+        std::mutex m_mtx;
+        // number of the registered timeouts
+        std::atomic<timeout_id_t> m_last_id;
+        std::array<std::unique_ptr<timeout_info_t[]>, n_segments> m_segments;
+
+        // the hierarchical timer wheel, where each slot of a level spans all slots of the level below
+        std::array<std::array<std::vector<wheel_entry_t>, wheel_size>, wheel_levels> m_wheel;
+        size_t m_n_wheel_entries;
+        // entries of the current (or an already passed) tick, which are checked on every update
+        std::vector<wheel_entry_t> m_due;
+        // helper buffer for the processed entries
+        std::vector<wheel_entry_t> m_processed;
+        ros::Time m_start_time;
+        uint64_t m_tick_period_ns;
+        uint64_t m_tick;
+
+        // the expired callbacks, which are called after unlocking the mutex (only used by the main timer callback)
+        std::vector<std::pair<std::shared_ptr<const callback_t>, ros::Time>> m_expired;
       
         ros::Timer m_main_timer;
       
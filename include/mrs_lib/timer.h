@@ -6,6 +6,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <vector>
 
 namespace mrs_lib
 {
@@ -147,10 +148,38 @@ namespace mrs_lib
 
   /**
    * @brief Custom thread-based Timers with the same interface as mrs_lib::ROSTimer.
+   *
+   * The callbacks are scheduled at absolute deadlines (start + n*period), so the period doesn't drift by the duration
+   * of the callbacks. If some deadlines are missed (e.g. due to a long callback), they are skipped and counted in the
+   * statistics, and the timer continues at the next deadline.
+   *
+   * Unless the simulation time is used, the timer thread sleeps on a timerfd with an absolute expiration time, which
+   * is more precise than waiting on a condition variable. The priority and CPU affinity of the timer thread may be set
+   * using the setPriority() and setAffinity() methods and the lateness of the callbacks may be obtained using the
+   * getStatistics() method.
    */
   class ThreadTimer : public MRSTimer {
 
   public:
+    /**
+     * @brief statistics of the lateness of the callbacks (the difference between the actual and the expected time of the callback)
+     */
+    struct statistics_t
+    {
+      uint64_t n_callbacks = 0;     /**< number of the called callbacks */
+      uint64_t n_missed = 0;        /**< number of the skipped deadlines */
+      ros::Duration max_lateness;   /**< the largest lateness */
+      ros::Duration mean_lateness;  /**< the average lateness */
+      ros::Duration lateness_p50;   /**< median of the lateness of the last lateness_window callbacks */
+      ros::Duration lateness_p90;   /**< 90th percentile of the lateness of the last lateness_window callbacks */
+      ros::Duration lateness_p99;   /**< 99th percentile of the lateness of the last lateness_window callbacks */
+    };
+
+    /**
+     * @brief number of the last callbacks, from which the percentiles of the lateness are calculated
+     */
+    static constexpr size_t lateness_window = 1024;
+
     ThreadTimer();
 
     /**
@@ -216,6 +245,38 @@ namespace mrs_lib
      */
     virtual bool running() override;
 
+    /**
+     * @brief returns the statistics of the lateness of the callbacks since the start or since the last call to resetStatistics()
+     *
+     * @return the statistics
+     */
+    statistics_t getStatistics();
+
+    /**
+     * @brief resets the statistics of the lateness of the callbacks
+     */
+    void resetStatistics();
+
+    /**
+     * @brief sets the real-time (SCHED_FIFO) priority of the timer thread
+     *
+     * @note This usually requires the CAP_SYS_NICE capability or an appropriate RLIMIT_RTPRIO limit.
+     *
+     * @param priority the new priority (1 to 99), zero to switch back to the normal scheduling policy.
+     *
+     * @return true if the priority was set successfully
+     */
+    bool setPriority(const int priority);
+
+    /**
+     * @brief sets the CPUs, on which the timer thread (and therefore the callbacks) may run
+     *
+     * @param cpus indices of the allowed CPUs.
+     *
+     * @return true if the affinity was set successfully
+     */
+    bool setAffinity(const std::vector<int>& cpus);
+
     /**
      * @brief stops the timer and then destroys the object
      *
@@ -0,0 +1,93 @@
+/**  \file
+ *   \brief Process-wide recorder of trace events, which may be viewed in chrome://tracing or ui.perfetto.dev
+ */
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace mrs_lib
+{
+
+/**
+ * @brief Process-wide recorder of trace events in the Chrome Trace Event format.
+ *
+ * When tracing is started, the ScopeTimer, FastScopeTimer and the Profiler routines record a complete event (with its
+ * start, duration and thread ID) for each scope, checkpoint and routine, even if the timer or the profiler is disabled.
+ * Nested scopes of the same thread are shown nested in the trace viewer. Other code may record its own events using the
+ * complete() method.
+ *
+ * The events are recorded to a preallocated lock-free ring buffer of each thread, so recording an event never blocks
+ * (if the ring buffer is full, the event is dropped). A background thread periodically drains the ring buffers and
+ * appends the events to the trace file in the JSON array format, which may be opened directly in chrome://tracing or
+ * in ui.perfetto.dev (even if the process was killed before stopping the tracing).
+ *
+ * The event times are recorded using the steady clock and written to the file in the system (wall) clock, so that the
+ * trace files of multiple processes (e.g. all the nodes of a drone) may be merged to a single timeline using the
+ * merge() method or the `trace_merge` executable.
+ *
+ * Tracing is started either by calling start() or by setting the `MRS_LIB_TRACE_DIR` environment variable, in which case
+ * each process writes its trace to the file `trace_<pid>.json` in that directory.
+ */
+class Tracer {
+
+public:
+  using chrono_tp = std::chrono::time_point<std::chrono::steady_clock>;
+
+  /**
+   * @brief Starts recording the trace events to a file (the file is overwritten).
+   *
+   * @param filepath       path to the trace file.
+   * @param buffer_events  capacity of the ring buffer of each thread (in events).
+   *
+   * @return true if the file was opened and the tracing started.
+   */
+  static bool start(const std::string& filepath, const size_t buffer_events = 1 << 14);
+
+  /**
+   * @brief Stops recording the trace events, writes the remaining events and closes the trace file.
+   */
+  static void stop();
+
+  /**
+   * @brief Returns true if the trace events are being recorded.
+   */
+  static bool enabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Records a complete event of the calling thread.
+   *
+   * @param name      name of the event, which has to stay valid until the end of the program (a string literal or a name returned by intern()).
+   * @param category  category of the event (has to stay valid as well).
+   * @param start     time when the event started.
+   * @param end       time when the event ended.
+   */
+  static void complete(const char* name, const char* category, const chrono_tp& start, const chrono_tp& end);
+
+  /**
+   * @brief Returns a name with the same text, which stays valid until the end of the program.
+   */
+  static const char* intern(const std::string& name);
+
+  /**
+   * @brief Merges multiple trace files to a single one.
+   *
+   * @param input_filepaths  paths to the trace files written by the Tracer.
+   * @param output_filepath  path to the merged trace file.
+   *
+   * @return true if all the files were read and the merged file was written.
+   */
+  static bool merge(const std::vector<std::string>& input_filepaths, const std::string& output_filepath);
+
+private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace mrs_lib
+
+#endif
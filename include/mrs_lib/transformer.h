@@ -35,6 +35,10 @@
 #include <pcl_conversions/pcl_conversions.h>
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <unordered_map>
 #include <experimental/type_traits>
 
 //}
@@ -131,6 +135,7 @@ namespace mrs_lib
     {
       std::scoped_lock lck(mutex_);
       default_frame_id_ = frame_id;
+      resetStaticCacheImpl();
     }
 
     //}
@@ -157,6 +162,7 @@ namespace mrs_lib
         prefix_ = "";
       else
         prefix_ = prefix + "/";
+      resetStaticCacheImpl();
     }
 
     //}
@@ -233,6 +239,84 @@ namespace mrs_lib
 
     //}
 
+    /* setCaching() //{ */
+
+    /**
+     * \brief Enable/disable caching of the looked up transforms.
+     *
+     * When caching is enabled, the transforms looked up using getTransform(), transformSingle(), transformAsVector() and transformAsPoint()
+     * (the overloads taking the frame names) are cached by their interned frame names:
+     *   - If the whole chain between the two frames is static (e.g. a sensor mount), the transform is looked up once and is then served for any
+     *     time stamp without locking the Transformer and without the TF2 lookup. The static transforms are looked up again after
+     *     \p static_revalidation_period to pick up a republished static transform.
+     *   - Other transforms looked up at a specific (non-zero) time stamp are kept in a small least-recently-used cache, so that repeated lookups
+     *     of the same chain at the same time stamp (e.g. transforming multiple messages with the same header) skip the TF2 lookup.
+     *
+     * Transforms to/from the latlon_origin frame, lookups of the latest transform of a non-static chain and the transforms obtained by
+     * retrying the lookup with \p ros::Time(0) (see retryLookupNewest()) are never cached.
+     *
+     * \param enable                      enables or disables caching.
+     * \param dynamic_cache_size          maximal number of the cached non-static transforms.
+     * \param static_revalidation_period  how long the static transforms are served from the cache before they are looked up again.
+     *
+     * \note Enabled by default.
+     */
+    void setCaching(const bool enable = true, const size_t dynamic_cache_size = 16, const ros::Duration& static_revalidation_period = ros::Duration(1.0))
+    {
+      std::scoped_lock lck(mutex_);
+      cache_enabled_ = enable;
+      dynamic_cache_size_ = dynamic_cache_size;
+      static_revalidation_period_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_revalidation_period.toSec()));
+      dynamic_cache_.clear();
+      resetStaticCacheImpl();
+    }
+
+    //}
+
+    /* clearCache() //{ */
+
+    /**
+     * \brief Drops all the cached transforms, so that they are looked up again.
+     *
+     * This may be used e.g. after a static transform was republished with a new value to use it immediately.
+     */
+    void clearCache()
+    {
+      std::scoped_lock lck(mutex_);
+      dynamic_cache_.clear();
+      resetStaticCacheImpl();
+    }
+
+    //}
+
+    /* getCacheStatistics() //{ */
+
+    /**
+     * \brief Hit and miss counters of the transform cache (see setCaching()).
+     */
+    struct cache_statistics_t
+    {
+      uint64_t static_hits = 0;   ///< number of lookups served from the cache of the static transforms
+      uint64_t dynamic_hits = 0;  ///< number of lookups served from the cache of the recent non-static transforms
+      uint64_t misses = 0;        ///< number of cacheable lookups, which were looked up in the TF2 buffer
+    };
+
+    /**
+     * \brief Returns the hit and miss counters of the transform cache since the construction of the Transformer.
+     *
+     * \return the cache statistics.
+     */
+    cache_statistics_t getCacheStatistics() const
+    {
+      cache_statistics_t ret;
+      ret.static_hits = static_hits_.load(std::memory_order_relaxed);
+      ret.dynamic_hits = dynamic_hits_.load(std::memory_order_relaxed);
+      ret.misses = cache_misses_.load(std::memory_order_relaxed);
+      return ret;
+    }
+
+    //}
+
     /* resolveFrame() //{ */
     /**
      * \brief Deduce the full frame ID from a shortened or empty string using current default prefix and default frame rules.
@@ -519,13 +603,56 @@ namespace mrs_lib
     bool got_utm_zone_ = false;
     std::array<char, 10> utm_zone_ = {};
 
+    // transform cache
+    using steady_tp = std::chrono::steady_clock::time_point;
+
+    struct static_transform_t
+    {
+      std::string from_frame;
+      std::string to_frame;
+      geometry_msgs::Transform transform;
+      steady_tp valid_until;
+    };
+
+    // an immutable snapshot of the cached static transforms, which is replaced as a whole when it changes
+    struct static_cache_t
+    {
+      std::unordered_map<std::string, uint32_t> frame_ids;  // raw (unresolved) frame names to the interned IDs of the resolved frames
+      std::unordered_map<uint64_t, static_transform_t> transforms;
+    };
+
+    struct dynamic_transform_t
+    {
+      uint64_t key;
+      geometry_msgs::TransformStamped tf;
+    };
+
+    bool cache_enabled_ = true;
+    size_t dynamic_cache_size_ = 16;
+    std::chrono::steady_clock::duration static_revalidation_period_ = std::chrono::seconds(1);
+
+    std::unordered_map<std::string, uint32_t> frame_ids_;  // interned IDs of the resolved frames
+    std::shared_ptr<const static_cache_t> static_cache_;   // accessed using std::atomic_load and std::atomic_store
+    std::unordered_map<uint64_t, steady_tp> next_static_check_;
+    std::list<dynamic_transform_t> dynamic_cache_;  // the most recently used first
+
+    std::atomic<uint64_t> static_hits_ = 0;
+    std::atomic<uint64_t> dynamic_hits_ = 0;
+    std::atomic<uint64_t> cache_misses_ = 0;
+
+    uint64_t cacheKey(const std::string& from_frame, const std::string& to_frame);
+    void resetStaticCacheImpl();
+    std::optional<geometry_msgs::TransformStamped> getStaticTransform(const std::string& from_frame_raw, const std::string& to_frame_raw, const ros::Time& time_stamp);
+    [[nodiscard]] std::optional<geometry_msgs::TransformStamped> getTransformCached(const std::string& from_frame_raw, const std::string& to_frame_raw, const std::string& from_frame, const std::string& to_frame, const ros::Time& time_stamp, const std::string& latlon_frame);
+
     // returns the first namespace prefix of the frame (if any) includin the forward slash
     std::string getFramePrefix(const std::string& frame_id);
 
+    // an empty latlon_frame disables the conversions from/to latitude/longitude (the cached transforms never include the latlon frame)
     template <class T>
-    std::optional<T> transformImpl(const geometry_msgs::TransformStamped& tf, const T& what);
-    std::optional<mrs_msgs::ReferenceStamped> transformImpl(const geometry_msgs::TransformStamped& tf, const mrs_msgs::ReferenceStamped& what);
-    std::optional<Eigen::Vector3d> transformImpl(const geometry_msgs::TransformStamped& tf, const Eigen::Vector3d& what);
+    std::optional<T> transformImpl(const geometry_msgs::TransformStamped& tf, const T& what, const std::string& latlon_frame);
+    std::optional<mrs_msgs::ReferenceStamped> transformImpl(const geometry_msgs::TransformStamped& tf, const mrs_msgs::ReferenceStamped& what, const std::string& latlon_frame);
+    std::optional<Eigen::Vector3d> transformImpl(const geometry_msgs::TransformStamped& tf, const Eigen::Vector3d& what, const std::string& latlon_frame);
 
     [[nodiscard]] std::optional<geometry_msgs::TransformStamped> getTransformImpl(const std::string& from_frame, const std::string& to_frame, const ros::Time& time_stamp, const std::string& latlon_frame);
     [[nodiscard]] std::optional<geometry_msgs::TransformStamped> getTransformImpl(const std::string& from_frame, const ros::Time& from_stamp, const std::string& to_frame, const ros::Time& to_stamp, const std::string& fixed_frame, const std::string& latlon_frame);
@@ -9,6 +9,7 @@
  */
 
 #include <mrs_lib/kalman_filter.h>
+#include <limits>
 
 namespace mrs_lib
 {
@@ -30,6 +31,9 @@ namespace mrs_lib
   * of Eigen, the code is arguably more readable when you use aliases to the specific Matrix instances instead of
   * having Eigen::MatrixXd and Eigen::VectorXd everywhere.
   *
+  * The predict() and correct() methods reuse helper variables stored in the UKF object, so they may not be called
+  * concurrently on the same object from multiple threads (use the in-place variants with a workspace per thread instead).
+  *
   * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
   * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
   * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
@@ -75,6 +79,10 @@ namespace mrs_lib
     using transition_model_t = typename std::function<x_t(const x_t&, const u_t&, double)>;
     //! function of the observation model typedef
     using observation_model_t = typename std::function<z_t(const x_t&)>;
+    //! function of the state transition model, which writes the result to its last parameter, typedef (avoids allocations for dynamic sizes)
+    using transition_model_inplace_t = typename std::function<void(const x_t&, const u_t&, double, x_t&)>;
+    //! function of the observation model, which writes the result to its last parameter, typedef (avoids allocations for dynamic sizes)
+    using observation_model_inplace_t = typename std::function<void(const x_t&, z_t&)>;
 
     //! is thrown when taking the square root of a matrix fails during sigma generation
     struct square_root_exception : public std::exception
@@ -93,6 +101,85 @@ namespace mrs_lib
         return "UKF: inverting of Pzz in correction update produced NANs!!!";
       }
     };
+
+    /*!
+      * \brief Preallocated helper variables for the predict and correct steps.
+      *
+      * Passing the same workspace to repeated predictInPlace() and correctInPlace() calls avoids any heap allocations
+      * in these methods even for dynamically-sized UKFs (e.g. with \p n_states = -1), provided that the in-place
+      * variants of the transition and observation models are used (see setTransitionModelInPlace() and setObservationModelInPlace()).
+      * The workspace is (re)allocated automatically whenever the dimensions of the state or measurement change.
+      *
+      * \note A workspace may only be used by one thread at a time.
+      */
+    struct workspace_t
+    {
+      /*!
+        * \brief Default constructor (no preallocation for dynamic sizes, the workspace is allocated on first use).
+        */
+      workspace_t() = default;
+
+      /*!
+        * \brief Preallocates the workspace for the given dimensions (only useful for dynamic sizes).
+        *
+        * \param n_dim   Length of the state vector.
+        * \param p_dim   Length of the measurement vector.
+        */
+      workspace_t(const int n_dim, const int p_dim)
+      {
+        resize(n_dim, p_dim);
+      }
+
+      /*!
+        * \brief Resizes all the helper variables for the given dimensions (for fixed sizes, this is a no-op).
+        *
+        * \param n_dim   Length of the state vector.
+        * \param p_dim   Length of the measurement vector.
+        */
+      void resize(const int n_dim, const int p_dim)
+      {
+        const int n_sigmas = 2 * n_dim + 1;
+        Wm.resize(n_sigmas);
+        Wc.resize(n_sigmas);
+        S.resize(n_dim, n_sigmas);
+        X.resize(n_dim, n_sigmas);
+        Pa.resize(n_dim, n_dim);
+        Pa_sqrt.resize(n_dim, n_dim);
+        P.resize(n_dim, n_dim);
+        x.resize(n_dim);
+        x_sigma.resize(n_dim);
+        x_model.resize(n_dim);
+        dx.resize(n_dim);
+        Z.resize(p_dim, n_sigmas);
+        z_model.resize(p_dim);
+        z_exp.resize(p_dim);
+        dz.resize(p_dim);
+        inn.resize(p_dim);
+        Pzz.resize(p_dim, p_dim);
+        Pxz.resize(n_dim, p_dim);
+        K.resize(n_dim, p_dim);
+        KPzz.resize(n_dim, p_dim);
+        // the decompositions are preallocated by decomposing an identity of the correct size
+        llt.compute(P_t::Identity(n_dim, n_dim));
+        llt_zz.compute(Pzz_t::Identity(p_dim, p_dim));
+        n_x = n_dim;
+        n_z = p_dim;
+      }
+
+      int n_x = -1, n_z = -1;               /*!< \brief Dimensions, for which the workspace is allocated. */
+      double alpha = std::numeric_limits<double>::quiet_NaN(), kappa = 0.0, beta = 0.0;  /*!< \brief Constants, for which the weights were calculated. */
+      double lambda = 0.0;                  /*!< \brief Scaling parameter of the sigma generation. */
+      W_t Wm, Wc;                           /*!< \brief Weights of the sigma points. */
+      X_t S, X;                             /*!< \brief State sigma points before and after the propagation. */
+      P_t Pa, Pa_sqrt, P;                   /*!< \brief Scaled covariance, its square root and the new covariance. */
+      Eigen::LLT<P_t> llt;                  /*!< \brief Decomposition for the square root of the covariance. */
+      x_t x, x_sigma, x_model, dx;          /*!< \brief Helper state vectors. */
+      Z_t Z;                                /*!< \brief Measurement sigma points. */
+      z_t z_model, z_exp, dz, inn;          /*!< \brief Helper measurement vectors. */
+      Pzz_t Pzz;                            /*!< \brief Covariance of the measurement. */
+      Eigen::LLT<Pzz_t> llt_zz;             /*!< \brief Decomposition of the measurement covariance for the Kalman gain. */
+      K_t Pxz, K, KPzz;                     /*!< \brief Cross covariance, Kalman gain and their helper product. */
+    };
     //}
 
   public:
@@ -127,6 +214,16 @@ namespace mrs_lib
     * \returns      The state and covariance after applying the correction step.
     */
     virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override;
+
+  /*!
+    * \brief Implements the state correction step (measurement update) in-place using a preallocated workspace.
+    *
+    * \param sc     Estimate of the state and covariance, which will be updated.
+    * \param z      Measurement vector.
+    * \param R      Measurement covariance matrix.
+    * \param ws     Workspace with the helper variables (reused between the calls to avoid allocations).
+    */
+    void correctInPlace(statecov_t& sc, const z_t& z, const R_t& R, workspace_t& ws) const;
     //}
 
     /* predict() method //{ */
@@ -140,6 +237,17 @@ namespace mrs_lib
     * \returns      The state and covariance after applying the correction step.
     */
     virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override;
+
+  /*!
+    * \brief Implements the state prediction step (time update) in-place using a preallocated workspace.
+    *
+    * \param sc     Estimate of the state and covariance, which will be updated.
+    * \param u      Input vector.
+    * \param Q      Process noise covariance matrix.
+    * \param dt     Duration since the previous estimate.
+    * \param ws     Workspace with the helper variables (reused between the calls to avoid allocations).
+    */
+    void predictInPlace(statecov_t& sc, const u_t& u, const Q_t& Q, double dt, workspace_t& ws) const;
     //}
 
     /* setConstants() method //{ */
@@ -171,11 +279,47 @@ namespace mrs_lib
     void setObservationModel(const observation_model_t& observation_model);
     //}
 
+    /* setTransitionModelInPlace() method //{ */
+  /*!
+    * \brief Changes the transition model function to one, which writes its result to a preallocated vector.
+    *
+    * This model takes precedence over the one set using setTransitionModel() or in the constructor.
+    *
+    * \param transition_model   the new transition model (an empty function to use the standard one)
+    */
+    void setTransitionModelInPlace(const transition_model_inplace_t& transition_model);
+    //}
+
+    /* setObservationModelInPlace() method //{ */
+  /*!
+    * \brief Changes the observation model function to one, which writes its result to a preallocated vector.
+    *
+    * This model takes precedence over the one set using setObservationModel() or in the constructor.
+    *
+    * \param observation_model   the new observation model (an empty function to use the standard one)
+    */
+    void setObservationModelInPlace(const observation_model_inplace_t& observation_model);
+    //}
+
   protected:
     /* protected methods and member variables //{ */
 
     void computeWeights();
 
+    void computeWeights(const int n_dim, workspace_t& ws) const;
+
+    void prepareWorkspace(const int n_dim, const int p_dim, workspace_t& ws) const;
+
+    void computeSigmas(const x_t& x, const P_t& P, workspace_t& ws) const;
+
+    void prepareCorrection(const statecov_t& sc, const z_t& z, const R_t& R, workspace_t& ws) const;
+
+    void applyCorrection(statecov_t& sc, workspace_t& ws) const;
+
+    // calculates ws.K from ws.inn, ws.Pxz and ws.Pzz for correctInPlace() (derived classes customizing the gain
+    // should override this variant as well as the one returning the gain, which is used by correct())
+    virtual void computeKalmanGain(const x_t& x, workspace_t& ws) const;
+
     X_t computeSigmas(const x_t& x, const P_t& P) const;
 
     P_t computePaSqrt(const P_t& P) const;
@@ -187,9 +331,13 @@ namespace mrs_lib
     double m_alpha, m_kappa, m_beta, m_lambda;
     W_t m_Wm;
     W_t m_Wc;
+    // helper variables reused by predict() and correct()
+    mutable workspace_t m_ws;
 
     transition_model_t m_transition_model;
     observation_model_t m_observation_model;
+    transition_model_inplace_t m_transition_model_inplace;
+    observation_model_inplace_t m_observation_model_inplace;
 
     //}
   };
@@ -0,0 +1,185 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the IirSosFilter against the IirFilter
+
+     Measures the average duration of filtering one sample of all channels for various filter orders and numbers of channels
+     using the direct form of the IirFilter (both the original shifting buffer and the current ring buffer), and using
+     the IirSosFilter one sample at a time and in blocks.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib iir_filter_benchmark`.
+ */
+
+#include <mrs_lib/iir_filter.h>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+using sections_t = mrs_lib::IirSosFilter::sections_t;
+using samples_t = mrs_lib::IirSosFilter::samples_t;
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+/* helper functions //{ */
+
+// a low-pass Butterworth filter of order 2*n_sections with the cutoff frequency given relative to the sampling frequency
+sections_t lowpassSections(const int n_sections, const double cutoff)
+{
+  sections_t sections(n_sections, 5);
+  const double w0 = 2.0 * M_PI * cutoff;
+  for (int i = 0; i < n_sections; i++)
+  {
+    const double q = 1.0 / (2.0 * std::sin(M_PI * (2 * i + 1) / (4.0 * n_sections)));
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    sections.row(i) << (1.0 - std::cos(w0)) / 2.0 / a0, (1.0 - std::cos(w0)) / a0, (1.0 - std::cos(w0)) / 2.0 / a0, -2.0 * std::cos(w0) / a0, (1.0 - alpha) / a0;
+  }
+  return sections;
+}
+
+// expands the sections to the transfer function (numerator b and denominator a)
+void toTransferFunction(const sections_t& sections, std::vector<double>& a, std::vector<double>& b)
+{
+  const auto multiply = [](const std::vector<double>& p, const std::vector<double>& q)
+  {
+    std::vector<double> ret(p.size() + q.size() - 1, 0.0);
+    for (size_t i = 0; i < p.size(); i++)
+      for (size_t j = 0; j < q.size(); j++)
+        ret.at(i + j) += p.at(i) * q.at(j);
+    return ret;
+  };
+
+  a = {1.0};
+  b = {1.0};
+  for (int i = 0; i < sections.rows(); i++)
+  {
+    a = multiply(a, {1.0, sections(i, 3), sections(i, 4)});
+    b = multiply(b, {sections(i, 0), sections(i, 1), sections(i, 2)});
+  }
+}
+
+// the direct-form filter, which shifts the whole buffer with each sample (as the IirFilter used to)
+class ShiftingIirFilter
+{
+public:
+  ShiftingIirFilter(const std::vector<double>& a, const std::vector<double>& b) : a_(a), b_(b), order_(a.size()), buffer_(a.size(), 0.0) {}
+
+  double iterate(const double& input)
+  {
+    double output = 0;
+    buffer_[0] = input;
+    for (size_t i = 1; i < order_; i++)
+    {
+      buffer_[0] += (-a_[i]) * buffer_[i];
+      output += (b_[i]) * buffer_[i];
+    }
+    output += buffer_[0] * b_[0];
+    for (size_t i = order_ - 1; i > 0; i--)
+      buffer_[i] = buffer_[i - 1];
+    return output;
+  }
+
+private:
+  std::vector<double> a_;
+  std::vector<double> b_;
+  size_t order_;
+  std::vector<double> buffer_;
+};
+
+//}
+
+/* benchmark() function //{ */
+
+// measures the average duration of filtering one sample of all the channels (in nanoseconds) using the given method
+template <typename method_t>
+double benchmark(const samples_t& input, method_t method)
+{
+  samples_t output(input.rows(), input.cols());
+  const auto start = std::chrono::steady_clock::now();
+  method(input, output);
+  const auto end = std::chrono::steady_clock::now();
+
+  // prevent the compiler from optimizing the filtering away
+  if (std::isnan(output.sum()))
+    std::cerr << "NaN encountered in the output!" << std::endl;
+  return std::chrono::duration<double, std::nano>(end - start).count() / input.cols();
+}
+
+//}
+
+int main()
+{
+  const int n_samples = 100000;
+  const int block_length = 64;
+
+  std::cout << "n_channels,n_sections,shifting_ns,ring_ns,sos_ns,sos_block_ns,sos_multi_ns,sos_multi_block_ns" << std::endl;
+  for (const int n_channels : {1, 3, 8})
+  {
+    for (const int n_sections : {1, 2, 4})
+    {
+      const sections_t sections = lowpassSections(n_sections, 0.1);
+      std::vector<double> a, b;
+      toTransferFunction(sections, a, b);
+      // prepare the data beforehand so that their generation is not measured
+      const samples_t input = samples_t::NullaryExpr(n_channels, n_samples, [](){return d(gen);});
+
+      // separate filters for each channel, one sample at a time
+      const auto per_channel = [&](auto filter)
+      {
+        return [&, filter](const samples_t& input, samples_t& output) mutable
+        {
+          std::vector<decltype(filter)> filters(n_channels, filter);
+          for (int k = 0; k < input.cols(); k++)
+            for (int ch = 0; ch < n_channels; ch++)
+              output(ch, k) = filters.at(ch).iterate(input(ch, k));
+        };
+      };
+
+      const double shifting_ns = benchmark(input, per_channel(ShiftingIirFilter(a, b)));
+      const double ring_ns = benchmark(input, per_channel(mrs_lib::IirFilter(a, b)));
+      const double sos_ns = benchmark(input, per_channel(mrs_lib::IirSosFilter(sections)));
+
+      // separate filters for each channel in blocks
+      const double sos_block_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+      {
+        std::vector<mrs_lib::IirSosFilter> filters(n_channels, mrs_lib::IirSosFilter(sections));
+        std::vector<double> block(block_length);
+        for (int k = 0; k < input.cols(); k += block_length)
+        {
+          const int length = std::min(block_length, int(input.cols()) - k);
+          for (int ch = 0; ch < n_channels; ch++)
+          {
+            for (int it = 0; it < length; it++)
+              block[it] = input(ch, k + it);
+            filters.at(ch).filter(block.data(), block.data(), length);
+            for (int it = 0; it < length; it++)
+              output(ch, k + it) = block[it];
+          }
+        }
+      });
+
+      // a single multi-channel filter, one sample at a time
+      const double sos_multi_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+      {
+        mrs_lib::IirSosFilter filter(sections, n_channels);
+        for (int k = 0; k < input.cols(); k++)
+          filter.iterate(input.col(k), output.col(k));
+      });
+
+      // a single multi-channel filter in blocks
+      const double sos_multi_block_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+      {
+        mrs_lib::IirSosFilter filter(sections, n_channels);
+        for (int k = 0; k < input.cols(); k += block_length)
+        {
+          const int length = std::min(block_length, int(input.cols()) - k);
+          filter.filter(input.middleCols(k, length), output.middleCols(k, length));
+        }
+      });
+
+      std::cout << n_channels << "," << n_sections << "," << shifting_ns << "," << ring_ns << "," << sos_ns << "," << sos_block_ns << "," << sos_multi_ns << "," << sos_multi_block_ns << std::endl;
+    }
+  }
+  return 0;
+}
@@ -1,4 +1,7 @@
 #include <mrs_lib/iir_filter.h>
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
 
 namespace mrs_lib
 {
@@ -14,6 +17,7 @@ IirFilter::IirFilter(const std::vector<double>& a_in, const std::vector<double>&
 
   order_ = a_.size();
   buffer_.resize(order_, 0.0);
+  buffer_idx_ = 0;
   for (size_t i = 0; i < a_.size(); i++) {
     
   ROS_INFO_STREAM("a: " << a_[i] << " b: " << b_[i]);
@@ -27,22 +31,296 @@ IirFilter::IirFilter(const std::vector<double>& a_in, const std::vector<double>&
 
 double IirFilter::iterate(const double& input) {
 
-  double output = 0;
+  // the buffer is used as a ring, the newest value will be stored one position before the previous newest value
+  // (overwriting the oldest one), so that the buffer doesn't have to be shifted
+  buffer_idx_ = (buffer_idx_ == 0 ? order_ : buffer_idx_) - 1;
 
-  buffer_[0] = input;
+  double output = 0;
+  double value  = input;
 
+  size_t idx = buffer_idx_;
   for (size_t i = 1; i < order_; i++) {
-    buffer_[0] += (-a_[i]) * buffer_[i];
-    output += (b_[i]) * buffer_[i];
+    if (++idx == order_) {
+      idx = 0;
+    }
+    value += (-a_[i]) * buffer_[idx];
+    output += (b_[i]) * buffer_[idx];
   }
 
-  output += buffer_[0] * b_[0];
+  buffer_[buffer_idx_] = value;
+  output += value * b_[0];
+
+  return output;
+}
+
+//}
+
+// | ----------------------- IirSosFilter ---------------------- |
 
-  for (size_t i = order_ - 1; i > 0; i--) {
-    buffer_[i] = buffer_[i - 1];
+/* helper functions for the conversion to sections //{ */
+
+namespace
+{
+
+// a quadratic factor (c0 + c1*z^-1 + c2*z^-2) of a polynomial with its root, which is furthest from the origin
+struct quadratic_t
+{
+  Eigen::Vector3d      coeffs;
+  std::complex<double> root;
+};
+
+// finds the roots of a polynomial p[0] + p[1]*z^-1 + ... (with p[0] != 0) as the eigenvalues of its companion matrix
+Eigen::VectorXcd findRoots(const std::vector<double>& p) {
+
+  const int n = p.size() - 1;
+  if (n == 0) {
+    return Eigen::VectorXcd();
   }
 
-  return output;
+  Eigen::MatrixXd companion = Eigen::MatrixXd::Zero(n, n);
+  for (int i = 0; i < n; i++) {
+    companion(0, i) = -p[i + 1] / p[0];
+  }
+  companion.bottomLeftCorner(n - 1, n - 1).setIdentity();
+
+  return Eigen::EigenSolver<Eigen::MatrixXd>(companion, false).eigenvalues();
+}
+
+// combines the roots (and delays, i.e. factors z^-1) into quadratic factors with real coefficients
+std::vector<quadratic_t> toQuadratics(const Eigen::VectorXcd& roots, const int n_delays) {
+
+  std::vector<quadratic_t> quadratics;
+  // first-order real factors (c0 + c1*z^-1) with their roots
+  std::vector<std::pair<Eigen::Vector2d, double>> linears;
+
+  for (const auto& root : roots) {
+    if (std::abs(root.imag()) > 1e-10 * std::max(1.0, std::abs(root))) {
+      // complex roots come in conjugate pairs, so only the one with the positive imaginary part is used
+      if (root.imag() > 0) {
+        quadratics.push_back({Eigen::Vector3d(1.0, -2.0 * root.real(), std::norm(root)), root});
+      }
+    } else {
+      linears.push_back({Eigen::Vector2d(1.0, -root.real()), root.real()});
+    }
+  }
+
+  // sort the real roots so that the close ones end up in the same factor
+  std::sort(linears.begin(), linears.end(), [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+  for (int i = 0; i < n_delays; i++) {
+    linears.push_back({Eigen::Vector2d(0.0, 1.0), std::numeric_limits<double>::infinity()});
+  }
+
+  for (size_t i = 0; i < linears.size(); i += 2) {
+    const auto& [f, f_root] = linears[i];
+    if (i + 1 < linears.size()) {
+      const auto& [g, g_root] = linears[i + 1];
+      const double root       = std::abs(f_root) > std::abs(g_root) ? f_root : g_root;
+      quadratics.push_back({Eigen::Vector3d(f(0) * g(0), f(0) * g(1) + f(1) * g(0), f(1) * g(1)), root});
+    } else {
+      quadratics.push_back({Eigen::Vector3d(f(0), f(1), 0.0), f_root});
+    }
+  }
+
+  return quadratics;
+}
+
+}  // namespace
+
+//}
+
+/* IirSosFilter constructor //{ */
+
+IirSosFilter::IirSosFilter(const sections_t& sections, const size_t n_channels) {
+
+  sections_   = sections;
+  n_channels_ = n_channels;
+
+  // the state is padded, so that whole chunks of channels can always be processed
+  const size_t n_padded = ((n_channels + chunk_size - 1) / chunk_size) * chunk_size;
+  s1_                   = Eigen::ArrayXXd::Zero(n_padded, sections_.rows());
+  s2_                   = Eigen::ArrayXXd::Zero(n_padded, sections_.rows());
+
+  ROS_INFO("[%s]: IIR SOS filter with %ld sections and %zu channels initialized!", ros::this_node::getName().c_str(), long(sections_.rows()), n_channels);
+}
+
+//}
+
+/* toSections() //{ */
+
+IirSosFilter::sections_t IirSosFilter::toSections(const std::vector<double>& a, const std::vector<double>& b) {
+
+  if (a.empty() || a[0] == 0.0) {
+    throw std::invalid_argument("IirSosFilter: the first coefficient of the denominator has to be non-zero!");
+  }
+
+  // leading zeros of the numerator are delays
+  const auto b_first = std::find_if(b.begin(), b.end(), [](const double coeff) { return coeff != 0.0; });
+  const int  n_delays = b_first - b.begin();
+  if (b_first == b.end()) {
+    throw std::invalid_argument("IirSosFilter: the numerator has to contain a non-zero coefficient!");
+  }
+  const std::vector<double> b_nonzero(b_first, b.end());
+
+  std::vector<quadratic_t> poles  = toQuadratics(findRoots(a), 0);
+  std::vector<quadratic_t> zeros  = toQuadratics(findRoots(b_nonzero), n_delays);
+  const size_t             n_sections = std::max(poles.size(), zeros.size());
+
+  // the poles closest to the unit circle will be in the last section
+  poles.resize(n_sections, {Eigen::Vector3d(1.0, 0.0, 0.0), 0.0});
+  const auto distance = [](const quadratic_t& quadratic) { return std::abs(1.0 - std::abs(quadratic.root)); };
+  std::sort(poles.begin(), poles.end(), [&distance](const auto& lhs, const auto& rhs) { return distance(lhs) > distance(rhs); });
+
+  sections_t sections(n_sections, 5);
+  for (int i = n_sections - 1; i >= 0; i--) {
+    sections.row(i).tail<2>() = poles[i].coeffs.tail<2>().transpose();
+
+    // pair the zeros closest to the poles with them, starting from the poles closest to the unit circle
+    if (zeros.empty()) {
+      sections.row(i).head<3>() = Eigen::RowVector3d(1.0, 0.0, 0.0);
+    } else {
+      const auto closest = std::min_element(zeros.begin(), zeros.end(), [&poles, i](const auto& lhs, const auto& rhs) {
+        return std::abs(lhs.root - poles[i].root) < std::abs(rhs.root - poles[i].root);
+      });
+      sections.row(i).head<3>() = closest->coeffs.transpose();
+      zeros.erase(closest);
+    }
+  }
+
+  // the gain is applied in the first section
+  sections.row(0).head<3>() *= b_nonzero[0] / a[0];
+
+  return sections;
+}
+
+//}
+
+/* iterate() //{ */
+
+double IirSosFilter::iterate(const double& input) {
+
+  double x = input;
+
+  for (int i = 0; i < sections_.rows(); i++) {
+    const double y = sections_(i, 0) * x + s1_(0, i);
+    s1_(0, i)      = sections_(i, 1) * x - sections_(i, 3) * y + s2_(0, i);
+    s2_(0, i)      = sections_(i, 2) * x - sections_(i, 4) * y;
+    x              = y;
+  }
+
+  return x;
+}
+
+void IirSosFilter::iterate(const Eigen::Ref<const Eigen::VectorXd>& input, Eigen::Ref<Eigen::VectorXd> output) {
+
+  iterateChunks(input.data(), output.data());
+}
+
+//}
+
+/* filter() //{ */
+
+void IirSosFilter::filter(const double* input, double* output, const size_t n_samples) {
+
+  if (input != output) {
+    std::copy(input, input + n_samples, output);
+  }
+
+  // apply the sections one after another to the whole block, so that the state of a section stays in registers
+  for (int i = 0; i < sections_.rows(); i++) {
+    const double b0 = sections_(i, 0), b1 = sections_(i, 1), b2 = sections_(i, 2), a1 = sections_(i, 3), a2 = sections_(i, 4);
+    double       s1 = s1_(0, i);
+    double       s2 = s2_(0, i);
+
+    for (size_t k = 0; k < n_samples; k++) {
+      const double x = output[k];
+      const double y = b0 * x + s1;
+      s1             = b1 * x - a1 * y + s2;
+      s2             = b2 * x - a2 * y;
+      output[k]      = y;
+    }
+
+    s1_(0, i) = s1;
+    s2_(0, i) = s2;
+  }
+}
+
+void IirSosFilter::filter(const Eigen::Ref<const samples_t>& input, Eigen::Ref<samples_t> output) {
+
+  for (int k = 0; k < input.cols(); k++) {
+    iterateChunks(input.col(k).data(), output.col(k).data());
+  }
+}
+
+//}
+
+/* reset() //{ */
+
+void IirSosFilter::reset() {
+
+  s1_.setZero();
+  s2_.setZero();
 }
 
+//}
+
+/* channels() //{ */
+
+size_t IirSosFilter::channels() const {
+  return n_channels_;
+}
+
+//}
+
+/* sections() //{ */
+
+const IirSosFilter::sections_t& IirSosFilter::sections() const {
+  return sections_;
+}
+
+//}
+
+/* setSection() //{ */
+
+void IirSosFilter::setSection(const int index, const Eigen::Matrix<double, 1, 5>& coeffs) {
+  sections_.row(index) = coeffs;
+}
+
+//}
+
+/* iterateChunks() //{ */
+
+void IirSosFilter::iterateChunks(const double* input, double* output) {
+
+  const int n_channels = n_channels_;
+
+  for (int c = 0; c < n_channels; c += chunk_size) {
+
+    // the last chunk may be only partially filled with the channels
+    const int n = std::min(chunk_size, n_channels - c);
+    chunk_t   x = chunk_t::Zero();
+    if (n == chunk_size) {
+      x = Eigen::Map<const chunk_t>(input + c);
+    } else {
+      x.head(n) = Eigen::Map<const Eigen::ArrayXd>(input + c, n);
+    }
+
+    for (int i = 0; i < sections_.rows(); i++) {
+      Eigen::Map<chunk_t> s1(s1_.col(i).data() + c);
+      Eigen::Map<chunk_t> s2(s2_.col(i).data() + c);
+      const chunk_t       y = sections_(i, 0) * x + s1;
+      s1                    = sections_(i, 1) * x - sections_(i, 3) * y + s2;
+      s2                    = sections_(i, 2) * x - sections_(i, 4) * y;
+      x                     = y;
+    }
+
+    if (n == chunk_size) {
+      Eigen::Map<chunk_t>(output + c) = x;
+    } else {
+      Eigen::Map<Eigen::ArrayXd>(output + c, n) = x.head(n);
+    }
+  }
+}
+
+//}
+
 }  // namespace mrs_lib
@@ -0,0 +1,134 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the BatchLKF against the same number of separate LKF instances
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib batch_lkf_benchmark`.
+ */
+
+#include <mrs_lib/lkf.h>
+#include <mrs_lib/batch_lkf.h>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+// Define the LKF we will be using (a constant-velocity model in 3D with position measurement)
+namespace mrs_lib
+{
+  const int n_states = 6;
+  const int n_inputs = 3;
+  const int n_measurements = 3;
+
+  using lkf_t = LKF<n_states, n_inputs, n_measurements>;
+  using batch_lkf_t = BatchLKF<n_states, n_inputs, n_measurements>;
+}
+
+/* helper aliases and definitions //{ */
+
+using namespace mrs_lib;
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using R_t = lkf_t::R_t;
+using statecov_t = lkf_t::statecov_t;
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+const double dt = 0.01;
+
+A_t generateA()
+{
+  A_t A = A_t::Identity();
+  A.topRightCorner<3, 3>().diagonal().setConstant(dt);
+  return A;
+}
+
+B_t generateB()
+{
+  B_t B = B_t::Zero();
+  B.topRows<3>().diagonal().setConstant(dt*dt/2.0);
+  B.bottomRows<3>().diagonal().setConstant(dt);
+  return B;
+}
+
+H_t generateH()
+{
+  H_t H = H_t::Zero();
+  H.leftCols<3>().setIdentity();
+  return H;
+}
+
+//}
+
+/* benchmark() function //{ */
+
+// measures the average duration of one predict+correct step of all n_filters filters (in microseconds)
+template <bool batch>
+double benchmark(const int n_filters, const int n_iterations)
+{
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const Q_t Q = 0.1*Q_t::Identity();
+  const R_t R = 0.1*R_t::Identity();
+
+  lkf_t lkf(generateA(), generateB(), generateH());
+  std::vector<statecov_t> scs(n_filters, {x0, P0});
+  batch_lkf_t batch_lkf(generateA(), generateB(), generateH(), n_filters, x0, P0);
+
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<batch_lkf_t::Us_t> us(n_iterations);
+  std::vector<batch_lkf_t::Zs_t> zs(n_iterations);
+  for (int it = 0; it < n_iterations; it++)
+  {
+    us.at(it) = batch_lkf_t::Us_t::NullaryExpr(n_inputs, n_filters, [](){return d(gen);});
+    zs.at(it) = batch_lkf_t::Zs_t::NullaryExpr(n_measurements, n_filters, [](){return d(gen);});
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_iterations; it++)
+  {
+    if constexpr (batch)
+    {
+      batch_lkf.predict(us.at(it), Q, dt);
+      batch_lkf.correct(zs.at(it), R);
+    }
+    else
+    {
+      for (int f = 0; f < n_filters; f++)
+      {
+        scs.at(f) = lkf.predict(scs.at(f), us.at(it).col(f), Q, dt);
+        scs.at(f) = lkf.correct(scs.at(f), zs.at(it).col(f), R);
+      }
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  // prevent the compiler from optimizing the updates away
+  double checksum = 0.0;
+  for (int f = 0; f < n_filters; f++)
+    checksum += batch ? batch_lkf.get(f).x.sum() : scs.at(f).x.sum();
+  if (std::isnan(checksum))
+    std::cerr << "NaN encountered in the estimate!" << std::endl;
+  return std::chrono::duration<double, std::micro>(end - start).count() / n_iterations;
+}
+
+//}
+
+int main()
+{
+  const std::vector<int> n_filterss = {1, 8, 32, 128, 512};
+  const int n_iterations = 2000;
+
+  std::cout << "n_filters,separate_us,batch_us,speedup" << std::endl;
+  for (const auto n_filters : n_filterss)
+  {
+    const double separate_us = benchmark<false>(n_filters, n_iterations);
+    const double batch_us = benchmark<true>(n_filters, n_iterations);
+    std::cout << n_filters << "," << separate_us << "," << batch_us << "," << separate_us/batch_us << std::endl;
+  }
+  return 0;
+}
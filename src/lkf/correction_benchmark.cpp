@@ -0,0 +1,110 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the correction modes of the LKF for various numbers of measurements
+
+     Measures the average duration of one LKF::correct() call in each of the correction modes for a fixed number of states
+     and an increasing number of measurements, both with a diagonal and with a full measurement noise covariance matrix.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib lkf_correction_benchmark`.
+ */
+
+#include <mrs_lib/lkf.h>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+/* to_string() function //{ */
+
+template <typename mode_t>
+std::string to_string(const mode_t mode)
+{
+  switch (mode)
+  {
+    case mode_t::standard:
+      return "standard";
+    case mode_t::joseph:
+      return "joseph";
+    case mode_t::information:
+      return "information";
+    case mode_t::sequential:
+      return "sequential";
+  }
+  return "unknown";
+}
+
+//}
+
+/* benchmark() function //{ */
+
+// prints the average duration of one correction (in nanoseconds) for each correction mode
+template <int n, int p>
+void benchmark(const bool diagonal_R, const int n_iterations)
+{
+  using lkf_t = mrs_lib::LKF<n, 1, p>;
+  using mode_t = typename lkf_t::correction_mode_t;
+  using A_t = typename lkf_t::A_t;
+  using B_t = typename lkf_t::B_t;
+  using H_t = typename lkf_t::H_t;
+  using P_t = typename lkf_t::P_t;
+  using R_t = typename lkf_t::R_t;
+  using x_t = typename lkf_t::x_t;
+  using z_t = typename lkf_t::z_t;
+  using statecov_t = typename lkf_t::statecov_t;
+
+  // random observations of a random state (e.g. many landmarks observing a small state)
+  const H_t H = H_t::NullaryExpr([](){return d(gen);});
+  R_t R = R_t::Identity();
+  if (!diagonal_R)
+  {
+    const R_t R_tmp = 0.1*R_t::NullaryExpr([](){return d(gen);});
+    R += R_tmp*R_tmp.transpose();
+  }
+  const P_t P_tmp = P_t::NullaryExpr([](){return d(gen);});
+  const statecov_t sc = {x_t::Zero(), P_tmp*P_tmp.transpose() + P_t::Identity()};
+
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<z_t> zs(n_iterations);
+  for (auto& z : zs)
+    z = z_t::NullaryExpr([](){return d(gen);});
+
+  for (const auto mode : {mode_t::standard, mode_t::joseph, mode_t::information, mode_t::sequential})
+  {
+    lkf_t lkf(A_t::Identity(), B_t::Zero(), H);
+    lkf.setCorrectionMode(mode);
+
+    double checksum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& z : zs)
+      checksum += lkf.correct(sc, z, R).x.sum();
+    const auto end = std::chrono::steady_clock::now();
+
+    // prevent the compiler from optimizing the corrections away
+    if (std::isnan(checksum))
+      std::cerr << "NaN encountered in the estimate!" << std::endl;
+    const double duration_ns = std::chrono::duration<double, std::nano>(end - start).count() / n_iterations;
+    std::cout << n << "," << p << "," << (diagonal_R ? "diagonal" : "full") << "," << to_string(mode) << "," << duration_ns << std::endl;
+  }
+}
+
+//}
+
+int main()
+{
+  const int n_iterations = 5000;
+
+  std::cout << "n_states,n_measurements,R,mode,correct_ns" << std::endl;
+  for (const bool diagonal_R : {true, false})
+  {
+    benchmark<6, 1>(diagonal_R, n_iterations);
+    benchmark<6, 3>(diagonal_R, n_iterations);
+    benchmark<6, 12>(diagonal_R, n_iterations);
+    benchmark<6, 48>(diagonal_R, n_iterations);
+    benchmark<12, 96>(diagonal_R, n_iterations);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the MedianFilter for various buffer lengths
+
+     Measures the average duration of one MedianFilter::addCheck() call for an increasing buffer length and compares it
+     with the straightforward approach, which copies the buffer and finds the median using std::nth_element after each
+     new value.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib median_filter_benchmark`.
+ */
+
+#include <mrs_lib/median_filter.h>
+#include <boost/circular_buffer.hpp>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+/* nthElementMedian() function //{ */
+
+// the median calculation, which was used by the MedianFilter before the incremental one
+double nthElementMedian(const boost::circular_buffer<double>& buffer, std::vector<double>& buffer_sorted)
+{
+  buffer_sorted.clear();
+  buffer_sorted.insert(std::end(buffer_sorted), std::begin(buffer), std::end(buffer));
+  const bool even_set = buffer_sorted.size() % 2 == 0;
+  const size_t median_pos = buffer_sorted.size()/2;
+  std::nth_element(std::begin(buffer_sorted), std::begin(buffer_sorted)+median_pos, std::end(buffer_sorted));
+  if (even_set)
+    return (buffer_sorted.at(median_pos) + *std::max_element(std::begin(buffer_sorted), std::begin(buffer_sorted)+median_pos))/2.0;
+  else
+    return buffer_sorted.at(median_pos);
+}
+
+//}
+
+/* benchmark() function //{ */
+
+// prints the average duration of adding a value and obtaining the median (in nanoseconds) for both approaches
+void benchmark(const size_t buffer_length, const int n_iterations)
+{
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<double> values(n_iterations);
+  for (auto& value : values)
+    value = d(gen);
+
+  double checksum_filter = 0.0;
+  mrs_lib::MedianFilter filter(buffer_length);
+  const auto start_filter = std::chrono::steady_clock::now();
+  for (const auto value : values)
+  {
+    filter.addCheck(value);
+    checksum_filter += filter.median();
+  }
+  const auto end_filter = std::chrono::steady_clock::now();
+
+  double checksum_nth = 0.0;
+  boost::circular_buffer<double> buffer(buffer_length);
+  std::vector<double> buffer_sorted;
+  buffer_sorted.reserve(buffer_length);
+  const auto start_nth = std::chrono::steady_clock::now();
+  for (const auto value : values)
+  {
+    buffer.push_back(value);
+    checksum_nth += nthElementMedian(buffer, buffer_sorted);
+  }
+  const auto end_nth = std::chrono::steady_clock::now();
+
+  // the checksums also prevent the compiler from optimizing the calculations away
+  if (checksum_filter != checksum_nth)
+    std::cerr << "The median values differ for buffer length " << buffer_length << "!" << std::endl;
+  const double filter_ns = std::chrono::duration<double, std::nano>(end_filter - start_filter).count() / n_iterations;
+  const double nth_ns = std::chrono::duration<double, std::nano>(end_nth - start_nth).count() / n_iterations;
+  std::cout << buffer_length << "," << nth_ns << "," << filter_ns << "," << nth_ns/filter_ns << std::endl;
+}
+
+//}
+
+int main()
+{
+  const std::vector<size_t> buffer_lengths = {5, 10, 31, 100, 301, 1000, 3001, 10000};
+  const int n_iterations = 50000;
+
+  std::cout << "buffer_length,nth_element_ns,incremental_ns,speedup" << std::endl;
+  for (const auto buffer_length : buffer_lengths)
+    benchmark(buffer_length, n_iterations);
+  return 0;
+}
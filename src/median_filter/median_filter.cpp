@@ -5,30 +5,37 @@ namespace mrs_lib
   /* constructor overloads //{ */
 
   MedianFilter::MedianFilter(const size_t buffer_length, const double min_value, const double max_value, const double max_diff)
-    : m_median(std::nullopt),
+    : m_snapshot_seq(0),
+      m_threading_mode(threading_mode_t::locking),
+      m_n_nans(0),
       m_min_valid(min_value),
       m_max_valid(max_value),
       m_max_diff(max_diff)
   {
     m_buffer.set_capacity(buffer_length);
-    m_buffer_sorted.reserve(buffer_length);
+    publishSnapshot();
   }
 
   MedianFilter::MedianFilter()
-    : m_median(std::nullopt),
+    : m_snapshot_seq(0),
+      m_threading_mode(threading_mode_t::locking),
+      m_n_nans(0),
       m_min_valid(0.0),
       m_max_valid(0.0),
       m_max_diff(0.0)
   {
     m_buffer.set_capacity(0);
+    publishSnapshot();
   }
 
   MedianFilter::MedianFilter(const MedianFilter& other)
+    : m_snapshot_seq(0)
   {
     *this = other;
   }
 
   MedianFilter::MedianFilter(MedianFilter&& other)
+    : m_snapshot_seq(0)
   {
     *this = other;
   }
@@ -41,14 +48,17 @@ namespace mrs_lib
     std::scoped_lock lck(other.m_mtx, m_mtx);
   
     m_buffer = other.m_buffer;
-    m_buffer_sorted = other.m_buffer_sorted;
-    m_median = other.m_median;
+    m_lower = other.m_lower;
+    m_upper = other.m_upper;
+    m_n_nans = other.m_n_nans;
   
     // parameters specified by the user
     m_min_valid = other.m_min_valid;
     m_max_valid = other.m_max_valid;
     m_max_diff = other.m_max_diff;
-  
+    m_threading_mode = other.m_threading_mode.load();
+
+    publishSnapshot();
     return *this;
   }
 
@@ -57,14 +67,17 @@ namespace mrs_lib
     std::scoped_lock lck(other.m_mtx, m_mtx);
 
     m_buffer = std::move(other.m_buffer);
-    m_buffer_sorted = std::move(other.m_buffer_sorted);
-    m_median = std::move(other.m_median);
+    m_lower = std::move(other.m_lower);
+    m_upper = std::move(other.m_upper);
+    m_n_nans = other.m_n_nans;
 
     // parameters specified by the user
     m_min_valid = other.m_min_valid;
     m_max_valid = other.m_max_valid;
     m_max_diff = other.m_max_diff;
+    m_threading_mode = other.m_threading_mode.load();
 
+    publishSnapshot();
     return *this;
   }
   //}
@@ -72,20 +85,31 @@ namespace mrs_lib
   /* add() method //{ */
   void MedianFilter::add(const double value)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
+    // a zero-length buffer cannot hold any values
+    if (m_buffer.capacity() == 0)
+      return;
+
+    // if the buffer is full, the oldest value will be evicted - remove it from the sorted halves
+    // and keep its node so that it can be reused for the new value without an allocation
+    std::multiset<double>::node_type node;
+    if (m_buffer.full())
+      node = eraseSorted(m_buffer.front());
+
     // add the value to the buffer
     m_buffer.push_back(value);
-    // reset the cached median value
-    m_median = std::nullopt;
+    // add the value to the sorted halves
+    insertSorted(value, std::move(node));
+    publishSnapshot();
   }
   //}
 
   /* check() method //{ */
   bool MedianFilter::check(const double value)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     // check if all constraints are met
-    const double diff = m_buffer.empty() ? 0.0 : std::abs(median() - value);
+    const double diff = m_buffer.empty() ? 0.0 : std::abs(calculateMedian() - value);
     return value > m_min_valid && value < m_max_valid && diff < m_max_diff;
   }
   //}
@@ -93,7 +117,7 @@ namespace mrs_lib
   /* addCheck() method //{ */
   bool MedianFilter::addCheck(const double value)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     add(value);
     return check(value);
   }
@@ -102,15 +126,26 @@ namespace mrs_lib
   /* clear() method //{ */
   void MedianFilter::clear()
   {
-    std::scoped_lock lck(m_mtx);
-    m_median = std::nullopt;
+    const auto lck = lock();
     m_buffer.clear();
+    m_lower.clear();
+    m_upper.clear();
+    m_n_nans = 0;
+    publishSnapshot();
   }
   //}
 
   /* full() method //{ */
   bool MedianFilter::full() const
   {
+    if (m_threading_mode == threading_mode_t::single_writer)
+    {
+      double median;
+      size_t size, capacity;
+      readSnapshot(median, size, capacity);
+      return size == capacity;
+    }
+
     std::scoped_lock lck(m_mtx);
     return m_buffer.full();
   }
@@ -119,44 +154,46 @@ namespace mrs_lib
   /* median() method //{ */
   double MedianFilter::median() const
   {
-    std::scoped_lock lck(m_mtx);
-    // if the value was already calculated, just return it
-    if (m_median.has_value())
-      return m_median.value();
-  
-    // check if there are even any numbers to calculate the median from
-    if (m_buffer.empty())
+    if (m_threading_mode == threading_mode_t::single_writer)
     {
-      m_median = std::numeric_limits<double>::quiet_NaN();
-      return m_median.value();
+      double median;
+      size_t size, capacity;
+      readSnapshot(median, size, capacity);
+      return median;
     }
-  
-    // remove any elements from buffer_sorted
-    m_buffer_sorted.clear();
-    // copy all elements from the input buffer to buffer_sorted
-    m_buffer_sorted.insert(std::end(m_buffer_sorted), std::begin(m_buffer), std::end(m_buffer));
-    // check for the special case of the median when there is an even number of numbers in the set
-    const bool even_set = m_buffer_sorted.size() % 2 == 0;
-  
-    // if it's an even set, we'll need one more element sorted than for an odd set of numbers
-    const size_t median_pos = even_set ? std::ceil(m_buffer_sorted.size()/2.0) : std::floor(m_buffer_sorted.size()/2.0);
-    // actually sort the elements in buffer_sorted up to the n-th element
-    std::nth_element(std::begin(m_buffer_sorted), std::begin(m_buffer_sorted)+median_pos, std::end(m_buffer_sorted));
-  
+
+    std::scoped_lock lck(m_mtx);
+    return calculateMedian();
+  }
+  //}
+
+  /* calculateMedian() method //{ */
+  double MedianFilter::calculateMedian() const
+  {
+    // check if there are even any numbers to calculate the median from
+    if (m_lower.empty() || m_n_nans > 0)
+      return std::numeric_limits<double>::quiet_NaN();
+
     // special case for a median of an even set of numbers
-    if (even_set)
-      m_median = (m_buffer_sorted.at(median_pos) + m_buffer_sorted.at(median_pos-1))/2.0;
+    if (m_lower.size() == m_upper.size())
+      return (*m_upper.begin() + *m_lower.rbegin())/2.0;
     // the "normal" case with an odd set
     else
-      m_median = m_buffer_sorted.at(median_pos);
-    // return the now-cached value
-    return m_median.value();
+      return *m_lower.rbegin();
   }
   //}
 
   /* initialized() method //{ */
   bool MedianFilter::initialized() const
   {
+    if (m_threading_mode == threading_mode_t::single_writer)
+    {
+      double median;
+      size_t size, capacity;
+      readSnapshot(median, size, capacity);
+      return size > 0;
+    }
+
     std::scoped_lock lck(m_mtx);
     return m_buffer.size() > 0;
   }
@@ -165,20 +202,21 @@ namespace mrs_lib
   /* setBufferLength() method //{ */
   void MedianFilter::setBufferLength(const size_t buffer_length)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     // the median may change if the some values are discarded
-    if (buffer_length < m_buffer.size())
-      m_median = std::nullopt;
-  
+    const bool discarding = buffer_length < m_buffer.size();
+
     m_buffer.set_capacity(buffer_length);
-    m_buffer_sorted.reserve(buffer_length);
+    if (discarding)
+      rebuildSorted();
+    publishSnapshot();
   }
   //}
 
   /* setMinValue() method //{ */
   void MedianFilter::setMinValue(const double min_value)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     m_min_valid = min_value;
   }
   //}
@@ -186,7 +224,7 @@ namespace mrs_lib
   /* setMaxValue() method //{ */
   void MedianFilter::setMaxValue(const double max_value)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     m_max_valid = max_value;
   }
   //}
@@ -194,9 +232,133 @@ namespace mrs_lib
   /* setMaxDifference() method //{ */
   void MedianFilter::setMaxDifference(const double max_diff)
   {
-    std::scoped_lock lck(m_mtx);
+    const auto lck = lock();
     m_max_diff = max_diff;
   }
   //}
 
+  /* setThreadingMode() method //{ */
+  void MedianFilter::setThreadingMode(const threading_mode_t mode)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_threading_mode = mode;
+    publishSnapshot();
+  }
+  //}
+
+  /* getThreadingMode() method //{ */
+  MedianFilter::threading_mode_t MedianFilter::getThreadingMode() const
+  {
+    return m_threading_mode;
+  }
+  //}
+
+  /* insertSorted() method //{ */
+  void MedianFilter::insertSorted(const double value, std::multiset<double>::node_type&& node)
+  {
+    // nans cannot be ordered, so they are only counted
+    if (std::isnan(value))
+    {
+      m_n_nans++;
+      return;
+    }
+
+    auto& half = m_lower.empty() || value <= *m_lower.rbegin() ? m_lower : m_upper;
+    if (node.empty())
+    {
+      half.insert(value);
+    } else
+    {
+      node.value() = value;
+      half.insert(std::move(node));
+    }
+    rebalanceSorted();
+  }
+  //}
+
+  /* eraseSorted() method //{ */
+  std::multiset<double>::node_type MedianFilter::eraseSorted(const double value)
+  {
+    if (std::isnan(value))
+    {
+      m_n_nans--;
+      return {};
+    }
+
+    // all values lower than or equal to the maximum of the lower half are guaranteed to be in the lower half
+    auto& half = value <= *m_lower.rbegin() ? m_lower : m_upper;
+    auto node = half.extract(half.find(value));
+    rebalanceSorted();
+    return node;
+  }
+  //}
+
+  /* rebalanceSorted() method //{ */
+  void MedianFilter::rebalanceSorted()
+  {
+    // the lower half may contain at most one more element than the upper half
+    if (m_lower.size() > m_upper.size() + 1)
+      m_upper.insert(m_lower.extract(std::prev(m_lower.end())));
+    else if (m_upper.size() > m_lower.size())
+      m_lower.insert(m_upper.extract(m_upper.begin()));
+  }
+  //}
+
+  /* rebuildSorted() method //{ */
+  void MedianFilter::rebuildSorted()
+  {
+    m_lower.clear();
+    m_upper.clear();
+    m_n_nans = 0;
+    for (const auto value : m_buffer)
+      insertSorted(value, {});
+  }
+  //}
+
+  /* lock() method //{ */
+  std::unique_lock<std::recursive_mutex> MedianFilter::lock() const
+  {
+    if (m_threading_mode == threading_mode_t::single_writer)
+      return std::unique_lock<std::recursive_mutex>();
+    return std::unique_lock<std::recursive_mutex>(m_mtx);
+  }
+  //}
+
+  /* publishSnapshot() method //{ */
+  void MedianFilter::publishSnapshot()
+  {
+    // the snapshot is only read in the single_writer mode (it is published when switching to it in setThreadingMode())
+    if (m_threading_mode != threading_mode_t::single_writer)
+      return;
+
+    // an odd sequence number signals to the readers that the snapshot is being written
+    const uint64_t seq = m_snapshot_seq.load(std::memory_order_relaxed);
+    m_snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_snapshot_median.store(calculateMedian(), std::memory_order_relaxed);
+    m_snapshot_size.store(m_buffer.size(), std::memory_order_relaxed);
+    m_snapshot_capacity.store(m_buffer.capacity(), std::memory_order_relaxed);
+
+    m_snapshot_seq.store(seq + 2, std::memory_order_release);
+  }
+  //}
+
+  /* readSnapshot() method //{ */
+  void MedianFilter::readSnapshot(double& median, size_t& size, size_t& capacity) const
+  {
+    // retry until the snapshot is read without the writer modifying it in the meantime
+    uint64_t seq_start, seq_end;
+    do
+    {
+      seq_start = m_snapshot_seq.load(std::memory_order_acquire);
+      median = m_snapshot_median.load(std::memory_order_relaxed);
+      size = m_snapshot_size.load(std::memory_order_relaxed);
+      capacity = m_snapshot_capacity.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      seq_end = m_snapshot_seq.load(std::memory_order_relaxed);
+    } while (seq_start % 2 != 0 || seq_start != seq_end);
+  }
+  //}
+
 } // namespace mrs_lib
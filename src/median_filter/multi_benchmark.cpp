@@ -0,0 +1,79 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the MultiMedianFilter against the same number of separate MedianFilter instances
+
+     Measures the average duration of adding one sample of all channels, checking it and obtaining the medians
+     for various numbers of channels and buffer lengths.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib multi_median_filter_benchmark`.
+ */
+
+#include <mrs_lib/median_filter.h>
+#include <mrs_lib/multi_median_filter.h>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+/* benchmark() function //{ */
+
+// measures the average duration of processing one sample of all n_channels channels (in nanoseconds)
+template <bool multi>
+double benchmark(const size_t n_channels, const size_t buffer_length, const int n_iterations)
+{
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<mrs_lib::MultiMedianFilter::values_t> samples(n_iterations);
+  for (auto& sample : samples)
+    sample = mrs_lib::MultiMedianFilter::values_t::NullaryExpr(n_channels, [](){return d(gen);});
+
+  mrs_lib::MultiMedianFilter multi_filter(n_channels, buffer_length, -3.0, 3.0, 2.0);
+  std::vector<mrs_lib::MedianFilter> filters(n_channels, mrs_lib::MedianFilter(buffer_length, -3.0, 3.0, 2.0));
+
+  int n_valid = 0;
+  double checksum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& sample : samples)
+  {
+    if constexpr (multi)
+    {
+      n_valid += multi_filter.addCheck(sample).count();
+      checksum += multi_filter.median().sum();
+    }
+    else
+    {
+      for (size_t ch = 0; ch < n_channels; ch++)
+      {
+        n_valid += filters.at(ch).addCheck(sample(ch));
+        checksum += filters.at(ch).median();
+      }
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  // prevent the compiler from optimizing the calculations away
+  if (n_valid < 0 || std::isnan(checksum))
+    std::cerr << "Invalid result encountered!" << std::endl;
+  return std::chrono::duration<double, std::nano>(end - start).count() / n_iterations;
+}
+
+//}
+
+int main()
+{
+  const int n_iterations = 20000;
+
+  std::cout << "n_channels,buffer_length,separate_ns,multi_ns,speedup" << std::endl;
+  for (const size_t n_channels : {8, 16, 32, 64})
+  {
+    for (const size_t buffer_length : {3, 5, 9, 15, 31, 63})
+    {
+      const double separate_ns = benchmark<false>(n_channels, buffer_length, n_iterations);
+      const double multi_ns = benchmark<true>(n_channels, buffer_length, n_iterations);
+      std::cout << n_channels << "," << buffer_length << "," << separate_ns << "," << multi_ns << "," << separate_ns/multi_ns << std::endl;
+    }
+  }
+  return 0;
+}
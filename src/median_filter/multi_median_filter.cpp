@@ -0,0 +1,373 @@
+#include <mrs_lib/multi_median_filter.h>
+#include <algorithm>
+#include <cassert>
+
+namespace mrs_lib
+{
+  /* constructor overloads //{ */
+
+  MultiMedianFilter::MultiMedianFilter(const size_t n_channels, const size_t buffer_length, const double min_value, const double max_value, const double max_diff)
+    : m_buffer(buffer_length, n_channels),
+      m_next(0),
+      m_size(0),
+      m_n_nans(Eigen::ArrayXi::Zero(n_channels)),
+      m_buffer_sorted(std::min(buffer_length, max_network_length), n_channels),
+      m_row_min(n_channels),
+      m_channels_sorted(buffer_length > max_network_length ? buffer_length : 0, n_channels),
+      m_median(values_t::Constant(n_channels, std::numeric_limits<double>::quiet_NaN())),
+      m_median_valid(true),
+      m_min_valid(values_t::Constant(n_channels, min_value)),
+      m_max_valid(values_t::Constant(n_channels, max_value)),
+      m_max_diff(values_t::Constant(n_channels, max_diff))
+  {
+    generateNetworks();
+  }
+
+  MultiMedianFilter::MultiMedianFilter()
+    : MultiMedianFilter(0, 0, 0.0, 0.0, 0.0)
+  {
+  }
+
+  MultiMedianFilter::MultiMedianFilter(const MultiMedianFilter& other)
+  {
+    *this = other;
+  }
+
+  //}
+
+  /* operator=() method //{ */
+  MultiMedianFilter& MultiMedianFilter::operator=(const MultiMedianFilter& other)
+  {
+    std::scoped_lock lck(other.m_mtx, m_mtx);
+
+    m_buffer = other.m_buffer;
+    m_next = other.m_next;
+    m_size = other.m_size;
+    m_n_nans = other.m_n_nans;
+    m_buffer_sorted = other.m_buffer_sorted;
+    m_row_min = other.m_row_min;
+    m_channels_sorted = other.m_channels_sorted;
+    m_median = other.m_median;
+    m_median_valid = other.m_median_valid;
+    m_networks = other.m_networks;
+
+    // parameters specified by the user
+    m_min_valid = other.m_min_valid;
+    m_max_valid = other.m_max_valid;
+    m_max_diff = other.m_max_diff;
+
+    return *this;
+  }
+  //}
+
+  /* add() method //{ */
+  void MultiMedianFilter::add(const values_t& values)
+  {
+    std::scoped_lock lck(m_mtx);
+    assert(size_t(values.size()) == channels());
+    // a zero-length buffer cannot hold any values
+    if (m_buffer.rows() == 0)
+      return;
+
+    // if the buffer is full, the oldest values are overwritten
+    const bool full = m_size == size_t(m_buffer.rows());
+    // long buffers are kept sorted for each channel
+    if (size_t(m_buffer.rows()) > max_network_length)
+      updateChannelsSorted(values, full);
+
+    if (full)
+      m_n_nans -= m_buffer.row(m_next).array().isNaN().transpose().cast<int>();
+    else
+      m_size++;
+
+    m_buffer.row(m_next) = values.transpose();
+    m_n_nans += values.array().isNaN().cast<int>();
+    m_next = (m_next + 1) % m_buffer.rows();
+    // reset the cached median values
+    m_median_valid = false;
+  }
+  //}
+
+  /* check() method //{ */
+  MultiMedianFilter::mask_t MultiMedianFilter::check(const values_t& values)
+  {
+    std::scoped_lock lck(m_mtx);
+    assert(size_t(values.size()) == channels());
+    if (!m_median_valid)
+      calculateMedian();
+
+    // check if all constraints are met for each channel
+    const Eigen::ArrayXd diff = m_size == 0 ? Eigen::ArrayXd::Zero(values.size()) : Eigen::ArrayXd((m_median - values).array().abs());
+    return values.array() > m_min_valid.array() && values.array() < m_max_valid.array() && diff < m_max_diff.array();
+  }
+  //}
+
+  /* addCheck() method //{ */
+  MultiMedianFilter::mask_t MultiMedianFilter::addCheck(const values_t& values)
+  {
+    std::scoped_lock lck(m_mtx);
+    add(values);
+    return check(values);
+  }
+  //}
+
+  /* clear() method //{ */
+  void MultiMedianFilter::clear()
+  {
+    std::scoped_lock lck(m_mtx);
+    m_next = 0;
+    m_size = 0;
+    m_n_nans.setZero();
+    m_median_valid = false;
+  }
+  //}
+
+  /* full() method //{ */
+  bool MultiMedianFilter::full() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_size == size_t(m_buffer.rows());
+  }
+  //}
+
+  /* median() method //{ */
+  MultiMedianFilter::values_t MultiMedianFilter::median() const
+  {
+    std::scoped_lock lck(m_mtx);
+    // if the values were already calculated, just return them
+    if (!m_median_valid)
+      calculateMedian();
+    return m_median;
+  }
+  //}
+
+  /* initialized() method //{ */
+  bool MultiMedianFilter::initialized() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_buffer.rows() > 0 && m_buffer.cols() > 0;
+  }
+  //}
+
+  /* channels() method //{ */
+  size_t MultiMedianFilter::channels() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_buffer.cols();
+  }
+  //}
+
+  /* setBufferLength() method //{ */
+  void MultiMedianFilter::setBufferLength(const size_t buffer_length)
+  {
+    std::scoped_lock lck(m_mtx);
+    const size_t n_kept = std::min(m_size, buffer_length);
+    buffer_t buffer(buffer_length, m_buffer.cols());
+    // copy the newest values to the new buffer, the oldest one being in the first row
+    for (size_t it = 0; it < n_kept; it++)
+    {
+      const size_t row = (m_next + m_buffer.rows() - n_kept + it) % m_buffer.rows();
+      buffer.row(it) = m_buffer.row(row);
+    }
+
+    m_buffer = std::move(buffer);
+    m_size = n_kept;
+    m_next = buffer_length == 0 ? 0 : n_kept % buffer_length;
+    m_n_nans = m_buffer.topRows(m_size).array().isNaN().cast<int>().colwise().sum().transpose();
+    m_buffer_sorted.resize(std::min(buffer_length, max_network_length), m_buffer.cols());
+    m_median_valid = false;
+    generateNetworks();
+
+    // sort the values of each channel again for long buffers
+    m_channels_sorted.resize(buffer_length > max_network_length ? buffer_length : 0, m_buffer.cols());
+    if (buffer_length > max_network_length)
+    {
+      for (int channel = 0; channel < m_buffer.cols(); channel++)
+      {
+        double* const first = m_channels_sorted.col(channel).data();
+        double* last = first;
+        for (size_t row = 0; row < m_size; row++)
+          if (!std::isnan(m_buffer(row, channel)))
+            *(last++) = m_buffer(row, channel);
+        std::sort(first, last);
+      }
+    }
+  }
+  //}
+
+  /* setMinValue() method //{ */
+  void MultiMedianFilter::setMinValue(const double min_value)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_min_valid.setConstant(min_value);
+  }
+
+  void MultiMedianFilter::setMinValue(const values_t& min_values)
+  {
+    std::scoped_lock lck(m_mtx);
+    assert(size_t(min_values.size()) == channels());
+    m_min_valid = min_values;
+  }
+  //}
+
+  /* setMaxValue() method //{ */
+  void MultiMedianFilter::setMaxValue(const double max_value)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_max_valid.setConstant(max_value);
+  }
+
+  void MultiMedianFilter::setMaxValue(const values_t& max_values)
+  {
+    std::scoped_lock lck(m_mtx);
+    assert(size_t(max_values.size()) == channels());
+    m_max_valid = max_values;
+  }
+  //}
+
+  /* setMaxDifference() method //{ */
+  void MultiMedianFilter::setMaxDifference(const double max_diff)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_max_diff.setConstant(max_diff);
+  }
+
+  void MultiMedianFilter::setMaxDifference(const values_t& max_diffs)
+  {
+    std::scoped_lock lck(m_mtx);
+    assert(size_t(max_diffs.size()) == channels());
+    m_max_diff = max_diffs;
+  }
+  //}
+
+  /* calculateMedian() method //{ */
+  void MultiMedianFilter::calculateMedian() const
+  {
+    const int n = m_size;
+    // check if there are even any numbers to calculate the median from
+    if (n == 0)
+    {
+      m_median.setConstant(std::numeric_limits<double>::quiet_NaN());
+      m_median_valid = true;
+      return;
+    }
+
+    // check for the special case of the median when there is an even number of numbers in the set
+    const bool even_set = n % 2 == 0;
+    const int median_pos = n / 2;
+
+    if (size_t(n) <= max_network_length)
+    {
+      // sort the middle rows of all channels at once by comparing and swapping whole rows
+      // the order of the values in the buffer doesn't matter, so the rows are simply copied
+      auto sorted = m_buffer_sorted.topRows(n);
+      sorted = m_buffer.topRows(n);
+      for (const auto& [a, b] : m_networks.at(n))
+      {
+        m_row_min = sorted.row(a).cwiseMin(sorted.row(b));
+        sorted.row(b) = sorted.row(a).cwiseMax(sorted.row(b));
+        sorted.row(a) = m_row_min;
+      }
+
+      // special case for a median of an even set of numbers
+      if (even_set)
+        m_median = (sorted.row(median_pos) + sorted.row(median_pos - 1)).transpose() / 2.0;
+      // the "normal" case with an odd set
+      else
+        m_median = sorted.row(median_pos).transpose();
+    } else
+    {
+      // the values of each channel are already sorted for long buffers
+      for (int channel = 0; channel < m_buffer.cols(); channel++)
+      {
+        // channels containing a nan only have the rest of the values sorted
+        if (m_n_nans(channel) > 0)
+          continue;
+        const auto sorted = m_channels_sorted.col(channel);
+        if (even_set)
+          m_median(channel) = (sorted(median_pos) + sorted(median_pos - 1)) / 2.0;
+        else
+          m_median(channel) = sorted(median_pos);
+      }
+    }
+
+    // nans cannot be ordered, so the median of a channel containing a nan is also nan
+    m_median = (m_n_nans > 0).select(std::numeric_limits<double>::quiet_NaN(), m_median.array()).matrix();
+    m_median_valid = true;
+  }
+  //}
+
+  /* updateChannelsSorted() method //{ */
+  void MultiMedianFilter::updateChannelsSorted(const values_t& values, const bool full)
+  {
+    for (int channel = 0; channel < m_buffer.cols(); channel++)
+    {
+      // nans are not kept in the sorted values
+      double* const first = m_channels_sorted.col(channel).data();
+      double* last = first + m_size - m_n_nans(channel);
+
+      // remove the value, which will be overwritten, and shift the following values
+      const double old_value = m_buffer(m_next, channel);
+      if (full && !std::isnan(old_value))
+      {
+        double* const it = std::lower_bound(first, last, old_value);
+        std::copy(it + 1, last, it);
+        last--;
+      }
+
+      // insert the new value to its place and shift the following values
+      const double new_value = values(channel);
+      if (!std::isnan(new_value))
+      {
+        double* const it = std::upper_bound(first, last, new_value);
+        std::copy_backward(it, last, last + 1);
+        *it = new_value;
+      }
+    }
+  }
+  //}
+
+  /* generateNetworks() method //{ */
+  void MultiMedianFilter::generateNetworks()
+  {
+    const int max_n = std::min(size_t(m_buffer.rows()), max_network_length);
+    m_networks.clear();
+    m_networks.reserve(max_n + 1);
+    for (int n = 0; n <= max_n; n++)
+      m_networks.push_back(generateMedianNetwork(n));
+  }
+  //}
+
+  /* generateMedianNetwork() method //{ */
+  MultiMedianFilter::network_t MultiMedianFilter::generateMedianNetwork(const int n)
+  {
+    // generate the full Batcher's odd-even merge sorting network for n elements
+    network_t network;
+    for (int p = 1; p < n; p *= 2)
+      for (int k = p; k >= 1; k /= 2)
+        for (int j = k % p; j + k < n; j += 2 * k)
+          for (int i = 0; i < std::min(k, n - j - k); i++)
+            if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+              network.emplace_back(i + j, i + j + k);
+
+    // keep only the comparators, which affect the middle elements (going from the end of the network)
+    std::vector<bool> needed(n, false);
+    if (n > 0)
+      needed.at(n / 2) = true;
+    if (n > 1 && n % 2 == 0)
+      needed.at(n / 2 - 1) = true;
+    network_t pruned;
+    for (auto it = network.rbegin(); it != network.rend(); it++)
+    {
+      if (needed.at(it->first) || needed.at(it->second))
+      {
+        needed.at(it->first) = needed.at(it->second) = true;
+        pruned.push_back(*it);
+      }
+    }
+    std::reverse(std::begin(pruned), std::end(pruned));
+    return pruned;
+  }
+  //}
+
+}  // namespace mrs_lib
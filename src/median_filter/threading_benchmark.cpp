@@ -0,0 +1,91 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the threading modes of the MedianFilter
+
+     A single writer thread adds values to the filter as fast as possible, while a varying number of reader threads
+     continuously read the median. The average duration of one MedianFilter::addCheck() call in the writer thread
+     and the number of reads per microsecond of all the readers are measured for both threading modes.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib median_filter_threading_benchmark`.
+ */
+
+#include <mrs_lib/median_filter.h>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+
+using threading_mode_t = mrs_lib::MedianFilter::threading_mode_t;
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+/* benchmark() function //{ */
+
+// prints the average duration of one addCheck() of the writer (in nanoseconds) and the total reads per microsecond
+void benchmark(const threading_mode_t mode, const int n_readers, const size_t buffer_length, const int n_iterations)
+{
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<double> values(n_iterations);
+  for (auto& value : values)
+    value = d(gen);
+
+  mrs_lib::MedianFilter filter(buffer_length);
+  filter.setThreadingMode(mode);
+
+  std::atomic<bool> done = false;
+  std::vector<uint64_t> n_reads(n_readers, 0);
+  std::vector<double> checksums(n_readers, 0.0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < n_readers; r++)
+  {
+    readers.emplace_back([&, r]()
+    {
+      uint64_t reads = 0;
+      double checksum = 0.0;
+      while (!done.load(std::memory_order_relaxed))
+      {
+        checksum += filter.median();
+        reads++;
+      }
+      n_reads.at(r) = reads;
+      checksums.at(r) = checksum;
+    });
+  }
+
+  int n_valid = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto value : values)
+    n_valid += filter.addCheck(value);
+  const auto end = std::chrono::steady_clock::now();
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  uint64_t total_reads = 0;
+  for (const auto reads : n_reads)
+    total_reads += reads;
+  // prevent the compiler from optimizing the calls away
+  if (n_valid < 0)
+    std::cerr << "Invalid number of valid values!" << std::endl;
+
+  const double duration_us = std::chrono::duration<double, std::micro>(end - start).count();
+  const std::string mode_str = mode == threading_mode_t::locking ? "locking" : "single_writer";
+  std::cout << mode_str << "," << n_readers << "," << buffer_length << "," << 1e3*duration_us/n_iterations << "," << total_reads/duration_us << std::endl;
+}
+
+//}
+
+int main()
+{
+  const int n_iterations = 500000;
+  const size_t buffer_length = 31;
+
+  std::cout << "mode,n_readers,buffer_length,add_check_ns,reads_per_us" << std::endl;
+  for (const int n_readers : {0, 1, 2, 4})
+    for (const auto mode : {threading_mode_t::locking, threading_mode_t::single_writer})
+      benchmark(mode, n_readers, buffer_length, n_iterations);
+  return 0;
+}
@@ -0,0 +1,120 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the NotchFilterBank against a series of NotchFilter objects
+
+     Measures the average duration of filtering one sample of all gyro axes by notches at several harmonics of the motor
+     frequency, using a series of NotchFilter objects for each axis and using a single NotchFilterBank (one sample at a time
+     and in blocks). The duration of re-tuning all the notches is measured as well.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib notch_filter_benchmark`.
+ */
+
+#include <mrs_lib/notch_filter.h>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+using samples_t = mrs_lib::IirSosFilter::samples_t;
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+const double sample_rate = 1000.0;
+const double motor_frequency = 80.0;
+const double bandwidth = 10.0;
+
+/* benchmark() function //{ */
+
+// measures the average duration of filtering one sample of all the channels (in nanoseconds) using the given method
+template <typename method_t>
+double benchmark(const samples_t& input, method_t method)
+{
+  samples_t output(input.rows(), input.cols());
+  const auto start = std::chrono::steady_clock::now();
+  method(input, output);
+  const auto end = std::chrono::steady_clock::now();
+
+  // prevent the compiler from optimizing the filtering away
+  if (std::isnan(output.sum()))
+    std::cerr << "NaN encountered in the output!" << std::endl;
+  return std::chrono::duration<double, std::nano>(end - start).count() / input.cols();
+}
+
+//}
+
+int main()
+{
+  const int n_channels = 3;
+  const int n_samples = 100000;
+  const int block_length = 64;
+  const int n_retunings = 10000;
+
+  std::cout << "n_channels,n_notches,notch_filters_ns,bank_ns,bank_block_ns,retune_ns" << std::endl;
+  for (const int n_notches : {1, 2, 4, 8})
+  {
+    std::vector<double> frequencies, bandwidths;
+    for (int i = 0; i < n_notches; i++)
+    {
+      frequencies.push_back((i + 1) * motor_frequency);
+      bandwidths.push_back(bandwidth);
+    }
+    // prepare the data beforehand so that their generation is not measured
+    const samples_t input = samples_t::NullaryExpr(n_channels, n_samples, [](){return d(gen);});
+
+    // a series of notch filters for each channel, one sample at a time
+    const double notch_filters_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+    {
+      std::vector<std::vector<mrs_lib::NotchFilter>> notches(n_channels);
+      for (auto& channel_notches : notches)
+        for (int i = 0; i < n_notches; i++)
+          channel_notches.emplace_back(sample_rate, frequencies.at(i), bandwidths.at(i));
+
+      for (int k = 0; k < input.cols(); k++)
+      {
+        for (int ch = 0; ch < n_channels; ch++)
+        {
+          double sample = input(ch, k);
+          for (auto& notch : notches.at(ch))
+            sample = notch.iterate(sample);
+          output(ch, k) = sample;
+        }
+      }
+    });
+
+    // a single bank, one sample at a time
+    const double bank_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+    {
+      mrs_lib::NotchFilterBank bank(sample_rate, frequencies, bandwidths, n_channels);
+      for (int k = 0; k < input.cols(); k++)
+        bank.iterate(input.col(k), output.col(k));
+    });
+
+    // a single bank in blocks
+    const double bank_block_ns = benchmark(input, [&](const samples_t& input, samples_t& output)
+    {
+      mrs_lib::NotchFilterBank bank(sample_rate, frequencies, bandwidths, n_channels);
+      for (int k = 0; k < input.cols(); k += block_length)
+      {
+        const int length = std::min(block_length, int(input.cols()) - k);
+        bank.filter(input.middleCols(k, length), output.middleCols(k, length));
+      }
+    });
+
+    // re-tuning all the notches to a slightly different motor frequency
+    mrs_lib::NotchFilterBank bank(sample_rate, frequencies, bandwidths, n_channels);
+    std::vector<double> new_frequencies(n_notches);
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_retunings; it++)
+    {
+      for (int i = 0; i < n_notches; i++)
+        new_frequencies.at(i) = (i + 1) * (motor_frequency + 0.001 * (it % 100));
+      bank.setFrequencies(new_frequencies);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double retune_ns = std::chrono::duration<double, std::nano>(end - start).count() / n_retunings;
+
+    std::cout << n_channels << "," << n_notches << "," << notch_filters_ns << "," << bank_ns << "," << bank_block_ns << "," << retune_ns << std::endl;
+  }
+  return 0;
+}
@@ -115,4 +115,182 @@ double NotchFilter::iterate(double& sample_in) {
 
 //}
 
+// | --------------------- NotchFilterBank --------------------- |
+
+/* NotchFilterBank constructor //{ */
+
+NotchFilterBank::NotchFilterBank(const double& sample_rate, const std::vector<double>& frequencies_in, const std::vector<double>& bandwidths_in,
+                                 const size_t n_channels)
+    : sample_rate_(sample_rate),
+      frequencies_(frequencies_in),
+      bandwidths_(bandwidths_in),
+      filter_(IirSosFilter::sections_t::Zero(frequencies_in.size(), 5), n_channels) {
+
+  if (frequencies_in.size() != bandwidths_in.size() || frequencies_in.size() == 0) {
+    ROS_ERROR("[%s]: Parameters frequencies and bandwidths needs to have the same non-zero length!!", ros::this_node::getName().c_str());
+    ros::shutdown();
+    return;
+  }
+
+  for (size_t i = 0; i < frequencies_.size(); i++) {
+
+    if (!checkNotch(frequencies_[i], bandwidths_[i])) {
+      ros::shutdown();
+      return;
+    }
+
+    filter_.setSection(i, designNotch(sample_rate_, frequencies_[i], bandwidths_[i]));
+  }
+
+  ROS_INFO("[%s]: Notch filter bank with %zu notches initialized!", ros::this_node::getName().c_str(), frequencies_.size());
+}
+
+//}
+
+/* designNotch() //{ */
+
+Eigen::Matrix<double, 1, 5> NotchFilterBank::designNotch(const double& sample_rate, const double& frequency, const double& bandwidth) {
+
+  // the same design as in the NotchFilter constructor for a single notch - the notch is the mean of the input
+  // and an allpass filter, which shifts the phase by -pi at the center frequency and by -pi/2 at the lower edge of the band
+  const double sf2 = sample_rate / 2;
+
+  const Eigen::Vector2d omega((frequency - bandwidth / 2) / sf2 * M_PI, frequency / sf2 * M_PI);
+  const Eigen::Vector2d phi(-M_PI / 2, -M_PI);
+
+  Eigen::Vector2d t_beta;
+  Eigen::Matrix2d Q;
+  for (int i = 0; i < 2; i++) {
+    t_beta[i] = tan((phi[i] + 2 * omega[i]) / 2);
+    for (int k = 0; k < 2; k++) {
+      Q(i, k) = sin((k + 1) * omega[i]) - t_beta[i] * cos((k + 1) * omega[i]);
+    }
+  }
+
+  // coefficients of the allpass denominator [1, h_a[0], h_a[1]], the numerator is reversed
+  const Eigen::Vector2d h_a = Q.inverse() * t_beta;
+
+  Eigen::Matrix<double, 1, 5> coeffs;
+  coeffs << (1.0 + h_a[1]) / 2, h_a[0], (1.0 + h_a[1]) / 2, h_a[0], h_a[1];
+  return coeffs;
+}
+
+//}
+
+/* checkNotch() //{ */
+
+bool NotchFilterBank::checkNotch(const double& frequency, const double& bandwidth) const {
+
+  if (bandwidth <= 0 || frequency - bandwidth / 2 <= 0 || frequency >= sample_rate_ / 2) {
+    ROS_ERROR("[%s]: Notch with frequency %.2f Hz and bandwidth %.2f Hz is invalid for sample rate %.2f Hz!", ros::this_node::getName().c_str(), frequency,
+              bandwidth, sample_rate_);
+    return false;
+  }
+
+  return true;
+}
+
+//}
+
+/* iterate() //{ */
+
+double NotchFilterBank::iterate(const double& sample_in) {
+  return filter_.iterate(sample_in);
+}
+
+void NotchFilterBank::iterate(const Eigen::Ref<const Eigen::VectorXd>& samples_in, Eigen::Ref<Eigen::VectorXd> samples_out) {
+  filter_.iterate(samples_in, samples_out);
+}
+
+//}
+
+/* filter() //{ */
+
+void NotchFilterBank::filter(const double* samples_in, double* samples_out, const size_t n_samples) {
+  filter_.filter(samples_in, samples_out, n_samples);
+}
+
+void NotchFilterBank::filter(const Eigen::Ref<const IirSosFilter::samples_t>& samples_in, Eigen::Ref<IirSosFilter::samples_t> samples_out) {
+  filter_.filter(samples_in, samples_out);
+}
+
+//}
+
+/* setFrequency() //{ */
+
+bool NotchFilterBank::setFrequency(const size_t index, const double& frequency) {
+
+  if (index >= frequencies_.size()) {
+    ROS_ERROR("[%s]: Notch index %zu is out of range, the bank has %zu notches!", ros::this_node::getName().c_str(), index, frequencies_.size());
+    return false;
+  }
+
+  return setFrequency(index, frequency, bandwidths_[index]);
+}
+
+bool NotchFilterBank::setFrequency(const size_t index, const double& frequency, const double& bandwidth) {
+
+  if (index >= frequencies_.size()) {
+    ROS_ERROR("[%s]: Notch index %zu is out of range, the bank has %zu notches!", ros::this_node::getName().c_str(), index, frequencies_.size());
+    return false;
+  }
+
+  if (!checkNotch(frequency, bandwidth)) {
+    return false;
+  }
+
+  frequencies_[index] = frequency;
+  bandwidths_[index]  = bandwidth;
+
+  // only the coefficients are changed, the state is kept so that the output stays continuous
+  filter_.setSection(index, designNotch(sample_rate_, frequency, bandwidth));
+
+  return true;
+}
+
+//}
+
+/* setFrequencies() //{ */
+
+bool NotchFilterBank::setFrequencies(const std::vector<double>& frequencies) {
+
+  if (frequencies.size() != frequencies_.size()) {
+    ROS_ERROR("[%s]: Got %zu frequencies, but the bank has %zu notches!", ros::this_node::getName().c_str(), frequencies.size(), frequencies_.size());
+    return false;
+  }
+
+  bool success = true;
+  for (size_t i = 0; i < frequencies.size(); i++) {
+    success = setFrequency(i, frequencies[i]) && success;
+  }
+
+  return success;
+}
+
+//}
+
+/* reset() //{ */
+
+void NotchFilterBank::reset() {
+  filter_.reset();
+}
+
+//}
+
+/* size() //{ */
+
+size_t NotchFilterBank::size() const {
+  return frequencies_.size();
+}
+
+//}
+
+/* getFrequency() //{ */
+
+double NotchFilterBank::getFrequency(const size_t index) const {
+  return frequencies_.at(index);
+}
+
+//}
+
 }  // namespace mrs_lib
@@ -0,0 +1,72 @@
+/**  \file
+     \brief Benchmark of the overhead of the Profiler routines
+
+     Several threads repeatedly create and end an empty routine, first with the profiler publishing a message at the start
+     and at the end of each routine and then with the profiler aggregating the durations and publishing their summaries.
+     The average overhead of one routine (measured as the duration of one loop iteration) is printed for both modes.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib profiler_benchmark`
+     (a running roscore is necessary).
+ */
+
+#include <mrs_lib/profiler.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+/* benchmark() function //{ */
+
+// returns the average overhead of one routine in nanoseconds
+double benchmark(mrs_lib::Profiler& profiler, const int n_threads, const int n_runs) {
+
+  std::vector<double>      durations(n_threads, 0.0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < n_threads; t++) {
+    threads.emplace_back([&, t]() {
+      const auto start = std::chrono::steady_clock::now();
+
+      for (int it = 0; it < n_runs; it++) {
+        ros::TimerEvent event;
+        event.current_expected = event.current_real = ros::Time::now();
+
+        mrs_lib::Routine routine = profiler.createRoutine("routine_" + std::to_string(it % 30), 100.0, 0.01, event);
+      }
+
+      durations.at(t) = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    });
+  }
+
+  double total = 0.0;
+  for (int t = 0; t < n_threads; t++) {
+    threads.at(t).join();
+    total += durations.at(t);
+  }
+
+  return total / (double(n_threads) * n_runs);
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  ros::init(argc, argv, "profiler_benchmark");
+  ros::NodeHandle nh("~");
+
+  const int n_runs = 100000;
+
+  for (const int n_threads : {1, 4}) {
+
+    mrs_lib::Profiler profiler_publishing(nh, "ProfilerBenchmark", true);
+    const double      publishing = benchmark(profiler_publishing, n_threads, n_runs);
+
+    mrs_lib::Profiler profiler_aggregating(nh, "ProfilerBenchmark", true, 1.0);
+    const double      aggregating = benchmark(profiler_aggregating, n_threads, n_runs);
+
+    std::cout << n_threads << " threads: " << publishing << " ns per routine when publishing, " << aggregating << " ns per routine when aggregating"
+              << std::endl;
+  }
+
+  return 0;
+}
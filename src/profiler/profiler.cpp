@@ -1,8 +1,355 @@
 #include <mrs_lib/profiler.h>
+#include <mrs_lib/timer.h>
+#include <mrs_lib/tracer.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace mrs_lib
 {
 
+// | -------------------- ProfilerHistogram ------------------- |
+
+/* ProfilerHistogram //{ */
+
+// durations of a single routine run by a single thread, written only by that thread and read by the summary thread
+struct ProfilerHistogram
+{
+  // the name of the routine (owned by the aggregator) and the only thread recording into this histogram
+  const std::string* name = nullptr;
+  std::thread::id    thread;
+
+  // durations below 2^sub_bits ns have their own bucket, each longer power of two is split into 2^sub_bits buckets
+  static constexpr int    sub_bits  = 4;
+  static constexpr int    max_bits  = 40;  // durations are clamped to ~18 minutes
+  static constexpr size_t n_buckets = (max_bits - sub_bits + 1) << sub_bits;
+
+  std::array<std::atomic<uint64_t>, n_buckets> buckets{};
+  std::atomic<uint64_t>                        sum_ns{0};
+  std::atomic<uint64_t>                        max_ns{0};
+  std::atomic<uint64_t>                        n_late{0};
+  std::atomic<uint64_t>                        n_overrun{0};
+
+  // values of the counters at the time of the last summary, used only by the summary thread
+  std::array<uint64_t, n_buckets> last_buckets{};
+  uint64_t                        last_sum_ns    = 0;
+  uint64_t                        last_n_late    = 0;
+  uint64_t                        last_n_overrun = 0;
+
+  static size_t bucket(uint64_t ns) {
+
+    ns = std::min(ns, (uint64_t(1) << max_bits) - 1);
+
+    if (ns < (uint64_t(1) << sub_bits)) {
+      return ns;
+    }
+
+    const int      exponent = 63 - __builtin_clzll(ns);
+    const uint64_t sub      = (ns >> (exponent - sub_bits)) & ((uint64_t(1) << sub_bits) - 1);
+
+    return (size_t(exponent - sub_bits + 1) << sub_bits) + sub;
+  }
+
+  // the middle of the range of durations falling into the bucket
+  static uint64_t bucketValue(const size_t index) {
+
+    if (index < (size_t(1) << sub_bits)) {
+      return index;
+    }
+
+    const int      shift = int(index >> sub_bits) - 1;
+    const uint64_t sub   = index & ((size_t(1) << sub_bits) - 1);
+
+    return (((uint64_t(1) << sub_bits) + sub) << shift) + ((uint64_t(1) << shift) >> 1);
+  }
+
+  // there is a single writer, so the counters are updated without the (more expensive) atomic read-modify-write operations
+  void record(const uint64_t ns, const bool late, const bool overrun) {
+
+    std::atomic<uint64_t>& counter = buckets[bucket(ns)];
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_ns.store(sum_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+
+    if (late) {
+      n_late.store(n_late.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    if (overrun) {
+      n_overrun.store(n_overrun.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // the maximum is reset by the summary thread
+    uint64_t max = max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+};
+
+//}
+
+// | ------------------- ProfilerAggregator ------------------- |
+
+/* ProfilerAggregator //{ */
+
+class ProfilerAggregator {
+
+public:
+  ProfilerAggregator(ros::NodeHandle& nh, const std::string& node_name, const double summary_rate);
+  ~ProfilerAggregator();
+
+  /**
+   * @brief returns the histogram of the routine for the calling thread, registers it on the first call
+   */
+  ProfilerHistogram* histogram(const std::string& name, const bool is_periodic, const double expected_rate);
+
+  const std::string& nodeName() const {
+    return node_name_;
+  }
+
+private:
+  struct routine_t
+  {
+    bool                                            is_periodic   = false;
+    double                                          expected_rate = 0;
+    std::vector<std::unique_ptr<ProfilerHistogram>> histograms;
+  };
+
+  // distinguishes the aggregators in the per-thread caches of the histograms
+  static std::atomic<uint64_t> last_id_;
+  const uint64_t               id_;
+
+  std::string    node_name_;
+  ros::Publisher publisher_;
+  ros::Time      last_summary_;
+
+  std::mutex                       mutex_routines_;
+  std::map<std::string, routine_t> routines_;
+
+  // merged histogram of the current summary, used only by the summary thread
+  std::array<uint64_t, ProfilerHistogram::n_buckets> merged_;
+
+  void timerSummary(const ros::TimerEvent& event);
+
+  // has to be destroyed first, so that it doesn't access the other members
+  std::unique_ptr<ThreadTimer> timer_summary_;
+};
+
+std::atomic<uint64_t> ProfilerAggregator::last_id_{0};
+
+// the IDs of the existing aggregators, used to drop the per-thread caches of the destroyed ones
+// (a function-local static, so that it also outlives the aggregators with a static storage duration)
+struct live_ids_t
+{
+  std::mutex                   mutex;
+  std::unordered_set<uint64_t> ids;
+};
+
+static live_ids_t& liveIds() {
+  static live_ids_t live_ids;
+  return live_ids;
+}
+
+ProfilerAggregator::ProfilerAggregator(ros::NodeHandle& nh, const std::string& node_name, const double summary_rate)
+    : id_(last_id_++), node_name_(node_name) {
+
+  {
+    live_ids_t&      live_ids = liveIds();
+    std::scoped_lock lock(live_ids.mutex);
+    live_ids.ids.insert(id_);
+  }
+
+  publisher_    = nh.advertise<diagnostic_msgs::DiagnosticArray>("profiler_summary", 10, false);
+  last_summary_ = ros::Time::now();
+
+  timer_summary_ = std::make_unique<ThreadTimer>(nh, ros::Rate(summary_rate), &ProfilerAggregator::timerSummary, this);
+}
+
+ProfilerAggregator::~ProfilerAggregator() {
+
+  live_ids_t&      live_ids = liveIds();
+  std::scoped_lock lock(live_ids.mutex);
+  live_ids.ids.erase(id_);
+}
+
+//}
+
+/* ProfilerAggregator::histogram() //{ */
+
+ProfilerHistogram* ProfilerAggregator::histogram(const std::string& name, const bool is_periodic, const double expected_rate) {
+
+  // the histograms already used by this thread are found without locking
+  thread_local std::unordered_map<uint64_t, std::unordered_map<std::string, ProfilerHistogram*>> cache;
+
+  auto cache_it = cache.find(id_);
+
+  if (cache_it == cache.end()) {
+
+    // the first use of this aggregator by this thread - drop the caches of the destroyed aggregators first, so that they
+    // do not accumulate and no pointers to their histograms are kept
+    {
+      live_ids_t&      live_ids = liveIds();
+      std::scoped_lock lock(live_ids.mutex);
+      for (auto it = cache.begin(); it != cache.end();) {
+        if (live_ids.ids.count(it->first) == 0) {
+          it = cache.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    cache_it = cache.try_emplace(id_).first;
+  }
+
+  auto& thread_histograms = cache_it->second;
+
+  const auto it = thread_histograms.find(name);
+  if (it != thread_histograms.end()) {
+    return it->second;
+  }
+
+  std::scoped_lock lock(mutex_routines_);
+
+  const auto [routine_it, inserted] = routines_.try_emplace(name);
+  routine_t& routine                = routine_it->second;
+
+  if (inserted) {
+    routine.is_periodic   = is_periodic;
+    routine.expected_rate = expected_rate;
+  }
+
+  ProfilerHistogram* histogram = routine.histograms.emplace_back(std::make_unique<ProfilerHistogram>()).get();
+  histogram->name              = &routine_it->first;
+  histogram->thread            = std::this_thread::get_id();
+
+  thread_histograms.emplace(name, histogram);
+
+  return histogram;
+}
+
+//}
+
+/* ProfilerAggregator::timerSummary() //{ */
+
+void ProfilerAggregator::timerSummary([[maybe_unused]] const ros::TimerEvent& event) {
+
+  const ros::Time now    = ros::Time::now();
+  const double    period = (now - last_summary_).toSec();
+  last_summary_          = now;
+
+  const auto to_string = [](const double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6f", value);
+    return std::string(buffer);
+  };
+
+  diagnostic_msgs::DiagnosticArray msg;
+  msg.header.stamp = now;
+
+  {
+    std::scoped_lock lock(mutex_routines_);
+
+    for (auto& [name, routine] : routines_) {
+
+      merged_.fill(0);
+      uint64_t sum_ns    = 0;
+      uint64_t max_ns    = 0;
+      uint64_t n_late    = 0;
+      uint64_t n_overrun = 0;
+
+      // only the increments since the last summary are summarized
+      for (auto& histogram : routine.histograms) {
+
+        for (size_t it = 0; it < ProfilerHistogram::n_buckets; it++) {
+          const uint64_t count        = histogram->buckets[it].load(std::memory_order_relaxed);
+          merged_[it]                += count - histogram->last_buckets[it];
+          histogram->last_buckets[it] = count;
+        }
+
+        const uint64_t hist_sum_ns    = histogram->sum_ns.load(std::memory_order_relaxed);
+        const uint64_t hist_n_late    = histogram->n_late.load(std::memory_order_relaxed);
+        const uint64_t hist_n_overrun = histogram->n_overrun.load(std::memory_order_relaxed);
+
+        sum_ns    += hist_sum_ns - histogram->last_sum_ns;
+        n_late    += hist_n_late - histogram->last_n_late;
+        n_overrun += hist_n_overrun - histogram->last_n_overrun;
+
+        histogram->last_sum_ns    = hist_sum_ns;
+        histogram->last_n_late    = hist_n_late;
+        histogram->last_n_overrun = hist_n_overrun;
+
+        max_ns = std::max(max_ns, histogram->max_ns.exchange(0, std::memory_order_relaxed));
+      }
+
+      uint64_t count = 0;
+      for (const uint64_t bucket_count : merged_) {
+        count += bucket_count;
+      }
+
+      // percentiles are estimated by the middles of the buckets (within ~3 % of the real value)
+      const std::array<double, 3> quantiles        = {0.5, 0.95, 0.99};
+      std::array<double, 3>       percentiles      = {0, 0, 0};
+      size_t                      percentile_index = 0;
+      uint64_t                    cumulative       = 0;
+      for (size_t it = 0; it < ProfilerHistogram::n_buckets && count > 0 && percentile_index < quantiles.size(); it++) {
+        cumulative += merged_[it];
+        while (percentile_index < quantiles.size() && cumulative >= std::ceil(quantiles[percentile_index] * count)) {
+          const uint64_t value            = ProfilerHistogram::bucketValue(it);
+          percentiles[percentile_index++] = (max_ns > 0 ? std::min(value, max_ns) : value) * 1e-9;
+        }
+      }
+
+      diagnostic_msgs::DiagnosticStatus status;
+      status.name        = node_name_ + ": " + name;
+      status.hardware_id = node_name_;
+
+      if (n_late + n_overrun > 0) {
+        status.level   = diagnostic_msgs::DiagnosticStatus::WARN;
+        status.message = std::to_string(n_late + n_overrun) + " deadline misses";
+      } else {
+        status.level   = diagnostic_msgs::DiagnosticStatus::OK;
+        status.message = "OK";
+      }
+
+      const auto add_value = [&status](const std::string& key, const std::string& value) {
+        diagnostic_msgs::KeyValue key_value;
+        key_value.key   = key;
+        key_value.value = value;
+        status.values.push_back(key_value);
+      };
+
+      add_value("count", std::to_string(count));
+      add_value("rate", to_string(period > 0 ? count / period : 0.0));
+      if (routine.is_periodic) {
+        add_value("expected_rate", to_string(routine.expected_rate));
+      }
+      add_value("mean", to_string(count > 0 ? sum_ns * 1e-9 / count : 0.0));
+      add_value("p50", to_string(percentiles[0]));
+      add_value("p95", to_string(percentiles[1]));
+      add_value("p99", to_string(percentiles[2]));
+      add_value("max", to_string(max_ns * 1e-9));
+      add_value("late", std::to_string(n_late));
+      add_value("overrun", std::to_string(n_overrun));
+
+      msg.status.push_back(status);
+    }
+  }
+
+  try {
+    publisher_.publish(msg);
+  }
+  catch (...) {
+    ROS_ERROR("Exception caught during publishing topic %s.", publisher_.getTopic().c_str());
+  }
+}
+
+//}
+
 // | ------------------------ Profiler ------------------------ |
 
 /* Profiler constructor //{ */
@@ -10,13 +357,15 @@ namespace mrs_lib
 Profiler::Profiler() {
 }
 
-Profiler::Profiler(ros::NodeHandle& nh, std::string _node_name_, bool profiler_enabled) {
+Profiler::Profiler(ros::NodeHandle& nh, std::string _node_name_, bool profiler_enabled, double summary_rate) {
 
   this->nh_                = std::make_shared<ros::NodeHandle>(nh);
   this->_node_name_        = _node_name_;
   this->_profiler_enabled_ = profiler_enabled;
 
-  if (profiler_enabled) {
+  if (profiler_enabled && summary_rate > 0) {
+    aggregator_ = std::make_shared<ProfilerAggregator>(*this->nh_, _node_name_, summary_rate);
+  } else if (profiler_enabled) {
     mutex_publisher_ = std::make_unique<std::mutex>();
     publisher_       = std::make_unique<ros::Publisher>(this->nh_->advertise<mrs_msgs::ProfilerUpdate>("profiler", 100, false));
   }
@@ -32,8 +381,9 @@ Profiler::Profiler(const Profiler& other) {
   this->nh_                = other.nh_;
   this->_node_name_        = other._node_name_;
   this->_profiler_enabled_ = other._profiler_enabled_;
+  this->aggregator_        = other.aggregator_;
 
-  if (this->_profiler_enabled_ && this->is_initialized_) {
+  if (this->_profiler_enabled_ && this->is_initialized_ && !this->aggregator_) {
     mutex_publisher_ = std::make_unique<std::mutex>();
     publisher_       = std::make_unique<ros::Publisher>(this->nh_->advertise<mrs_msgs::ProfilerUpdate>("profiler", 100, false));
   }
@@ -49,8 +399,9 @@ Profiler& Profiler::operator=(const Profiler& other) {
   this->nh_                = other.nh_;
   this->_node_name_        = other._node_name_;
   this->_profiler_enabled_ = other._profiler_enabled_;
+  this->aggregator_        = other.aggregator_;
 
-  if (this->_profiler_enabled_ && this->is_initialized_) {
+  if (this->_profiler_enabled_ && this->is_initialized_ && !this->aggregator_) {
     mutex_publisher_ = std::make_unique<std::mutex>();
     publisher_       = std::make_unique<ros::Publisher>(this->nh_->advertise<mrs_msgs::ProfilerUpdate>("profiler", 100, false));
   }
@@ -64,6 +415,10 @@ Profiler& Profiler::operator=(const Profiler& other) {
 
 Routine Profiler::createRoutine(std::string name, double expected_rate, double threshold, ros::TimerEvent event) {
 
+  if (aggregator_) {
+    return Routine(name, expected_rate, threshold, aggregator_, event);
+  }
+
   return Routine(name, this->_node_name_, expected_rate, threshold, publisher_, mutex_publisher_, _profiler_enabled_, event);
 }
 
@@ -73,6 +428,10 @@ Routine Profiler::createRoutine(std::string name, double expected_rate, double t
 
 Routine Profiler::createRoutine(std::string name) {
 
+  if (aggregator_) {
+    return Routine(name, aggregator_);
+  }
+
   return Routine(name, this->_node_name_, publisher_, mutex_publisher_, _profiler_enabled_);
 }
 
@@ -85,6 +444,8 @@ Routine Profiler::createRoutine(std::string name) {
 Routine::Routine(std::string name, std::string node_name, double expected_rate, double threshold, std::shared_ptr<ros::Publisher> publisher,
                  std::shared_ptr<std::mutex> mutex_publisher, bool profiler_enabled, ros::TimerEvent event) {
 
+  startTrace(name);
+
   if (!profiler_enabled) {
     return;
   }
@@ -140,6 +501,8 @@ Routine::Routine(std::string name, std::string node_name, double expected_rate,
 Routine::Routine(std::string name, std::string node_name, std::shared_ptr<ros::Publisher> publisher, std::shared_ptr<std::mutex> mutex_publisher,
                  bool profiler_enabled) {
 
+  startTrace(name);
+
   if (!profiler_enabled) {
     return;
   }
@@ -180,10 +543,78 @@ Routine::Routine(std::string name, std::string node_name, std::shared_ptr<ros::P
 
 //}
 
+/* Routine constructors for the aggregation mode //{ */
+
+Routine::Routine(const std::string& name, std::shared_ptr<ProfilerAggregator> aggregator) {
+
+  startTrace(name);
+
+  aggregator_ = std::move(aggregator);
+  histogram_  = aggregator_->histogram(name, false, 0);
+
+  aggregated_start_ = std::chrono::steady_clock::now();
+}
+
+Routine::Routine(const std::string& name, double expected_rate, double threshold, std::shared_ptr<ProfilerAggregator> aggregator,
+                 const ros::TimerEvent& event) {
+
+  startTrace(name);
+
+  aggregator_ = std::move(aggregator);
+  histogram_  = aggregator_->histogram(name, true, expected_rate);
+  period_     = expected_rate > 0 ? 1.0 / expected_rate : 0;
+
+  double dt = (event.current_real - event.current_expected).toSec();
+
+  if (dt > threshold) {
+    late_ = true;
+    ROS_WARN_THROTTLE(1.0, "[%s]: routine '%s' was lauched late by %.3f s!", aggregator_->nodeName().c_str(), name.c_str(), dt);
+  }
+
+  aggregated_start_ = std::chrono::steady_clock::now();
+}
+
+//}
+
+/* startTrace() //{ */
+
+void Routine::startTrace(const std::string& name) {
+
+  if (Tracer::enabled()) {
+    trace_name_  = Tracer::intern(name);
+    trace_start_ = std::chrono::steady_clock::now();
+  }
+}
+
+//}
+
 /* end() //{ */
 
 void Routine::end(void) {
 
+  if (trace_name_) {
+    Tracer::complete(trace_name_, "Profiler", trace_start_, std::chrono::steady_clock::now());
+    trace_name_ = nullptr;
+  }
+
+  // in the aggregation mode, the duration is only recorded once
+  if (histogram_) {
+
+    const int64_t duration =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - aggregated_start_).count();
+
+    // the histograms have a single writer, so a routine ending on another thread than it started on records into the
+    // histogram of the ending thread (the routine is already registered, so its type and rate are not needed)
+    if (histogram_->thread != std::this_thread::get_id()) {
+      histogram_ = aggregator_->histogram(*histogram_->name, false, 0);
+    }
+
+    histogram_->record(uint64_t(duration), late_, period_ > 0 && duration * 1e-9 > period_);
+    histogram_ = nullptr;
+
+    return;
+  }
+
   if (!_profiler_enabled_) {
     return;
   }
@@ -0,0 +1,269 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the Repredictor with cached posteriors against a full replay of the history buffer
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib repredictor_benchmark`.
+ */
+
+// Include the Repredictor header
+#include <mrs_lib/repredictor.h>
+// As a model, we'll use a LKF variant
+#include <mrs_lib/lkf.h>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <ros/ros.h>
+
+// Define the LKF we will be using
+namespace mrs_lib
+{
+  const int n_states = 2;
+  const int n_inputs = 1;
+  const int n_measurements = 1;
+
+  using lkf_t = varstepLKF<n_states, n_inputs, n_measurements>;
+  using rep_t = Repredictor<lkf_t>;
+}
+
+/* helper aliases and definitions //{ */
+
+// Some helpful aliases to make writing of types shorter
+using namespace mrs_lib;
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using u_t = lkf_t::u_t;
+using z_t = lkf_t::z_t;
+using R_t = lkf_t::R_t;
+using statecov_t = lkf_t::statecov_t;
+
+static std::mt19937 gen{42};
+static std::normal_distribution<> d{0,1};
+
+A_t generateA(const double dt)
+{
+  A_t A;
+  A << 1, dt,
+       0, 1;
+  return A;
+}
+
+B_t generateB([[maybe_unused]] const double dt)
+{
+  B_t B;
+  B << dt*dt/2.0,
+       dt;
+  return B;
+}
+
+//}
+
+/* allocation counting //{ */
+
+// counts all heap allocations in the process to check that the insertion is allocation-free
+// (the C allocation functions are replaced, so that the allocations made by Eigen, which uses malloc directly,
+// are counted as well as those made by operator new - these are forwarded to the glibc allocator)
+static std::atomic<size_t> n_allocations = 0;
+
+extern "C"
+{
+  void* __libc_malloc(size_t size) noexcept;
+  void* __libc_calloc(size_t n, size_t size) noexcept;
+  void* __libc_realloc(void* ptr, size_t size) noexcept;
+
+  void* malloc(size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t n, size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_calloc(n, size);
+  }
+
+  void* realloc(void* ptr, size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_realloc(ptr, size);
+  }
+}
+
+//}
+
+/* class FullReplayRepredictor //{ */
+
+// reimplements the original reprediction, which replays the whole history buffer on each request
+class FullReplayRepredictor : public rep_t
+{
+public:
+  using rep_t::Repredictor;
+
+  statecov_t predictToFullReplay(const ros::Time& to_stamp)
+  {
+    auto hist_it = std::begin(m_history);
+    auto cur_stamp = hist_it->stamp;
+    auto cur_sc = m_sc;
+    bool first = true;
+    do
+    {
+      cur_sc.stamp = hist_it->stamp;
+      // the first history point is already included in m_sc
+      if (hist_it->is_measurement && !first)
+        cur_sc = correctFrom(cur_sc, *hist_it);
+      first = false;
+
+      ros::Time next_stamp = to_stamp;
+      if ((hist_it + 1) != std::end(m_history) && (hist_it + 1)->stamp <= to_stamp)
+        next_stamp = (hist_it + 1)->stamp;
+
+      cur_sc = predictFrom(cur_sc, *hist_it, cur_stamp, next_stamp);
+      cur_stamp = next_stamp;
+      hist_it++;
+    } while (hist_it != std::end(m_history) && hist_it->stamp <= to_stamp);
+    cur_sc.stamp = to_stamp;
+    return cur_sc;
+  }
+};
+
+//}
+
+/* benchmark() function //{ */
+
+// fills the Repredictor with hist_len elements and then measures the average duration of one update+prediction
+// delayed_ratio is the ratio of measurements, which arrive out-of-order with a random delay
+template <bool full_replay>
+double benchmark(const unsigned hist_len, const double delayed_ratio, const int n_iterations)
+{
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Zero();
+  const ros::Time t0 = ros::Time(1);
+  const H_t H( (H_t() << 1, 0).finished() );
+  const Q_t Q = 0.1*Q_t::Identity();
+  const R_t R = 0.1*R_t::Identity();
+  const double dt = 0.01;
+  std::uniform_real_distribution<> ud(0.0, 1.0);
+
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  FullReplayRepredictor rep(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  ros::Time stamp = t0;
+  double checksum = 0.0;
+  const auto add_and_predict = [&]()
+  {
+    stamp += ros::Duration(dt);
+    // delay the out-of-order measurements by up to a quarter of the history buffer (but not before the first element)
+    const double max_delay = std::min(hist_len*dt/4.0, (stamp-t0).toSec()/2.0);
+    const double delay = ud(gen) < delayed_ratio ? ud(gen)*max_delay : 0.0;
+    rep.addMeasurement(z_t(d(gen)), R, stamp - ros::Duration(delay));
+    if constexpr (full_replay)
+      checksum += rep.predictToFullReplay(stamp).x.x();
+    else
+      checksum += rep.predictTo(stamp).x.x();
+  };
+
+  // fill the history buffer first
+  for (unsigned it = 0; it < hist_len; it++)
+    add_and_predict();
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_iterations; it++)
+    add_and_predict();
+  const auto end = std::chrono::steady_clock::now();
+
+  // prevent the compiler from optimizing the predictions away
+  if (std::isnan(checksum))
+    std::cerr << "NaN encountered in the estimate!" << std::endl;
+  return std::chrono::duration<double, std::micro>(end - start).count() / n_iterations;
+}
+
+//}
+
+/* benchmark_insertion() function //{ */
+
+// measures the average duration and number of heap allocations of one insertion to a full history buffer
+// (alternating measurements with a non-default model and system inputs), without any predictions
+void benchmark_insertion(const unsigned hist_len, const int n_iterations, double& duration_ns, double& allocations)
+{
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Zero();
+  const ros::Time t0 = ros::Time(1);
+  const H_t H( (H_t() << 1, 0).finished() );
+  const Q_t Q = 0.1*Q_t::Identity();
+  const R_t R = 0.1*R_t::Identity();
+  const double dt = 0.01;
+
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  auto lkf_meas = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  // prepare the data beforehand so that their generation is not measured
+  std::vector<z_t> zs(n_iterations);
+  std::vector<u_t> us(n_iterations);
+  for (int it = 0; it < n_iterations; it++)
+  {
+    zs.at(it) = z_t(d(gen));
+    us.at(it) = u_t(d(gen));
+  }
+
+  ros::Time stamp = t0;
+  const auto add = [&](const int it)
+  {
+    stamp += ros::Duration(dt);
+    if (it % 2)
+      rep.addMeasurement(zs.at(it), R, stamp, lkf_meas);
+    else
+      rep.addInputChange(us.at(it), stamp);
+  };
+
+  // fill the history buffer first
+  for (unsigned it = 0; it < hist_len; it++)
+    add(it % n_iterations);
+  rep.predictTo(stamp);
+
+  const size_t allocations_start = n_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_iterations; it++)
+    add(it);
+  const auto end = std::chrono::steady_clock::now();
+  const size_t allocations_end = n_allocations;
+
+  duration_ns = std::chrono::duration<double, std::nano>(end - start).count() / n_iterations;
+  allocations = double(allocations_end - allocations_start) / n_iterations;
+}
+
+//}
+
+int main()
+{
+  const std::vector<unsigned> hist_lens = {10, 100, 500, 1000, 5000};
+  const std::vector<double> delayed_ratios = {0.0, 0.1, 0.5};
+  const int n_iterations = 2000;
+
+  std::cout << "hist_len,delayed_ratio,full_replay_us,cached_us,speedup" << std::endl;
+  for (const auto hist_len : hist_lens)
+  {
+    for (const auto delayed_ratio : delayed_ratios)
+    {
+      const double full_us = benchmark<true>(hist_len, delayed_ratio, n_iterations);
+      const double cached_us = benchmark<false>(hist_len, delayed_ratio, n_iterations);
+      std::cout << hist_len << "," << delayed_ratio << "," << full_us << "," << cached_us << "," << full_us/cached_us << std::endl;
+    }
+  }
+
+  std::cout << std::endl << "hist_len,insertion_ns,allocations_per_insertion" << std::endl;
+  for (const auto hist_len : hist_lens)
+  {
+    double duration_ns, allocations;
+    benchmark_insertion(hist_len, 10*n_iterations, duration_ns, allocations);
+    std::cout << hist_len << "," << duration_ns << "," << allocations << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,262 @@
+// clang: MatousFormat
+/**  \file
+     \brief Latency benchmark suite of the Repredictor for detecting performance regressions
+
+     Measures latency percentiles of the addMeasurement(), addInputChange() and predictTo() methods of the Repredictor
+     with the LKF and UKF models for a range of history buffer lengths, state dimensions, out-of-order delay distributions
+     and measurement-to-input ratios. The results are printed to the standard output in the CSV format (one line per
+     scenario and method).
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib repredictor_benchmark_suite [n_iterations]`.
+ */
+
+#include <mrs_lib/repredictor.h>
+#include <mrs_lib/lkf.h>
+#include <mrs_lib/ukf.h>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <ros/ros.h>
+
+/* helper definitions //{ */
+
+static std::mt19937 gen{42};
+
+// distribution of the delays of the measurements (making them out-of-order)
+enum class delay_dist_t
+{
+  none,         // all measurements arrive in-order
+  uniform,      // delays are uniformly distributed up to a quarter of the history buffer duration
+  exponential,  // mostly short delays with a long tail up to a quarter of the history buffer duration
+};
+
+std::string to_string(const delay_dist_t dist)
+{
+  switch (dist)
+  {
+    case delay_dist_t::none:
+      return "none";
+    case delay_dist_t::uniform:
+      return "uniform";
+    case delay_dist_t::exponential:
+      return "exponential";
+  }
+  return "unknown";
+}
+
+struct scenario_t
+{
+  std::string model_name;
+  int n_states;
+  unsigned hist_len;
+  delay_dist_t delay_dist;
+  double meas_ratio;
+};
+
+// latency statistics of one method in one scenario
+void printStats(const scenario_t& scenario, const std::string& method, std::vector<double>& durations_ns)
+{
+  if (durations_ns.empty())
+    return;
+  std::sort(std::begin(durations_ns), std::end(durations_ns));
+  const auto percentile = [&durations_ns](const double perc)
+  {
+    const size_t idx = std::min(durations_ns.size() - 1, size_t(perc * durations_ns.size()));
+    return durations_ns.at(idx);
+  };
+  double sum = 0.0;
+  for (const auto dur : durations_ns)
+    sum += dur;
+
+  std::cout << scenario.model_name << "," << scenario.n_states << "," << scenario.hist_len << "," << to_string(scenario.delay_dist) << ","
+            << scenario.meas_ratio << "," << method << "," << durations_ns.size() << "," << sum / durations_ns.size() << "," << percentile(0.5) << ","
+            << percentile(0.9) << "," << percentile(0.99) << "," << durations_ns.back() << std::endl;
+}
+
+//}
+
+/* model generation //{ */
+
+// a constant-velocity model with n_axes independent axes (the state contains positions followed by velocities),
+// the input is acceleration and the measurement is position in each axis
+template <int n_axes>
+struct cv_model_t
+{
+  static constexpr int n = 2 * n_axes;
+  static constexpr int m = n_axes;
+  static constexpr int p = n_axes;
+
+  using lkf_t = mrs_lib::varstepLKF<n, m, p>;
+  using ukf_t = mrs_lib::UKF<n, m, p>;
+
+  using A_t = typename lkf_t::A_t;
+  using B_t = typename lkf_t::B_t;
+  using H_t = typename lkf_t::H_t;
+  using x_t = typename lkf_t::x_t;
+  using u_t = typename lkf_t::u_t;
+  using z_t = typename lkf_t::z_t;
+
+  static A_t generateA(const double dt)
+  {
+    A_t A = A_t::Identity();
+    A.template topRightCorner<n_axes, n_axes>().diagonal().setConstant(dt);
+    return A;
+  }
+
+  static B_t generateB(const double dt)
+  {
+    B_t B = B_t::Zero();
+    B.template topRows<n_axes>().diagonal().setConstant(dt * dt / 2.0);
+    B.template bottomRows<n_axes>().diagonal().setConstant(dt);
+    return B;
+  }
+
+  static H_t generateH()
+  {
+    H_t H = H_t::Zero();
+    H.template leftCols<n_axes>().setIdentity();
+    return H;
+  }
+
+  static std::shared_ptr<lkf_t> createLKF()
+  {
+    return std::make_shared<lkf_t>(generateA, generateB, generateH());
+  }
+
+  static std::shared_ptr<ukf_t> createUKF()
+  {
+    const auto transition = [](const x_t& x, const u_t& u, const double dt) -> x_t { return generateA(dt) * x + generateB(dt) * u; };
+    const auto observation = [](const x_t& x) -> z_t { return x.template head<n_axes>(); };
+    return std::make_shared<ukf_t>(transition, observation);
+  }
+};
+
+//}
+
+/* runScenario() function //{ */
+
+template <typename Model>
+void runScenario(const scenario_t& scenario, const std::shared_ptr<Model>& model, const int n_iterations)
+{
+  using rep_t = mrs_lib::Repredictor<Model>;
+  using x_t = typename Model::x_t;
+  using P_t = typename Model::P_t;
+  using u_t = typename Model::u_t;
+  using Q_t = typename Model::Q_t;
+  using z_t = typename Model::z_t;
+  using R_t = typename Model::R_t;
+
+  const ros::Time t0 = ros::Time(1);
+  const Q_t Q = 0.1 * Q_t::Identity();
+  const R_t R = 0.1 * R_t::Identity();
+  const double dt = 0.01;
+  const double max_delay = scenario.hist_len * dt / 4.0;
+  rep_t rep(x_t::Zero(), 10.0 * P_t::Identity(), u_t::Zero(), Q, t0, model, scenario.hist_len);
+
+  std::uniform_real_distribution<> ud(0.0, 1.0);
+  std::exponential_distribution<> ed(10.0 / max_delay);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  std::vector<double> meas_durations;
+  std::vector<double> input_durations;
+  std::vector<double> predict_durations;
+  meas_durations.reserve(n_iterations);
+  input_durations.reserve(n_iterations);
+  predict_durations.reserve(n_iterations);
+
+  ros::Time stamp = t0;
+  const auto step = [&](const bool record)
+  {
+    using clock = std::chrono::steady_clock;
+    stamp += ros::Duration(dt);
+
+    if (ud(gen) < scenario.meas_ratio)
+    {
+      double delay = 0.0;
+      switch (scenario.delay_dist)
+      {
+        case delay_dist_t::none:
+          break;
+        case delay_dist_t::uniform:
+          delay = ud(gen) * max_delay;
+          break;
+        case delay_dist_t::exponential:
+          delay = std::min(ed(gen), max_delay);
+          break;
+      }
+      // do not delay the measurements before the start
+      delay = std::min(delay, (stamp - t0).toSec() / 2.0);
+      const z_t z = z_t::NullaryExpr([&nd](const int) { return nd(gen); });
+      const auto start = clock::now();
+      rep.addMeasurement(z, R, stamp - ros::Duration(delay));
+      const auto end = clock::now();
+      if (record)
+        meas_durations.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    } else
+    {
+      const u_t u = u_t::NullaryExpr([&nd](const int) { return nd(gen); });
+      const auto start = clock::now();
+      rep.addInputChange(u, stamp);
+      const auto end = clock::now();
+      if (record)
+        input_durations.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    const auto start = clock::now();
+    const auto sc = rep.predictTo(stamp);
+    const auto end = clock::now();
+    if (record)
+      predict_durations.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    if (!sc.x.allFinite())
+      std::cerr << "Non-finite estimate encountered!" << std::endl;
+  };
+
+  // fill the history buffer first so that the steady state is measured
+  for (unsigned it = 0; it < scenario.hist_len; it++)
+    step(false);
+  for (int it = 0; it < n_iterations; it++)
+    step(true);
+
+  printStats(scenario, "addMeasurement", meas_durations);
+  printStats(scenario, "addInputChange", input_durations);
+  printStats(scenario, "predictTo", predict_durations);
+}
+
+//}
+
+/* runAll() function //{ */
+
+template <int n_axes>
+void runAll(const int n_iterations)
+{
+  const std::vector<unsigned> hist_lens = {10, 100, 1000, 5000};
+  const std::vector<delay_dist_t> delay_dists = {delay_dist_t::none, delay_dist_t::uniform, delay_dist_t::exponential};
+  const std::vector<double> meas_ratios = {0.5, 0.8};
+
+  for (const auto hist_len : hist_lens)
+  {
+    for (const auto delay_dist : delay_dists)
+    {
+      for (const auto meas_ratio : meas_ratios)
+      {
+        runScenario({"LKF", 2 * n_axes, hist_len, delay_dist, meas_ratio}, cv_model_t<n_axes>::createLKF(), n_iterations);
+        runScenario({"UKF", 2 * n_axes, hist_len, delay_dist, meas_ratio}, cv_model_t<n_axes>::createUKF(), n_iterations);
+      }
+    }
+  }
+}
+
+//}
+
+int main(int argc, char** argv)
+{
+  const int n_iterations = argc > 1 ? std::stoi(argv[1]) : 1000;
+
+  std::cout << "model,n_states,hist_len,delay_dist,meas_ratio,method,count,mean_ns,p50_ns,p90_ns,p99_ns,max_ns" << std::endl;
+  runAll<1>(n_iterations);
+  runAll<3>(n_iterations);
+  runAll<6>(n_iterations);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/**  \file
+     \brief Benchmark of the overhead of the ScopeTimer and FastScopeTimer checkpoints
+
+     A number of timers with several checkpoints each are created and destroyed in a loop by one or more threads.
+     The printing is throttled, so that the timers are printed only once. The average duration of one checkpoint
+     and of the construction and destruction of one timer are printed in nanoseconds.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib scope_timer_benchmark`
+     (a running roscore is necessary).
+ */
+
+#include <mrs_lib/scope_timer.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using steady_clock = std::chrono::steady_clock;
+
+const int           n_checkpoints = 8;
+const ros::Duration throttle_period(1000.0);
+
+/* run() function //{ */
+
+// returns the total duration of the checkpoints and of the rest of the timers in nanoseconds
+template <typename TimerType>
+std::pair<double, double> run(const int n_timers) {
+
+  double checkpoints_ns = 0.0;
+  double total_ns       = 0.0;
+
+  for (int it = 0; it < n_timers; it++) {
+    const auto start = steady_clock::now();
+    {
+      TimerType timer("benchmark_timer_label", throttle_period);
+
+      const auto checkpoints_start = steady_clock::now();
+      timer.checkpoint("checkpoint_after_preprocessing");
+      timer.checkpoint("checkpoint_after_prediction");
+      timer.checkpoint("checkpoint_after_correction");
+      timer.checkpoint("checkpoint_after_outlier_rejection");
+      timer.checkpoint("checkpoint_after_fusion");
+      timer.checkpoint("checkpoint_after_control");
+      timer.checkpoint("checkpoint_after_saturation");
+      timer.checkpoint("checkpoint_after_publishing");
+      checkpoints_ns += std::chrono::duration<double, std::nano>(steady_clock::now() - checkpoints_start).count();
+    }
+    total_ns += std::chrono::duration<double, std::nano>(steady_clock::now() - start).count();
+  }
+
+  return {checkpoints_ns, total_ns};
+}
+
+//}
+
+/* benchmark() function //{ */
+
+template <typename TimerType>
+void benchmark(const std::string& name, const int n_threads, const int n_timers) {
+
+  std::vector<std::pair<double, double>> results(n_threads);
+  std::vector<std::thread>               threads;
+
+  for (int t = 0; t < n_threads; t++) {
+    threads.emplace_back([&results, t, n_timers]() { results.at(t) = run<TimerType>(n_timers); });
+  }
+
+  double checkpoints_ns = 0.0;
+  double total_ns       = 0.0;
+  for (int t = 0; t < n_threads; t++) {
+    threads.at(t).join();
+    checkpoints_ns += results.at(t).first;
+    total_ns += results.at(t).second;
+  }
+
+  const double n_total = double(n_threads) * n_timers;
+  std::cout << name << ", " << n_threads << " threads: " << checkpoints_ns / (n_total * n_checkpoints) << " ns per checkpoint, "
+            << (total_ns - checkpoints_ns) / n_total << " ns per timer without the checkpoints" << std::endl;
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  ros::init(argc, argv, "scope_timer_benchmark");
+  ros::NodeHandle nh("~");
+
+  const int n_timers = 100000;
+
+  for (const int n_threads : {1, 4}) {
+    benchmark<mrs_lib::ScopeTimer>("ScopeTimer", n_threads, n_timers);
+    benchmark<mrs_lib::FastScopeTimer>("FastScopeTimer", n_threads, n_timers);
+  }
+
+  return 0;
+}
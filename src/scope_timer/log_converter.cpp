@@ -0,0 +1,23 @@
+/**  \file
+     \brief Converts a binary log of the ScopeTimerLogger to the CSV format
+
+     Usage: `rosrun mrs_lib scope_timer_log_converter <binary_log> <csv_log> [precision]`
+ */
+
+#include <mrs_lib/scope_timer.h>
+
+int main(int argc, char** argv) {
+
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " <binary_log> <csv_log> [precision]" << std::endl;
+    return 1;
+  }
+
+  const int precision = argc == 4 ? std::stoi(argv[3]) : 10;
+
+  if (!mrs_lib::ScopeTimerLogger::convertToCsv(argv[1], argv[2], precision)) {
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,13 +1,120 @@
 #include <mrs_lib/scope_timer.h>
+#include <mrs_lib/tracer.h>
+#include <array>
+#include <cstring>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace mrs_lib
 {
 
 // | --------------------- ScopeTimerLogger --------------------- |
 
+/*//{ binary log format */
+
+// The binary log starts with the magic bytes and continues with a sequence of entries, each starting with its kind:
+//  * label:   uint32_t kind (0), uint32_t id, uint32_t length, char[length] label
+//  * records: uint32_t kind (1), uint32_t count, record_t[count] records
+// All labels are written before the first records that refer to them.
+
+static constexpr char     binary_magic[8]     = {'M', 'R', 'S', 'S', 'T', 'L', 'B', '1'};
+static constexpr uint32_t binary_kind_label   = 0;
+static constexpr uint32_t binary_kind_records = 1;
+
+struct ScopeTimerLogger::record_t
+{
+  uint32_t scope;
+  uint32_t label_from;
+  uint32_t label_to;
+  uint32_t reserved;
+  int64_t  time_start;  // steady clock ticks since its epoch
+  int64_t  time_end;
+};
+
+// single-producer single-consumer ring buffer of the records of one thread
+struct ScopeTimerLogger::ring_t
+{
+  static constexpr size_t capacity = 1 << 12;
+
+  std::array<record_t, capacity> records;
+
+  alignas(64) std::atomic<size_t> head{0};  // written by the logging thread
+  alignas(64) std::atomic<size_t> tail{0};  // written by the writer thread
+  std::atomic<uint64_t> n_dropped{0};
+};
+
+struct ScopeTimerLogger::thread_cache_t
+{
+  ring_t*                                   ring = nullptr;
+  std::unordered_map<std::string, uint32_t> label_ids;
+  // the address may be reused for another label, so the text is kept to validate the cached ID
+  std::unordered_map<const char*, std::pair<uint32_t, std::string>> pointer_ids;
+};
+
+// the flush period of the binary log
+static constexpr std::chrono::milliseconds binary_flush_period(100);
+
+/*//}*/
+
+/*//{ writeCsvLine() */
+// the same formatting is used for logging in the CSV mode and for converting the binary logs
+static void writeCsvLine(std::ostream& os, const std::string& scope, const std::string& label_from, const std::string& label_to,
+                         const ScopeTimerLogger::chrono_tp& time_start, const ScopeTimerLogger::chrono_tp& time_end) {
+
+  const std::chrono::duration<double> duration_start = std::chrono::duration_cast<std::chrono::duration<double>>(time_start.time_since_epoch());
+  const std::chrono::duration<double> duration_end   = std::chrono::duration_cast<std::chrono::duration<double>>(time_end.time_since_epoch());
+  const std::chrono::duration<double> duration_total = std::chrono::duration_cast<std::chrono::duration<double>>(time_end - time_start);
+
+  os << scope.c_str() << "," << label_from.c_str() << "," << label_to.c_str() << "," << duration_start.count() << "," << duration_end.count() << ","
+     << duration_total.count() << '\n';
+}
+/*//}*/
+
+/*//{ writeAll() */
+// writes the whole buffer to the file descriptor
+static bool writeAll(const int fd, const char* data, size_t size) {
+
+  while (size > 0) {
+    const ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+
+  return true;
+}
+/*//}*/
+
+std::atomic<uint64_t> ScopeTimerLogger::last_id_{0};
+
+// the IDs of the existing loggers, used to drop the per-thread caches of the destroyed ones
+// (a function-local static, so that it also outlives the loggers with a static storage duration)
+struct live_ids_t
+{
+  std::mutex                   mutex;
+  std::unordered_set<uint64_t> ids;
+};
+
+static live_ids_t& liveIds() {
+  static live_ids_t live_ids;
+  return live_ids;
+}
+
 /*//{ ScopeTimerLogger constructor */
-ScopeTimerLogger::ScopeTimerLogger(const std::string& logfile, const bool enable_logging, const int log_precision)
-    : _logging_enabled_(enable_logging), _log_filepath_(logfile) {
+ScopeTimerLogger::ScopeTimerLogger(const std::string& logfile, const bool enable_logging, const int log_precision, const bool binary)
+    : _logging_enabled_(enable_logging), _binary_(binary), _log_filepath_(logfile), id_(last_id_++) {
+
+  {
+    live_ids_t&      live_ids = liveIds();
+    std::scoped_lock lock(live_ids.mutex);
+    live_ids.ids.insert(id_);
+  }
 
   if (!_logging_enabled_) {
     return;
@@ -18,6 +125,27 @@ ScopeTimerLogger::ScopeTimerLogger(const std::string& logfile, const bool enable
   }
   _should_log_ = true;
 
+  if (_binary_) {
+
+    log_fd_ = ::open(logfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+    if (log_fd_ < 0 || !writeAll(log_fd_, binary_magic, sizeof(binary_magic))) {
+      _logging_enabled_ = false;
+      ROS_ERROR("[%s]: Scope timer failed to create log file with path (%s): %s. Skipping logging.", ros::this_node::getName().c_str(), logfile.c_str(),
+                strerror(errno));
+      if (log_fd_ >= 0) {
+        ::close(log_fd_);
+        log_fd_ = -1;
+      }
+      return;
+    }
+
+    writer_thread_ = std::thread(&ScopeTimerLogger::writerThread, this);
+
+    ROS_INFO("[%s]: Scope timer logger path: %s (binary).", ros::this_node::getName().c_str(), logfile.c_str());
+    return;
+  }
+
   try {
     std::scoped_lock lock(_mutex_logstream_);
 
@@ -44,7 +172,26 @@ ScopeTimerLogger::ScopeTimerLogger(const std::string& logfile, const bool enable
 
 /*//{ ScopeTimerLogger destructor */
 ScopeTimerLogger::~ScopeTimerLogger() {
-  if (_logging_enabled_) {
+
+  {
+    live_ids_t&      live_ids = liveIds();
+    std::scoped_lock lock(live_ids.mutex);
+    live_ids.ids.erase(id_);
+  }
+
+  if (writer_thread_.joinable()) {
+    {
+      std::scoped_lock lock(_mutex_writer_);
+      writer_stop_ = true;
+    }
+    writer_cv_.notify_all();
+    writer_thread_.join();
+  }
+
+  if (log_fd_ >= 0) {
+    ROS_DEBUG("[%s]: ScopeTimerLogger: closing binary log.", ros::this_node::getName().c_str());
+    ::close(log_fd_);
+  } else if (_logging_enabled_) {
     ROS_DEBUG("[%s]: ScopeTimerLogger: closing logstream.", ros::this_node::getName().c_str());
     _logstream_.close();
   }
@@ -63,21 +210,298 @@ void ScopeTimerLogger::log(const std::string& scope, const std::string& label_fr
     return;
   }
 
-  const std::chrono::duration<double> duration_start = std::chrono::duration_cast<std::chrono::duration<double>>(time_start.time_since_epoch());
-  const std::chrono::duration<double> duration_end   = std::chrono::duration_cast<std::chrono::duration<double>>(time_end.time_since_epoch());
-  const std::chrono::duration<double> duration_total = std::chrono::duration_cast<std::chrono::duration<double>>(time_end - time_start);
+  if (_binary_) {
+    // the labels already used by this thread are interned without locking
+    thread_cache_t& cache     = threadCache();
+    const auto      intern_id = [this, &cache](const std::string& label) {
+      const auto it = cache.label_ids.find(label);
+      if (it != cache.label_ids.end()) {
+        return it->second;
+      }
+      const uint32_t id = internLabel(label);
+      cache.label_ids.emplace(label, id);
+      return id;
+    };
+    log(intern_id(scope), intern_id(label_from), intern_id(label_to), time_start, time_end);
+    return;
+  }
 
   {
     std::scoped_lock lock(_mutex_logstream_);
-    _logstream_ << scope.c_str() << "," << label_from.c_str() << "," << label_to.c_str() << "," << duration_start.count() << "," << duration_end.count() << ","
-                << duration_total.count() << std::endl;
+    writeCsvLine(_logstream_, scope, label_from, label_to, time_start, time_end);
+    _logstream_.flush();
+  }
+}
+
+void ScopeTimerLogger::log(const uint32_t scope, const uint32_t label_from, const uint32_t label_to, const chrono_tp& time_start, const chrono_tp& time_end) {
+
+  if (!_logging_enabled_) {
+    return;
+  }
+
+  if (!_binary_) {
+    std::string scope_str, label_from_str, label_to_str;
+    {
+      std::scoped_lock lock(_mutex_labels_);
+      scope_str      = labels_.at(scope);
+      label_from_str = labels_.at(label_from);
+      label_to_str   = labels_.at(label_to);
+    }
+    log(scope_str, label_from_str, label_to_str, time_start, time_end);
+    return;
+  }
+
+  // the ring buffer of a thread is created when it logs for the first time and is kept until the logger is destroyed
+  thread_cache_t& cache = threadCache();
+  if (!cache.ring) {
+    std::scoped_lock lock(_mutex_rings_);
+    cache.ring = rings_.emplace_back(std::make_unique<ring_t>()).get();
+  }
+
+  ring_t&      ring = *cache.ring;
+  const size_t head = ring.head.load(std::memory_order_relaxed);
+
+  if (head - ring.tail.load(std::memory_order_acquire) >= ring_t::capacity) {
+    ring.n_dropped.store(ring.n_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return;
   }
+
+  record_t& record  = ring.records[head & (ring_t::capacity - 1)];
+  record.scope      = scope;
+  record.label_from = label_from;
+  record.label_to   = label_to;
+  record.reserved   = 0;
+  record.time_start = time_start.time_since_epoch().count();
+  record.time_end   = time_end.time_since_epoch().count();
+
+  ring.head.store(head + 1, std::memory_order_release);
+}
+/*//}*/
+
+/*//{ ScopeTimerLogger::internLabel() */
+uint32_t ScopeTimerLogger::internLabel(const std::string& label) {
+
+  std::scoped_lock lock(_mutex_labels_);
+
+  const auto [it, inserted] = label_ids_.try_emplace(label, uint32_t(labels_.size()));
+  if (inserted) {
+    labels_.push_back(label);
+  }
+
+  return it->second;
+}
+
+uint32_t ScopeTimerLogger::internLabel(const char* label) {
+
+  // the labels already used by this thread are found by their address without locking
+  thread_cache_t& cache = threadCache();
+
+  const auto it = cache.pointer_ids.find(label);
+  if (it != cache.pointer_ids.end() && it->second.second == label) {
+    return it->second.first;
+  }
+
+  // a new label or another label at an address used before
+  const uint32_t id        = internLabel(std::string(label));
+  cache.pointer_ids[label] = {id, label};
+
+  return id;
+}
+/*//}*/
+
+/*//{ ScopeTimerLogger::threadCache() */
+ScopeTimerLogger::thread_cache_t& ScopeTimerLogger::threadCache() {
+
+  thread_local std::unordered_map<uint64_t, thread_cache_t> caches;
+
+  const auto it = caches.find(id_);
+  if (it != caches.end()) {
+    return it->second;
+  }
+
+  // the first use of this logger by this thread - drop the caches of the destroyed loggers first, so that they do not
+  // accumulate and no pointers to their ring buffers are kept
+  {
+    live_ids_t&      live_ids = liveIds();
+    std::scoped_lock lock(live_ids.mutex);
+    for (auto cache_it = caches.begin(); cache_it != caches.end();) {
+      if (live_ids.ids.count(cache_it->first) == 0) {
+        cache_it = caches.erase(cache_it);
+      } else {
+        ++cache_it;
+      }
+    }
+  }
+
+  return caches[id_];
+}
+/*//}*/
+
+/*//{ ScopeTimerLogger::writerThread() */
+void ScopeTimerLogger::writerThread() {
+
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock lock(_mutex_writer_);
+      writer_cv_.wait_for(lock, binary_flush_period, [this] { return writer_stop_; });
+      stop = writer_stop_;
+    }
+    writeRecords();
+  }
+
+  if (n_dropped_ > 0) {
+    ROS_WARN("[%s]: Scope timer logger dropped %lu records, because the ring buffers were full.", ros::this_node::getName().c_str(), n_dropped_);
+  }
+}
+/*//}*/
+
+/*//{ ScopeTimerLogger::writeRecords() */
+void ScopeTimerLogger::writeRecords() {
+
+  const auto append = [](std::vector<char>& buffer, const void* data, const size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  };
+
+  // the records are drained before the labels are written, so that all their labels are already interned
+  record_buffer_.clear();
+  append(record_buffer_, &binary_kind_records, sizeof(binary_kind_records));
+  append(record_buffer_, "\0\0\0\0", sizeof(uint32_t));  // placeholder for the count
+
+  uint64_t n_dropped = 0;
+  {
+    std::scoped_lock lock(_mutex_rings_);
+
+    for (const auto& ring : rings_) {
+      const size_t tail = ring->tail.load(std::memory_order_relaxed);
+      const size_t head = ring->head.load(std::memory_order_acquire);
+
+      for (size_t it = tail; it != head; it++) {
+        append(record_buffer_, &ring->records[it & (ring_t::capacity - 1)], sizeof(record_t));
+      }
+
+      ring->tail.store(head, std::memory_order_release);
+      n_dropped += ring->n_dropped.load(std::memory_order_relaxed);
+    }
+  }
+
+  if (n_dropped > n_dropped_) {
+    ROS_WARN_THROTTLE(1.0, "[%s]: Scope timer logger dropped %lu records, because the ring buffers were full.", ros::this_node::getName().c_str(),
+                      n_dropped - n_dropped_);
+    n_dropped_ = n_dropped;
+  }
+
+  label_buffer_.clear();
+  {
+    std::scoped_lock lock(_mutex_labels_);
+
+    for (; n_labels_written_ < labels_.size(); n_labels_written_++) {
+      const std::string& label  = labels_[n_labels_written_];
+      const uint32_t     id     = n_labels_written_;
+      const uint32_t     length = label.size();
+      append(label_buffer_, &binary_kind_label, sizeof(binary_kind_label));
+      append(label_buffer_, &id, sizeof(id));
+      append(label_buffer_, &length, sizeof(length));
+      append(label_buffer_, label.data(), length);
+    }
+  }
+
+  const uint32_t n_records = (record_buffer_.size() - 2 * sizeof(uint32_t)) / sizeof(record_t);
+  std::memcpy(record_buffer_.data() + sizeof(uint32_t), &n_records, sizeof(n_records));
+
+  if ((!label_buffer_.empty() && !writeAll(log_fd_, label_buffer_.data(), label_buffer_.size())) ||
+      (n_records > 0 && !writeAll(log_fd_, record_buffer_.data(), record_buffer_.size()))) {
+    ROS_ERROR_THROTTLE(1.0, "[%s]: Scope timer logger failed to write to the log file (%s): %s.", ros::this_node::getName().c_str(), _log_filepath_.c_str(),
+                       strerror(errno));
+  }
+}
+/*//}*/
+
+/*//{ ScopeTimerLogger::convertToCsv() */
+bool ScopeTimerLogger::convertToCsv(const std::string& binary_logfile, const std::string& csv_logfile, const int log_precision) {
+
+  std::ifstream input(binary_logfile, std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open()) {
+    ROS_ERROR("[%s]: Failed to open the binary scope timer log (%s).", ros::this_node::getName().c_str(), binary_logfile.c_str());
+    return false;
+  }
+
+  char magic[sizeof(binary_magic)];
+  if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, binary_magic, sizeof(magic)) != 0) {
+    ROS_ERROR("[%s]: The file (%s) is not a binary scope timer log.", ros::this_node::getName().c_str(), binary_logfile.c_str());
+    return false;
+  }
+
+  std::ofstream output(csv_logfile, std::ios_base::out | std::ios_base::trunc);
+  if (!output.is_open()) {
+    ROS_ERROR("[%s]: Failed to create the CSV scope timer log (%s).", ros::this_node::getName().c_str(), csv_logfile.c_str());
+    return false;
+  }
+
+  output << std::fixed << std::setprecision(log_precision);
+  output << "#scope,label_from,label_to,sec_start,sec_end,sec_duration" << std::endl;
+
+  std::vector<std::string> labels;
+  std::vector<record_t>    records;
+  uint32_t                 kind;
+
+  while (input.read(reinterpret_cast<char*>(&kind), sizeof(kind))) {
+
+    if (kind == binary_kind_label) {
+      uint32_t id, length;
+      if (!input.read(reinterpret_cast<char*>(&id), sizeof(id)) || !input.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        break;
+      }
+      std::string label(length, '\0');
+      if (!input.read(label.data(), length)) {
+        break;
+      }
+      if (id >= labels.size()) {
+        labels.resize(id + 1);
+      }
+      labels[id] = label;
+
+    } else if (kind == binary_kind_records) {
+      uint32_t count;
+      if (!input.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        break;
+      }
+      records.resize(count);
+      if (!input.read(reinterpret_cast<char*>(records.data()), count * sizeof(record_t))) {
+        break;
+      }
+      for (const auto& record : records) {
+        if (record.scope >= labels.size() || record.label_from >= labels.size() || record.label_to >= labels.size()) {
+          ROS_ERROR("[%s]: The binary scope timer log (%s) contains a record with an unknown label.", ros::this_node::getName().c_str(),
+                    binary_logfile.c_str());
+          return false;
+        }
+        writeCsvLine(output, labels[record.scope], labels[record.label_from], labels[record.label_to],
+                     chrono_tp(chrono_tp::duration(record.time_start)), chrono_tp(chrono_tp::duration(record.time_end)));
+      }
+
+    } else {
+      ROS_ERROR("[%s]: The binary scope timer log (%s) is corrupted.", ros::this_node::getName().c_str(), binary_logfile.c_str());
+      return false;
+    }
+  }
+
+  // the log may be truncated if the logging process was killed
+  if (!input.eof()) {
+    ROS_ERROR("[%s]: The binary scope timer log (%s) is truncated.", ros::this_node::getName().c_str(), binary_logfile.c_str());
+    return false;
+  }
+
+  output.flush();
+  return output.good();
 }
 /*//}*/
 
 // | ------------------------ ScopeTimer ------------------------ |
 
 std::unordered_map<std::string, ros::Time> ScopeTimer::last_print_times;
+std::mutex                                 ScopeTimer::mutex_last_print_times;
 
 /* ScopeTimer constructor //{ */
 
@@ -86,6 +510,7 @@ ScopeTimer::ScopeTimer(const std::string& label, const ros::Duration& throttle_p
     : _timer_label_(label), _enable_print_or_log(enable), _throttle_period_(throttle_period), _logger_(scope_timer_logger) {
 
   checkpoints.push_back(time_point("timer start"));
+  _trace_ = Tracer::enabled();
 
   ROS_DEBUG("[%s] Scope timer started, label: %s", ros::this_node::getName().c_str(), label.c_str());
 }
@@ -96,6 +521,7 @@ ScopeTimer::ScopeTimer(const std::string& label, const time_point& tp0, const ro
 
   checkpoints.push_back(tp0);
   checkpoints.push_back(time_point("timer start"));
+  _trace_ = Tracer::enabled();
 
   ROS_DEBUG("[%s] Scope timer started with file logger (label: %s).", ros::this_node::getName().c_str(), label.c_str());
 }
@@ -104,6 +530,7 @@ ScopeTimer::ScopeTimer(const std::string& label, const std::shared_ptr<ScopeTime
     : _timer_label_(label), _enable_print_or_log(enable), _throttle_period_(ros::Duration(0.0)), _logger_(scope_timer_logger) {
 
   checkpoints.push_back(time_point("timer start"));
+  _trace_ = Tracer::enabled();
 
   ROS_DEBUG("[%s] Scope timer started with file logger (label: %s).", ros::this_node::getName().c_str(), label.c_str());
 }
@@ -114,7 +541,7 @@ ScopeTimer::ScopeTimer(const std::string& label, const std::shared_ptr<ScopeTime
 
 void ScopeTimer::checkpoint(const std::string& label) {
 
-  if (_enable_print_or_log) {
+  if (_enable_print_or_log || _trace_) {
     checkpoints.push_back(time_point(label));
   }
 }
@@ -134,15 +561,26 @@ float ScopeTimer::getLifetime() {
 
 ScopeTimer::~ScopeTimer() {
 
+  const auto chrono_end_time = std::chrono::steady_clock::now();
+
+  // all the scopes are traced, the enable flag and the throttling only apply to printing and logging
+  if (_trace_) {
+    for (size_t i = 1; i < checkpoints.size(); i++) {
+      Tracer::complete(Tracer::intern(checkpoints.at(i).label), "ScopeTimer", checkpoints.at(i - 1).chrono_time, checkpoints.at(i).chrono_time);
+    }
+    Tracer::complete(Tracer::intern(_timer_label_), "ScopeTimer", checkpoints.at(0).chrono_time, chrono_end_time);
+  }
+
   if (!_enable_print_or_log) {
     return;
   }
 
-  const auto chrono_end_time = std::chrono::steady_clock::now();
-  const auto ros_end_time    = ros::Time::now();
+  const auto ros_end_time = ros::Time::now();
 
   // if throttling is enabled, check time of last print and only print if applicable
   if (!_throttle_period_.isZero()) {
+    std::scoped_lock lock(mutex_last_print_times);
+
     bool       do_print = false;
     const auto last_it  = last_print_times.find(_timer_label_);
     // if this is the first print of this ScopeTimer
@@ -258,4 +696,142 @@ ScopeTimer::~ScopeTimer() {
 
 //}
 
+// | ---------------------- FastScopeTimer ---------------------- |
+
+/* FastScopeTimer constructor //{ */
+
+FastScopeTimer::FastScopeTimer(const char* label, const ros::Duration& throttle_period, const bool enable,
+                               const std::shared_ptr<ScopeTimerLogger> scope_timer_logger)
+    : _timer_label_(label),
+      _enable_print_or_log_(enable),
+      _throttle_period_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(throttle_period.toNSec()))),
+      _logger_(scope_timer_logger) {
+
+  checkpoints_[n_checkpoints_++] = {"timer start", std::chrono::steady_clock::now()};
+  _trace_                        = Tracer::enabled();
+}
+
+FastScopeTimer::FastScopeTimer(const char* label, const std::shared_ptr<ScopeTimerLogger> scope_timer_logger, const bool enable)
+    : FastScopeTimer(label, ros::Duration(0.0), enable, scope_timer_logger) {
+}
+
+//}
+
+/* FastScopeTimer::intern() //{ */
+
+const char* FastScopeTimer::intern(const std::string& label) {
+
+  // the nodes of the set are never moved, so the pointers to the strings stay valid
+  static std::mutex                      mutex_labels;
+  static std::unordered_set<std::string> labels;
+
+  std::scoped_lock lock(mutex_labels);
+  return labels.insert(label).first->c_str();
+}
+
+//}
+
+/* FastScopeTimer::getLifetime() //{ */
+
+float FastScopeTimer::getLifetime() {
+  const auto lifetime_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - checkpoints_[0].time).count();
+  return lifetime_us / 1000.0f;
+}
+
+//}
+
+/* FastScopeTimer destructor //{ */
+
+FastScopeTimer::~FastScopeTimer() {
+
+  const auto end_time = std::chrono::steady_clock::now();
+
+  // all the scopes are traced, the enable flag and the throttling only apply to printing and logging
+  // (the labels only have to outlive the timer, while the Tracer writes them later, so it gets its own copies)
+  if (_trace_) {
+    for (size_t i = 1; i < n_checkpoints_; i++) {
+      Tracer::complete(Tracer::intern(checkpoints_[i].label), "ScopeTimer", checkpoints_[i - 1].time, checkpoints_[i].time);
+    }
+    Tracer::complete(Tracer::intern(_timer_label_), "ScopeTimer", checkpoints_[0].time, end_time);
+  }
+
+  if (!_enable_print_or_log_) {
+    return;
+  }
+
+  // if throttling is enabled, check time of last print and only print if applicable
+  if (_throttle_period_.count() > 0) {
+    // the labels are valid at least until the end of the timer, so the table keeps its own copies
+    static std::mutex                                                                   mutex_last_print_times;
+    using last_print_times_t = std::unordered_map<std::string, std::chrono::time_point<std::chrono::steady_clock>>;
+    static last_print_times_t last_print_times;
+    // the table is only searched by the address of the label in the common case of a label used repeatedly by the same thread
+    // (the entries are never removed, so their addresses stay valid, and the key is compared as the address may be reused for another label)
+    thread_local std::unordered_map<const char*, last_print_times_t::value_type*> last_print_time_ptrs;
+
+    std::scoped_lock lock(mutex_last_print_times);
+
+    auto& entry_ptr = last_print_time_ptrs[_timer_label_];
+    if (entry_ptr == nullptr || entry_ptr->first != _timer_label_) {
+      // the first print of this timer is never throttled
+      const auto [it, inserted] = last_print_times.try_emplace(_timer_label_, end_time - _throttle_period_ - std::chrono::nanoseconds(1));
+      entry_ptr                 = &*it;
+    }
+
+    auto& last_print_time = entry_ptr->second;
+    if (end_time - last_print_time <= _throttle_period_) {
+      return;
+    }
+    last_print_time = end_time;
+  }
+
+  // If logger object exists and it should log (a path to a logger file was given by the user)
+  if (_logger_ && _logger_->shouldLog()) {
+
+    // Enabled, if user sets the enable flag to true, a path to a logger file is given, and the logging stream was successfully opened
+    if (!_logger_->loggingEnabled()) {
+      return;
+    }
+
+    const uint32_t scope_id = _logger_->internLabel(_timer_label_);
+    const uint32_t empty_id = _logger_->internLabel("");
+
+    // Log checkpoints, e.g., "SCOPE->checkpoint1;checkpoint1->checkpoint2"
+    uint32_t label_from_id = empty_id;
+    for (size_t i = 1; i < n_checkpoints_; i++) {
+      const uint32_t label_to_id = _logger_->internLabel(checkpoints_[i].label);
+      _logger_->log(scope_id, label_from_id, label_to_id, checkpoints_[i - 1].time, checkpoints_[i].time);
+      label_from_id = label_to_id;
+    }
+
+    // Log entire scope from start to end
+    _logger_->log(scope_id, empty_id, empty_id, checkpoints_[0].time, end_time);
+
+  } else {
+
+    std::stringstream ss;
+    ss.precision(3);
+    ss << std::fixed << std::endl;
+
+    const auto print_line = [&ss](const std::string& label, const std::chrono::steady_clock::duration& elapsed) {
+      ss << std::left << std::setw(40) << label << std::right << std::setw(12) << std::chrono::duration<double, std::milli>(elapsed).count() << "ms"
+         << std::endl;
+    };
+
+    for (size_t i = 1; i < n_checkpoints_; i++) {
+      print_line(std::string("(") + checkpoints_[i - 1].label + ") -> (" + checkpoints_[i].label + ")", checkpoints_[i].time - checkpoints_[i - 1].time);
+    }
+    print_line(std::string("(") + checkpoints_[n_checkpoints_ - 1].label + ") -> (scope end)", end_time - checkpoints_[n_checkpoints_ - 1].time);
+    print_line("TOTAL TIME", end_time - checkpoints_[0].time);
+
+    if (n_ignored_ > 0) {
+      ss << n_ignored_ << " checkpoints over the limit of " << max_checkpoints << " were ignored" << std::endl;
+    }
+
+    ROS_INFO("[%s]: Scope timer [%s] finished!%s", ros::this_node::getName().c_str(), _timer_label_, ss.str().c_str());
+  }
+}
+
+//}
+
 }  // namespace mrs_lib
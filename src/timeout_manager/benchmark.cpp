@@ -0,0 +1,100 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the TimeoutManager for various numbers of registered timeouts
+
+     A number of timeouts is registered and most of them are periodically reset by several threads (as if messages were
+     received on many topics), while the rest expire periodically. The average duration of one TimeoutManager::reset()
+     call and the average duration of one update of the TimeoutManager (measured as the time spent in ros::spinOnce())
+     are measured.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib timeout_manager_benchmark`
+     (a running roscore is necessary).
+ */
+
+#include <mrs_lib/timeout_manager.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <iostream>
+
+/* benchmark() function //{ */
+
+// prints the average duration of one reset() call and one update (in nanoseconds)
+void benchmark(ros::NodeHandle& nh, const int n_timeouts, const int n_resetters, const ros::Rate& update_rate, const ros::WallDuration& duration)
+{
+  mrs_lib::TimeoutManager tom(nh, update_rate);
+
+  // every tenth timeout is not reset and expires periodically
+  std::atomic<uint64_t> n_expired = 0;
+  const ros::Time start = ros::Time::now();
+  for (int it = 0; it < n_timeouts; it++)
+    tom.registerNew(ros::Duration(0.1 + 0.001 * (it % 100)), [&n_expired](const ros::Time&) { n_expired++; }, start);
+
+  std::atomic<bool> done = false;
+  std::vector<uint64_t> n_resets(n_resetters, 0);
+  std::vector<double> reset_durations(n_resetters, 0.0);
+  std::vector<std::thread> resetters;
+  for (int r = 0; r < n_resetters; r++)
+  {
+    resetters.emplace_back([&, r]() {
+      // each resetter resets its share of the timeouts every 10 ms
+      while (!done)
+      {
+        const ros::Time now = ros::Time::now();
+        const auto reset_start = std::chrono::steady_clock::now();
+        for (int it = r; it < n_timeouts; it += n_resetters)
+        {
+          if (it % 10 == 0)
+            continue;
+          tom.reset(it, now);
+          n_resets.at(r)++;
+        }
+        reset_durations.at(r) += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - reset_start).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    });
+  }
+
+  uint64_t n_spins = 0;
+  double spin_duration = 0.0;
+  const ros::WallTime end = ros::WallTime::now() + duration;
+  while (ros::WallTime::now() < end)
+  {
+    const auto spin_start = std::chrono::steady_clock::now();
+    ros::spinOnce();
+    spin_duration += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - spin_start).count();
+    n_spins++;
+    update_rate.expectedCycleTime().sleep();
+  }
+  done = true;
+  for (auto& resetter : resetters)
+    resetter.join();
+
+  uint64_t n_resets_total = 0;
+  double reset_duration = 0.0;
+  for (int r = 0; r < n_resetters; r++)
+  {
+    n_resets_total += n_resets.at(r);
+    reset_duration += reset_durations.at(r);
+  }
+  std::cout << n_timeouts << "," << n_resetters << "," << n_expired << "," << reset_duration / n_resets_total << "," << spin_duration / n_spins << std::endl;
+}
+
+//}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "timeout_manager_benchmark");
+  ros::NodeHandle nh("~");
+  ros::Time::waitForValid();
+
+  const ros::Rate update_rate(1000.0);
+  const ros::WallDuration duration(2.0);
+
+  std::cout << "n_timeouts,n_resetters,n_expired,reset_ns,update_ns" << std::endl;
+  for (const int n_resetters : {1, 4})
+    for (const int n_timeouts : {10, 100, 1000, 10000})
+      benchmark(nh, n_timeouts, n_resetters, update_rate, duration);
+  return 0;
+}
@@ -4,8 +4,9 @@ namespace mrs_lib
 {
 
   TimeoutManager::TimeoutManager(const ros::NodeHandle& nh, const ros::Rate& update_rate)
-    : m_last_id(0)
+    : m_last_id(0), m_n_wheel_entries(0), m_start_time(ros::Time::now()), m_tick(0)
   {
+    m_tick_period_ns = std::max(update_rate.expectedCycleTime().toNSec(), int64_t(1));
     m_main_timer = nh.createTimer(update_rate, &TimeoutManager::main_timer_callback, this);
   }
 
@@ -13,90 +14,243 @@ namespace mrs_lib
   TimeoutManager::timeout_id_t TimeoutManager::registerNew(const ros::Duration& timeout, const callback_t& callback, const ros::Time& last_reset, const bool oneshot, const bool autostart)
   {
     std::scoped_lock lck(m_mtx);
-    const auto new_id = m_timeouts.size();
-    const timeout_info_t new_info = {oneshot, autostart, callback, timeout, last_reset, last_reset};
-    m_timeouts.push_back(new_info);
+    const auto new_id = m_last_id.load();
+
+    // allocate a new segment if necessary (the segments are never reallocated, so that reset() doesn't need to lock)
+    const size_t segment = 63 - __builtin_clzll(new_id / first_segment_size + 1);
+    if (!m_segments.at(segment))
+      m_segments.at(segment) = std::make_unique<timeout_info_t[]>(first_segment_size << segment);
+    m_last_id.store(new_id + 1, std::memory_order_release);
+
+    auto& new_info = info(new_id);
+    new_info.oneshot = oneshot;
+    new_info.started = autostart;
+    new_info.callback = std::make_shared<const callback_t>(callback);
+    new_info.timeout = timeout;
+    new_info.last_reset_ns.store(last_reset.toNSec(), std::memory_order_release);
+    new_info.last_callback = last_reset;
+    new_info.generation = 0;
+    schedule(new_id);
     return new_id;
   }
 
   void TimeoutManager::reset(const timeout_id_t id, const ros::Time& time)
   {
-    std::scoped_lock lck(m_mtx);
-    m_timeouts.at(id).last_reset = time;
+    // the timeout is moved in the wheel lazily when it is checked
+    info(id).last_reset_ns.store(time.toNSec(), std::memory_order_release);
   }
 
   void TimeoutManager::pause(const timeout_id_t id)
   {
     std::scoped_lock lck(m_mtx);
-    m_timeouts.at(id).started = false;
+    auto& timeout_info = info(id);
+    timeout_info.started = false;
+    timeout_info.generation++;
   }
 
   void TimeoutManager::start(const timeout_id_t id, const ros::Time& time)
   {
     std::scoped_lock lck(m_mtx);
-    m_timeouts.at(id).started = true;
-    m_timeouts.at(id).last_reset = time;
+    auto& timeout_info = info(id);
+    timeout_info.started = true;
+    timeout_info.last_reset_ns.store(time.toNSec(), std::memory_order_release);
+    schedule(id);
   }
 
   void TimeoutManager::pauseAll()
   {
     std::scoped_lock lck(m_mtx);
-    for (auto& timeout_info : m_timeouts)
+    for (timeout_id_t id = 0; id < m_last_id; id++)
+    {
+      auto& timeout_info = info(id);
       timeout_info.started = false;
+      timeout_info.generation++;
+    }
   }
 
   void TimeoutManager::startAll(const ros::Time& time)
   {
     std::scoped_lock lck(m_mtx);
-    for (auto& timeout_info : m_timeouts)
+    for (timeout_id_t id = 0; id < m_last_id; id++)
     {
+      auto& timeout_info = info(id);
       timeout_info.started = true;
-      timeout_info.last_reset = time;
+      timeout_info.last_reset_ns.store(time.toNSec(), std::memory_order_release);
+      schedule(id);
     }
   }
 
   void TimeoutManager::change(const timeout_id_t id, const ros::Duration& timeout, const callback_t& callback, const ros::Time& last_reset, const bool oneshot, const bool autostart)
   {
     std::scoped_lock lck(m_mtx);
-    auto& timeout_info = m_timeouts.at(id);
+    auto& timeout_info = info(id);
     timeout_info.oneshot = oneshot;
     timeout_info.started = autostart;
     timeout_info.timeout = timeout;
-    timeout_info.callback = callback;
-    timeout_info.last_reset = last_reset;
+    timeout_info.callback = std::make_shared<const callback_t>(callback);
+    timeout_info.last_reset_ns.store(last_reset.toNSec(), std::memory_order_release);
+    timeout_info.generation++;
+    schedule(id);
   }
 
   ros::Time TimeoutManager::lastReset(const timeout_id_t id)
   {
-    std::scoped_lock lck(m_mtx);
-    return m_timeouts.at(id).last_reset;
+    ros::Time ret;
+    return ret.fromNSec(info(id).last_reset_ns.load(std::memory_order_acquire));
   }
 
   bool TimeoutManager::started(const timeout_id_t id)
   {
     std::scoped_lock lck(m_mtx);
-    return m_timeouts.at(id).started;
+    return info(id).started;
+  }
+
+  TimeoutManager::timeout_info_t& TimeoutManager::info(const timeout_id_t id)
+  {
+    if (id >= m_last_id.load(std::memory_order_acquire))
+      throw std::out_of_range("Invalid timeout id " + std::to_string(id) + "!");
+    // the k-th segment contains first_segment_size*2^k timeouts starting with the id first_segment_size*(2^k - 1)
+    const size_t segment = 63 - __builtin_clzll(id / first_segment_size + 1);
+    const size_t offset = id - first_segment_size * ((size_t(1) << segment) - 1);
+    return m_segments[segment][offset];
+  }
+
+  uint64_t TimeoutManager::tick(const ros::Time& time) const
+  {
+    if (time <= m_start_time)
+      return 0;
+    return (time - m_start_time).toNSec() / m_tick_period_ns;
+  }
+
+  void TimeoutManager::schedule(const timeout_id_t id)
+  {
+    auto& timeout_info = info(id);
+    // invalidate the older entries of this timeout in the wheel
+    timeout_info.generation++;
+    if (!timeout_info.started)
+      return;
+    ros::Time last_reset;
+    last_reset.fromNSec(timeout_info.last_reset_ns.load(std::memory_order_acquire));
+    const ros::Time deadline = std::max(last_reset, timeout_info.last_callback) + timeout_info.timeout;
+    insert({id, timeout_info.generation, tick(deadline)});
+  }
+
+  void TimeoutManager::insert(const wheel_entry_t& entry)
+  {
+    if (entry.tick <= m_tick)
+    {
+      m_due.push_back(entry);
+      return;
+    }
+
+    // the entry is placed to the lowest level, at which the current tick and the entry's tick fall into the same slot of the level above
+    // (entries beyond the range of the wheel are placed to the farthest slot and rescheduled when it is reached)
+    const uint64_t tick = std::min(entry.tick, m_tick + wheel_ticks - 1);
+    int level = 0;
+    while (level < wheel_levels - 1 && (tick >> (wheel_bits * (level + 1))) != (m_tick >> (wheel_bits * (level + 1))))
+      level++;
+    m_wheel[level][(tick >> (wheel_bits * level)) & (wheel_size - 1)].push_back(entry);
+    m_n_wheel_entries++;
+  }
+
+  void TimeoutManager::process(const wheel_entry_t& entry, const ros::Time& now)
+  {
+    auto& timeout_info = info(entry.id);
+    // the timeout was paused or rescheduled since this entry was inserted
+    if (entry.generation != timeout_info.generation || !timeout_info.started)
+      return;
+
+    ros::Time last_reset;
+    last_reset.fromNSec(timeout_info.last_reset_ns.load(std::memory_order_acquire));
+    const ros::Time deadline = std::max(last_reset, timeout_info.last_callback) + timeout_info.timeout;
+
+    // the timeout was reset in the meantime (or its callback was already called during this update), so it is moved to a later tick
+    if (deadline > now || timeout_info.last_callback == now)
+    {
+      insert({entry.id, entry.generation, tick(deadline)});
+      return;
+    }
+
+    m_expired.emplace_back(timeout_info.callback, last_reset);
+    timeout_info.last_callback = now;
+    // if the timeout is oneshot, pause it
+    if (timeout_info.oneshot)
+    {
+      timeout_info.started = false;
+      timeout_info.generation++;
+      return;
+    }
+    insert({entry.id, entry.generation, tick(std::max(last_reset, now) + timeout_info.timeout)});
+  }
+
+  void TimeoutManager::processSlot(std::vector<wheel_entry_t>& slot, const ros::Time& now)
+  {
+    // the slot is swapped with the helper buffer, because the entries may be inserted back to the same slot
+    m_processed.swap(slot);
+    for (const auto& entry : m_processed)
+      process(entry, now);
+    m_processed.clear();
   }
 
   void TimeoutManager::main_timer_callback([[maybe_unused]] const ros::TimerEvent &evt)
   {
     const auto now = ros::Time::now();
 
-    std::scoped_lock lck(m_mtx);
-    for (auto& timeout_info : m_timeouts)
     {
-      // don't worry, this'll get optimized out by the compiler
-      const bool started = timeout_info.started;
-      const bool last_reset_timeout = now - timeout_info.last_reset >= timeout_info.timeout;
-      const bool last_callback_timeout = now - timeout_info.last_callback >= timeout_info.timeout;
-      if (started && last_reset_timeout && last_callback_timeout)
+      std::scoped_lock lck(m_mtx);
+      const uint64_t target_tick = tick(now);
+
+      if (now.toNSec() < m_start_time.toNSec() + m_tick * m_tick_period_ns || target_tick - m_tick >= wheel_ticks)
       {
-        timeout_info.callback(timeout_info.last_reset);
-        timeout_info.last_callback = now;
-        // if the timeout is oneshot, pause it
-        if (timeout_info.oneshot)
-          timeout_info.started = false;
+        // the time jumped backwards or too far ahead (e.g. when using simulation time), so all the entries are checked at once
+        for (auto& level : m_wheel)
+        {
+          for (auto& slot : level)
+          {
+            m_due.insert(std::end(m_due), std::begin(slot), std::end(slot));
+            slot.clear();
+          }
+        }
+        m_n_wheel_entries = 0;
+        m_start_time = now;
+        m_tick = 0;
       }
+
+      while (m_tick < target_tick)
+      {
+        // nothing to be done until the target tick
+        if (m_n_wheel_entries == 0)
+        {
+          m_tick = target_tick;
+          break;
+        }
+        m_tick++;
+
+        // move the entries from the slots of the higher levels starting at this tick to the lower levels
+        for (int level = wheel_levels - 1; level > 0; level--)
+        {
+          if ((m_tick & ((uint64_t(1) << (wheel_bits * level)) - 1)) != 0)
+            continue;
+          auto& slot = m_wheel[level][(m_tick >> (wheel_bits * level)) & (wheel_size - 1)];
+          m_n_wheel_entries -= slot.size();
+          m_processed.swap(slot);
+          for (const auto& entry : m_processed)
+            insert(entry);
+          m_processed.clear();
+        }
+
+        auto& slot = m_wheel[0][m_tick & (wheel_size - 1)];
+        m_n_wheel_entries -= slot.size();
+        processSlot(slot, now);
+      }
+
+      // the entries of the current tick, which were not expired yet, are checked again on the next update
+      processSlot(m_due, now);
     }
+
+    // call the callbacks after unlocking the mutex so that they may use the TimeoutManager
+    for (const auto& [callback, last_reset] : m_expired)
+      (*callback)(last_reset);
+    m_expired.clear();
   }
 }
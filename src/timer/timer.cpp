@@ -1,4 +1,12 @@
 #include <mrs_lib/timer.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 namespace mrs_lib
 {
@@ -105,6 +113,53 @@ bool ThreadTimer::running()
 
 //}
 
+/* ThreadTimer::getStatistics() //{ */
+
+ThreadTimer::statistics_t ThreadTimer::getStatistics()
+{
+  if (impl_)
+    return impl_->getStatistics();
+  else
+    return statistics_t();
+}
+
+//}
+
+/* ThreadTimer::resetStatistics() //{ */
+
+void ThreadTimer::resetStatistics()
+{
+  if (impl_) {
+    impl_->resetStatistics();
+  }
+}
+
+//}
+
+/* ThreadTimer::setPriority() //{ */
+
+bool ThreadTimer::setPriority(const int priority)
+{
+  if (impl_)
+    return impl_->setPriority(priority);
+  else
+    return false;
+}
+
+//}
+
+/* ThreadTimer::setAffinity() //{ */
+
+bool ThreadTimer::setAffinity(const std::vector<int>& cpus)
+{
+  if (impl_)
+    return impl_->setAffinity(cpus);
+  else
+    return false;
+}
+
+//}
+
 /* ThreadTimer::Impl //{ */
 
 ThreadTimer::Impl::Impl(const std::function<void(const ros::TimerEvent&)>& callback, const ros::Duration& delay_dur, const bool oneshot)
@@ -117,6 +172,24 @@ ThreadTimer::Impl::Impl(const std::function<void(const ros::TimerEvent&)>& callb
   last_expected_ = ros::Time(0);
   next_expected_ = ros::Time(0);
 
+  lateness_window_.resize(lateness_window, 0);
+  lateness_idx_   = 0;
+  lateness_sum_s_ = 0.0;
+
+  // if the timerfd or eventfd is not available, the thread will sleep on the condition variable
+  timer_fd_ = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (timer_fd_ < 0 || event_fd_ < 0)
+  {
+    ROS_WARN("[ThreadTimer]: Failed to create a timerfd or eventfd (%s), the timer will be less precise.", std::strerror(errno));
+    if (timer_fd_ >= 0)
+      close(timer_fd_);
+    if (event_fd_ >= 0)
+      close(event_fd_);
+    timer_fd_ = -1;
+    event_fd_ = -1;
+  }
+
   thread_ = std::thread(&ThreadTimer::Impl::threadFcn, this);
 }
 
@@ -126,10 +199,15 @@ ThreadTimer::Impl::~Impl()
     // signal the thread to end
     std::scoped_lock lck(mutex_wakeup_, mutex_state_);
     ending_ = true;
-    wakeup_cond_.notify_all();
+    wakeUp();
   }
   // wait for it to die
   thread_.join();
+
+  if (timer_fd_ >= 0)
+    close(timer_fd_);
+  if (event_fd_ >= 0)
+    close(event_fd_);
 }
 
 void ThreadTimer::Impl::start()
@@ -139,7 +217,7 @@ void ThreadTimer::Impl::start()
   {
     next_expected_ = ros::Time::now() + delay_dur_;
     running_ = true;
-    wakeup_cond_.notify_all();
+    wakeUp();
   }
 }
 
@@ -147,7 +225,7 @@ void ThreadTimer::Impl::stop()
 {
   std::scoped_lock lck(mutex_wakeup_, mutex_state_);
   running_ = false;
-  wakeup_cond_.notify_all();
+  wakeUp();
 }
 
 void ThreadTimer::Impl::setPeriod(const ros::Duration& duration, [[maybe_unused]] const bool reset)
@@ -159,11 +237,101 @@ void ThreadTimer::Impl::setPeriod(const ros::Duration& duration, [[maybe_unused]
     this->oneshot_  = true;
 }
 
+ThreadTimer::statistics_t ThreadTimer::Impl::getStatistics()
+{
+  std::scoped_lock lck(mutex_stats_);
+  statistics_t ret = stats_;
+  if (stats_.n_callbacks == 0)
+    return ret;
+
+  ret.mean_lateness = ros::Duration(lateness_sum_s_ / stats_.n_callbacks);
+  std::vector<int64_t> window(std::begin(lateness_window_), std::begin(lateness_window_) + std::min(lateness_idx_, lateness_window));
+  const auto percentile = [&window](const double q) {
+    const auto nth = std::begin(window) + std::min(size_t(q * window.size()), window.size() - 1);
+    std::nth_element(std::begin(window), nth, std::end(window));
+    return ros::Duration(*nth * 1e-9);
+  };
+  ret.lateness_p50 = percentile(0.5);
+  ret.lateness_p90 = percentile(0.9);
+  ret.lateness_p99 = percentile(0.99);
+  return ret;
+}
+
+void ThreadTimer::Impl::resetStatistics()
+{
+  std::scoped_lock lck(mutex_stats_);
+  stats_          = statistics_t();
+  lateness_idx_   = 0;
+  lateness_sum_s_ = 0.0;
+}
+
+bool ThreadTimer::Impl::setPriority(const int priority)
+{
+  sched_param param{};
+  param.sched_priority = priority;
+  const int ret        = pthread_setschedparam(thread_.native_handle(), priority > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+  if (ret != 0)
+  {
+    ROS_WARN("[ThreadTimer]: Failed to set the priority of the timer thread to %d: %s", priority, std::strerror(ret));
+    return false;
+  }
+  return true;
+}
+
+bool ThreadTimer::Impl::setAffinity(const std::vector<int>& cpus)
+{
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (const auto cpu : cpus)
+  {
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+      ROS_WARN("[ThreadTimer]: Invalid CPU index %d!", cpu);
+      return false;
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  const int ret = pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set), &cpu_set);
+  if (ret != 0)
+  {
+    ROS_WARN("[ThreadTimer]: Failed to set the CPU affinity of the timer thread: %s", std::strerror(ret));
+    return false;
+  }
+  return true;
+}
+
+void ThreadTimer::Impl::wakeUp()
+{
+  wakeup_cond_.notify_all();
+  if (event_fd_ >= 0)
+  {
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(event_fd_, &one, sizeof(one));
+  }
+}
+
+void ThreadTimer::Impl::updateStatistics(const ros::Time& expected, const ros::Time& real, const uint64_t n_missed)
+{
+  std::scoped_lock lck(mutex_stats_);
+  const ros::Duration lateness = real - expected;
+  stats_.n_callbacks++;
+  stats_.n_missed += n_missed;
+  if (lateness > stats_.max_lateness || stats_.n_callbacks == 1)
+    stats_.max_lateness = lateness;
+  lateness_sum_s_ += lateness.toSec();
+  lateness_window_.at(lateness_idx_ % lateness_window) = lateness.toNSec();
+  lateness_idx_++;
+}
+
 //}
 
 /* ThreadTimer::breakableSleep() method //{ */
 bool ThreadTimer::Impl::breakableSleep(const ros::Time& until)
 {
+  // the timerfd may only be used with the wall time
+  if (timer_fd_ >= 0 && !ros::Time::isSimTime())
+    return breakableSleepTimerfd(until);
+
   while (ros::ok() && ros::Time::now() < until)
   {
     const std::chrono::nanoseconds dur {(until - ros::Time::now()).toNSec()};
@@ -179,6 +347,57 @@ bool ThreadTimer::Impl::breakableSleep(const ros::Time& until)
 }
 //}
 
+/* ThreadTimer::breakableSleepTimerfd() method //{ */
+bool ThreadTimer::Impl::breakableSleepTimerfd(const ros::Time& until)
+{
+  // without the simulation time, ros::Time corresponds to CLOCK_REALTIME, so the timer may expire at the absolute time
+  itimerspec spec{};
+  spec.it_value.tv_sec  = until.sec;
+  spec.it_value.tv_nsec = until.nsec;
+  // a zero expiration time would disarm the timer
+  if (until.isZero())
+    spec.it_value.tv_nsec = 1;
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) != 0)
+  {
+    ROS_ERROR("[ThreadTimer]: Failed to set the timerfd: %s", std::strerror(errno));
+    return false;
+  }
+
+  while (ros::ok())
+  {
+    {
+      // check the flags while mutex_wakeup_ is locked
+      std::scoped_lock lck(mutex_wakeup_);
+      if (ending_ || !running_)
+        return false;
+    }
+
+    std::array<pollfd, 2> fds = {pollfd{timer_fd_, POLLIN, 0}, pollfd{event_fd_, POLLIN, 0}};
+    if (poll(fds.data(), fds.size(), -1) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      ROS_ERROR("[ThreadTimer]: Failed to wait for the timerfd: %s", std::strerror(errno));
+      return false;
+    }
+
+    uint64_t value;
+    // woken up by start(), stop() or the destructor - check the flags again
+    if (fds[1].revents & POLLIN)
+    {
+      [[maybe_unused]] const auto read_bytes = read(event_fd_, &value, sizeof(value));
+      continue;
+    }
+    if (fds[0].revents & POLLIN)
+    {
+      [[maybe_unused]] const auto read_bytes = read(timer_fd_, &value, sizeof(value));
+      return true;
+    }
+  }
+  return false;
+}
+//}
+
 /* ThreadTimer::Impl::threadFcn() //{ */
 
 void ThreadTimer::Impl::threadFcn()
@@ -232,6 +451,7 @@ void ThreadTimer::Impl::threadFcn()
         running_ = false;
         timer_event.last_real        = last_real_;
         timer_event.current_real     = now;
+        updateStatistics(next_expected_, now, 0);
       }
       else
       {
@@ -240,8 +460,15 @@ void ThreadTimer::Impl::threadFcn()
         timer_event.current_expected = next_expected_;
         timer_event.current_real     = now;
 
+        // the deadlines are absolute so that the period doesn't drift by the duration of the callbacks,
+        // and the deadlines, which have already passed, are skipped
+        uint64_t n_missed = 0;
+        if (delay_dur_ > ros::Duration(0) && now - next_expected_ >= delay_dur_)
+          n_missed = (now - next_expected_).toNSec() / delay_dur_.toNSec();
+        updateStatistics(next_expected_, now, n_missed);
+
         last_expected_ = next_expected_;
-        next_expected_ = now + delay_dur_;
+        next_expected_ = next_expected_ + delay_dur_ * double(n_missed + 1);
       }
       last_real_ = now;
       // call the callback
@@ -0,0 +1,26 @@
+/**  \file
+     \brief Merges the trace files of multiple processes written by the Tracer to a single trace file
+
+     Usage: `rosrun mrs_lib trace_merge <merged_trace> <trace> [<trace> ...]`
+
+     The merged trace file may be opened in chrome://tracing or in ui.perfetto.dev.
+ */
+
+#include <mrs_lib/tracer.h>
+#include <iostream>
+
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <merged_trace> <trace> [<trace> ...]" << std::endl;
+    return 1;
+  }
+
+  const std::vector<std::string> input_filepaths(argv + 2, argv + argc);
+
+  if (!mrs_lib::Tracer::merge(input_filepaths, argv[1])) {
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,496 @@
+#include <mrs_lib/tracer.h>
+#include <ros/ros.h>
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mrs_lib
+{
+
+std::atomic<bool> Tracer::enabled_{false};
+
+namespace
+{
+
+/* state of the tracer //{ */
+
+struct event_t
+{
+  const char* name;
+  const char* category;
+  int64_t     start_ns;  // steady clock
+  int64_t     end_ns;
+};
+
+// single-producer single-consumer ring buffer of the events of one thread
+struct ring_t
+{
+  ring_t(const size_t capacity) : events(capacity), mask(capacity - 1) {
+  }
+
+  std::vector<event_t> events;
+  const size_t         mask;
+
+  alignas(64) std::atomic<size_t> head{0};  // written by the recording thread
+  alignas(64) std::atomic<size_t> tail{0};  // written by the writer thread
+  std::atomic<uint64_t> n_dropped{0};
+  // set when the thread exits, the ring buffer is then removed after its events are written
+  std::atomic<bool> retired{false};
+
+  long        tid = 0;
+  std::string thread_name;
+  bool        thread_name_written = false;
+};
+
+// marks the ring buffer of a thread as retired when the thread exits
+struct ring_holder_t
+{
+  ring_t* ring = nullptr;
+  ~ring_holder_t() {
+    if (ring) {
+      ring->retired.store(true, std::memory_order_release);
+    }
+  }
+};
+
+// the flush period of the trace file
+constexpr std::chrono::milliseconds flush_period(100);
+
+struct state_t
+{
+  std::mutex                           mutex_rings;
+  std::vector<std::unique_ptr<ring_t>> rings;
+  size_t                               buffer_events = 1 << 14;
+
+  // start() and stop() are serialized by this mutex
+  std::mutex              mutex_session;
+  int                     fd = -1;
+  std::thread             writer;
+  std::mutex              mutex_writer;
+  std::condition_variable writer_cv;
+  bool                    writer_stop = false;
+
+  // offset of the system clock from the steady clock, so that the traces of multiple processes share the same clock
+  int64_t  wall_offset_ns = 0;
+  long     pid            = 0;
+  uint64_t n_dropped      = 0;
+
+  // used only by the writer thread (or by stop() after the writer thread is joined)
+  std::string buffer;
+
+  std::mutex                      mutex_names;
+  std::unordered_set<std::string> names;
+};
+
+state_t& state() {
+  static state_t state;
+  return state;
+}
+
+//}
+
+/* appendEscaped() //{ */
+
+void appendEscaped(std::string& buffer, const char* str) {
+
+  for (; *str; str++) {
+    const char c = *str;
+    if (c == '"' || c == '\\') {
+      buffer += '\\';
+      buffer += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      buffer += escaped;
+    } else {
+      buffer += c;
+    }
+  }
+}
+
+//}
+
+/* appendMetadata() //{ */
+
+// appends a metadata event naming a process or a thread
+void appendMetadata(std::string& buffer, const char* type, const long pid, const long tid, const std::string& name) {
+
+  char prefix[128];
+  snprintf(prefix, sizeof(prefix), "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":\"", type, pid, tid);
+  buffer += prefix;
+  appendEscaped(buffer, name.c_str());
+  buffer += "\"}}";
+}
+
+//}
+
+/* writeAll() //{ */
+
+bool writeAll(const int fd, const char* data, size_t size) {
+
+  while (size > 0) {
+    const ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+
+  return true;
+}
+
+//}
+
+/* flush() //{ */
+
+// drains the ring buffers of all threads and appends their events to the trace file
+void flush(state_t& st) {
+
+  st.buffer.clear();
+
+  {
+    std::scoped_lock lock(st.mutex_rings);
+
+    for (auto it = st.rings.begin(); it != st.rings.end();) {
+      ring_t& ring = **it;
+
+      // if the thread has already exited, no more events will be added after these
+      const bool retired = ring.retired.load(std::memory_order_acquire);
+
+      if (!ring.thread_name_written) {
+        appendMetadata(st.buffer, "thread_name", st.pid, ring.tid, ring.thread_name);
+        st.buffer += ",\n";
+        ring.thread_name_written = true;
+      }
+
+      const size_t tail = ring.tail.load(std::memory_order_relaxed);
+      const size_t head = ring.head.load(std::memory_order_acquire);
+
+      for (size_t i = tail; i != head; i++) {
+        const event_t& event = ring.events[i & ring.mask];
+
+        st.buffer += "{\"name\":\"";
+        appendEscaped(st.buffer, event.name);
+        st.buffer += "\",\"cat\":\"";
+        appendEscaped(st.buffer, event.category);
+
+        char times[160];
+        snprintf(times, sizeof(times), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld},\n", (event.start_ns + st.wall_offset_ns) * 1e-3,
+                 (event.end_ns - event.start_ns) * 1e-3, st.pid, ring.tid);
+        st.buffer += times;
+      }
+
+      ring.tail.store(head, std::memory_order_release);
+      st.n_dropped += ring.n_dropped.exchange(0, std::memory_order_relaxed);
+
+      if (retired) {
+        it = st.rings.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+
+  if (!st.buffer.empty() && !writeAll(st.fd, st.buffer.data(), st.buffer.size())) {
+    ROS_ERROR_THROTTLE(1.0, "[%s]: Tracer failed to write to the trace file: %s.", ros::this_node::getName().c_str(), strerror(errno));
+  }
+}
+
+//}
+
+/* writerThread() //{ */
+
+void writerThread(state_t& st) {
+
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock lock(st.mutex_writer);
+      st.writer_cv.wait_for(lock, flush_period, [&st] { return st.writer_stop; });
+      stop = st.writer_stop;
+    }
+    flush(st);
+  }
+}
+
+//}
+
+/* ring() //{ */
+
+// returns the ring buffer of the calling thread, which is created on the first call
+ring_t& ring() {
+
+  thread_local ring_holder_t holder;
+
+  if (!holder.ring) {
+    state_t& st = state();
+
+    std::scoped_lock lock(st.mutex_rings);
+
+    // the capacity has to be a power of two
+    size_t capacity = 1;
+    while (capacity < st.buffer_events) {
+      capacity <<= 1;
+    }
+
+    auto new_ring = std::make_unique<ring_t>(capacity);
+    new_ring->tid = syscall(SYS_gettid);
+
+    char thread_name[16] = {};
+    pthread_getname_np(pthread_self(), thread_name, sizeof(thread_name));
+    new_ring->thread_name = std::string(thread_name) + " (" + std::to_string(new_ring->tid) + ")";
+
+    holder.ring = st.rings.emplace_back(std::move(new_ring)).get();
+  }
+
+  return *holder.ring;
+}
+
+//}
+
+/* autostart //{ */
+
+// starts the tracing if the MRS_LIB_TRACE_DIR environment variable is set and stops any tracing at the end of the program
+struct autostart_t
+{
+  autostart_t() {
+    // the state is constructed first, so that it is destroyed after this object
+    state();
+
+    const char* dir = std::getenv("MRS_LIB_TRACE_DIR");
+    if (dir && *dir) {
+      Tracer::start(std::string(dir) + "/trace_" + std::to_string(getpid()) + ".json");
+    }
+  }
+  ~autostart_t() {
+    Tracer::stop();
+  }
+};
+
+autostart_t autostart;
+
+//}
+
+}  // namespace
+
+/* Tracer::start() //{ */
+
+bool Tracer::start(const std::string& filepath, const size_t buffer_events) {
+
+  stop();
+
+  state_t&         st = state();
+  std::scoped_lock lock(st.mutex_session);
+
+  st.fd = ::open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+  if (st.fd < 0 || !writeAll(st.fd, "[\n", 2)) {
+    ROS_ERROR("[%s]: Tracer failed to create the trace file (%s): %s.", ros::this_node::getName().c_str(), filepath.c_str(), strerror(errno));
+    if (st.fd >= 0) {
+      ::close(st.fd);
+      st.fd = -1;
+    }
+    return false;
+  }
+
+  // the minimal difference of the clocks sampled close to each other is used
+  int64_t min_sampling_ns = std::numeric_limits<int64_t>::max();
+  for (int it = 0; it < 10; it++) {
+    const auto steady_before = std::chrono::steady_clock::now();
+    const auto wall          = std::chrono::system_clock::now();
+    const auto steady_after  = std::chrono::steady_clock::now();
+
+    const int64_t sampling_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(steady_after - steady_before).count();
+    if (sampling_ns < min_sampling_ns) {
+      min_sampling_ns   = sampling_ns;
+      const auto steady = steady_before + (steady_after - steady_before) / 2;
+      st.wall_offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count() -
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(steady.time_since_epoch()).count();
+    }
+  }
+
+  st.pid       = getpid();
+  st.n_dropped = 0;
+
+  {
+    std::scoped_lock lock_rings(st.mutex_rings);
+
+    st.buffer_events = std::max(buffer_events, size_t(1));
+
+    // the events recorded before this trace started are discarded and the threads are named again in the new file
+    for (auto& ring : st.rings) {
+      ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+      ring->n_dropped.store(0, std::memory_order_relaxed);
+      ring->thread_name_written = false;
+    }
+  }
+
+  st.writer_stop = false;
+  st.writer      = std::thread(writerThread, std::ref(st));
+
+  enabled_.store(true, std::memory_order_relaxed);
+
+  return true;
+}
+
+//}
+
+/* Tracer::stop() //{ */
+
+void Tracer::stop() {
+
+  state_t&         st = state();
+  std::scoped_lock lock(st.mutex_session);
+
+  if (st.fd < 0) {
+    return;
+  }
+
+  enabled_.store(false, std::memory_order_relaxed);
+
+  {
+    std::scoped_lock lock_writer(st.mutex_writer);
+    st.writer_stop = true;
+  }
+  st.writer_cv.notify_all();
+  st.writer.join();
+
+  // the remaining events are written and the array is closed by the name of the process
+  flush(st);
+
+  std::string process_name = ros::this_node::getName();
+  if (process_name.empty()) {
+    process_name = "pid " + std::to_string(st.pid);
+  }
+
+  st.buffer.clear();
+  appendMetadata(st.buffer, "process_name", st.pid, 0, process_name);
+  st.buffer += "\n]\n";
+  writeAll(st.fd, st.buffer.data(), st.buffer.size());
+
+  ::close(st.fd);
+  st.fd = -1;
+
+  if (st.n_dropped > 0) {
+    ROS_WARN("[%s]: Tracer dropped %lu events, because the ring buffers were full.", ros::this_node::getName().c_str(), st.n_dropped);
+  }
+}
+
+//}
+
+/* Tracer::complete() //{ */
+
+void Tracer::complete(const char* name, const char* category, const chrono_tp& start, const chrono_tp& end) {
+
+  if (!enabled()) {
+    return;
+  }
+
+  ring_t&      r    = ring();
+  const size_t head = r.head.load(std::memory_order_relaxed);
+
+  if (head - r.tail.load(std::memory_order_acquire) > r.mask) {
+    r.n_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  event_t& event = r.events[head & r.mask];
+  event.name     = name;
+  event.category = category;
+  event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+  event.end_ns   = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count();
+
+  r.head.store(head + 1, std::memory_order_release);
+}
+
+//}
+
+/* Tracer::intern() //{ */
+
+const char* Tracer::intern(const std::string& name) {
+
+  // the names already used by this thread are found without locking
+  thread_local std::unordered_map<std::string, const char*> cache;
+
+  const auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  state_t& st = state();
+
+  const char* interned;
+  {
+    // the nodes of the set are never moved, so the pointers to the strings stay valid
+    std::scoped_lock lock(st.mutex_names);
+    interned = st.names.insert(name).first->c_str();
+  }
+
+  cache.emplace(name, interned);
+  return interned;
+}
+
+//}
+
+/* Tracer::merge() //{ */
+
+bool Tracer::merge(const std::vector<std::string>& input_filepaths, const std::string& output_filepath) {
+
+  std::vector<std::string> events;
+
+  for (const auto& filepath : input_filepaths) {
+
+    std::ifstream input(filepath);
+    if (!input.is_open()) {
+      ROS_ERROR("[%s]: Failed to open the trace file (%s).", ros::this_node::getName().c_str(), filepath.c_str());
+      return false;
+    }
+
+    // the Tracer writes one event per line
+    std::string line;
+    while (std::getline(input, line)) {
+      if (line.empty() || line.front() != '{') {
+        continue;
+      }
+      while (!line.empty() && (line.back() == ',' || line.back() == ']' || std::isspace(static_cast<unsigned char>(line.back())))) {
+        line.pop_back();
+      }
+      events.push_back(line);
+    }
+  }
+
+  std::ofstream output(output_filepath, std::ios_base::out | std::ios_base::trunc);
+  if (!output.is_open()) {
+    ROS_ERROR("[%s]: Failed to create the merged trace file (%s).", ros::this_node::getName().c_str(), output_filepath.c_str());
+    return false;
+  }
+
+  output << "[\n";
+  for (size_t i = 0; i < events.size(); i++) {
+    output << events[i] << (i + 1 < events.size() ? ",\n" : "\n");
+  }
+  output << "]\n";
+
+  output.flush();
+  return output.good();
+}
+
+//}
+
+}  // namespace mrs_lib
@@ -0,0 +1,123 @@
+/**  \file
+     \brief Benchmark of repeated transform lookups with and without the transform cache of the Transformer
+
+     A static transform (a sensor mount) and a dynamic transform are published and then repeatedly looked up by one or
+     more threads using a single Transformer. The static chain is looked up at varying time stamps, the chain including
+     the dynamic transform is looked up repeatedly at the same time stamp (as when transforming multiple messages with
+     the same header). The average duration of one lookup in nanoseconds and the cache statistics are printed.
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib transformer_benchmark`
+     (a running roscore is necessary).
+ */
+
+#include <mrs_lib/transformer.h>
+#include <tf2_ros/transform_broadcaster.h>
+#include <tf2_ros/static_transform_broadcaster.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using steady_clock = std::chrono::steady_clock;
+
+/* run() function //{ */
+
+// returns the total duration of the lookups in nanoseconds
+double run(mrs_lib::Transformer& tfr, const std::string& from, const std::string& to, const ros::Time& stamp, const bool vary_stamp, const int n_lookups) {
+
+  geometry_msgs::PointStamped pt;
+  pt.header.frame_id = from;
+  pt.point.x = 1.0;
+
+  const auto start = steady_clock::now();
+  for (int it = 0; it < n_lookups; it++) {
+    pt.header.stamp = vary_stamp ? stamp + ros::Duration(1e-3 * (it % 1000)) : stamp;
+    const auto pt_opt = tfr.transformSingle(pt, to);
+    if (!pt_opt.has_value()) {
+      ROS_ERROR("[transformer_benchmark]: the lookup from \"%s\" to \"%s\" failed", from.c_str(), to.c_str());
+      break;
+    }
+  }
+  return std::chrono::duration<double, std::nano>(steady_clock::now() - start).count();
+}
+
+//}
+
+/* benchmark() function //{ */
+
+void benchmark(mrs_lib::Transformer& tfr, const std::string& name, const std::string& from, const std::string& to, const ros::Time& stamp, const bool vary_stamp,
+               const int n_threads, const int n_lookups) {
+
+  std::vector<double>      results(n_threads);
+  std::vector<std::thread> threads;
+
+  const auto stats_before = tfr.getCacheStatistics();
+
+  for (int t = 0; t < n_threads; t++) {
+    threads.emplace_back([&, t]() { results.at(t) = run(tfr, from, to, stamp, vary_stamp, n_lookups); });
+  }
+
+  double total_ns = 0.0;
+  for (int t = 0; t < n_threads; t++) {
+    threads.at(t).join();
+    total_ns += results.at(t);
+  }
+
+  const auto stats = tfr.getCacheStatistics();
+  std::cout << name << ", " << n_threads << " threads: " << total_ns / (double(n_threads) * n_lookups) << " ns per lookup (static hits: " << stats.static_hits - stats_before.static_hits
+            << ", dynamic hits: " << stats.dynamic_hits - stats_before.dynamic_hits << ", misses: " << stats.misses - stats_before.misses << ")" << std::endl;
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  ros::init(argc, argv, "transformer_benchmark");
+  ros::NodeHandle nh("~");
+
+  mrs_lib::Transformer tfr(nh, "transformer_benchmark");
+  tfr.setDefaultPrefix("uav1");
+
+  tf2_ros::StaticTransformBroadcaster static_bc;
+  tf2_ros::TransformBroadcaster       bc;
+
+  const ros::Time stamp = ros::Time::now();
+
+  geometry_msgs::TransformStamped tf;
+  tf.transform.rotation.w = 1.0;
+
+  // the static transform of a sensor mount
+  tf.header.stamp            = stamp;
+  tf.header.frame_id         = "uav1/fcu";
+  tf.child_frame_id          = "uav1/camera";
+  tf.transform.translation.x = 0.2;
+  static_bc.sendTransform(tf);
+
+  // wait for the transforms (the dynamic one is published repeatedly to be sure it is received)
+  for (int it = 0; it < 100 && ros::ok(); it++) {
+    tf.header.stamp            = stamp;
+    tf.header.frame_id         = "uav1/world_origin";
+    tf.child_frame_id          = "uav1/fcu";
+    tf.transform.translation.x = 10.0;
+    bc.sendTransform(tf);
+    tf.header.stamp = stamp + ros::Duration(1.0);
+    bc.sendTransform(tf);
+    ros::spinOnce();
+    if (tfr.getTransform("camera", "fcu").has_value() && tfr.getTransform("camera", "world_origin", stamp).has_value())
+      break;
+    ros::Duration(0.1).sleep();
+  }
+
+  const int n_lookups = 100000;
+
+  for (const bool caching : {false, true}) {
+    tfr.setCaching(caching);
+    const std::string suffix = caching ? " (cached)" : " (uncached)";
+    for (const int n_threads : {1, 4}) {
+      benchmark(tfr, "static chain" + suffix, "camera", "fcu", stamp, true, n_threads, n_lookups);
+      benchmark(tfr, "dynamic chain" + suffix, "camera", "world_origin", stamp, false, n_threads, n_lookups);
+    }
+  }
+
+  return 0;
+}
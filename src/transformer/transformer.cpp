@@ -43,11 +43,13 @@ namespace mrs_lib
   Transformer::Transformer(const std::string& node_name, const ros::Duration& cache_time)
     : initialized_(true), node_name_(node_name), tf_buffer_(std::make_unique<tf2_ros::Buffer>(cache_time)), tf_listener_ptr_(std::make_unique<tf2_ros::TransformListener>(*tf_buffer_))
   {
+    resetStaticCacheImpl();
   }
 
   Transformer::Transformer(const ros::NodeHandle& nh, const std::string& node_name, const ros::Duration& cache_time)
     : initialized_(true), node_name_(node_name), tf_buffer_(std::make_unique<tf2_ros::Buffer>(cache_time)), tf_listener_ptr_(std::make_unique<tf2_ros::TransformListener>(*tf_buffer_, nh))
   {
+    resetStaticCacheImpl();
   }
 
   Transformer& Transformer::operator=(Transformer&& other)
@@ -68,6 +70,17 @@ namespace mrs_lib
     got_utm_zone_ = std::move(other.got_utm_zone_);
     utm_zone_ = std::move(other.utm_zone_);
 
+    cache_enabled_ = std::move(other.cache_enabled_);
+    dynamic_cache_size_ = std::move(other.dynamic_cache_size_);
+    static_revalidation_period_ = std::move(other.static_revalidation_period_);
+    frame_ids_ = std::move(other.frame_ids_);
+    next_static_check_ = std::move(other.next_static_check_);
+    dynamic_cache_ = std::move(other.dynamic_cache_);
+    std::atomic_store(&static_cache_, std::atomic_exchange(&other.static_cache_, std::shared_ptr<const static_cache_t>()));
+    static_hits_ = other.static_hits_.load();
+    dynamic_hits_ = other.dynamic_hits_.load();
+    cache_misses_ = other.cache_misses_.load();
+
     return *this;
   }
 
@@ -77,6 +90,11 @@ namespace mrs_lib
 
   std::optional<geometry_msgs::TransformStamped> Transformer::getTransform(const std::string& from_frame_raw, const std::string& to_frame_raw, const ros::Time& time_stamp)
   {
+    // static transforms are served from the cache without locking the mutex
+    auto static_tf_opt = getStaticTransform(from_frame_raw, to_frame_raw, time_stamp);
+    if (static_tf_opt.has_value())
+      return static_tf_opt;
+
     std::scoped_lock lck(mutex_);
 
     if (!initialized_)
@@ -90,7 +108,7 @@ namespace mrs_lib
     const std::string to_frame = resolveFrameImpl(to_frame_raw);
     const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
 
-    return getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+    return getTransformCached(from_frame_raw, to_frame_raw, from_frame, to_frame, time_stamp, latlon_frame);
   }
 
   std::optional<geometry_msgs::TransformStamped> Transformer::getTransform(const std::string& from_frame_raw, const ros::Time& from_stamp, const std::string& to_frame_raw, const ros::Time& to_stamp, const std::string& fixed_frame_raw)
@@ -139,10 +157,11 @@ namespace mrs_lib
 
     const std::string from_frame = resolveFrameImpl(frame_from(tf));
     const std::string to_frame = resolveFrameImpl(frame_to(tf));
+    const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
     const geometry_msgs::TransformStamped tf_resolved = create_transform(from_frame, to_frame, tf.header.stamp, tf.transform);
 
     const geometry_msgs::Vector3 vec = mrs_lib::geometry::fromEigenVec(what);
-    const auto tfd_vec = transformImpl(tf_resolved, vec);
+    const auto tfd_vec = transformImpl(tf_resolved, vec, latlon_frame);
     if (tfd_vec.has_value())
       return mrs_lib::geometry::toEigen(tfd_vec.value());
     else
@@ -151,6 +170,17 @@ namespace mrs_lib
 
   [[nodiscard]] std::optional<Eigen::Vector3d> Transformer::transformAsVector(const std::string& from_frame_raw, const Eigen::Vector3d& what, const std::string& to_frame_raw, const ros::Time& time_stamp)
   {
+    // static transforms are served from the cache without locking the mutex
+    const auto static_tf_opt = getStaticTransform(from_frame_raw, to_frame_raw, time_stamp);
+    if (static_tf_opt.has_value())
+    {
+      const auto tfd_vec = transformImpl(static_tf_opt.value(), mrs_lib::geometry::fromEigenVec(what), "");
+      if (tfd_vec.has_value())
+        return mrs_lib::geometry::toEigen(tfd_vec.value());
+      else
+        return std::nullopt;
+    }
+
     std::scoped_lock lck(mutex_);
 
     if (!initialized_)
@@ -164,7 +194,7 @@ namespace mrs_lib
     const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
 
     // get the transform
-    const auto tf_opt = getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+    const auto tf_opt = getTransformCached(from_frame_raw, to_frame_raw, from_frame, to_frame, time_stamp, latlon_frame);
     if (!tf_opt.has_value())
       return std::nullopt;
     const geometry_msgs::TransformStamped& tf = tf_opt.value();
@@ -172,7 +202,7 @@ namespace mrs_lib
     // do the transformation
     const geometry_msgs::TransformStamped tf_resolved = create_transform(from_frame, to_frame, tf.header.stamp, tf.transform);
     const geometry_msgs::Vector3 vec = mrs_lib::geometry::fromEigenVec(what);
-    const auto tfd_vec = transformImpl(tf_resolved, vec);
+    const auto tfd_vec = transformImpl(tf_resolved, vec, latlon_frame);
     if (tfd_vec.has_value())
       return mrs_lib::geometry::toEigen(tfd_vec.value());
     else
@@ -195,13 +225,14 @@ namespace mrs_lib
 
     const std::string from_frame = resolveFrameImpl(frame_from(tf));
     const std::string to_frame = resolveFrameImpl(frame_to(tf));
+    const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
     const geometry_msgs::TransformStamped tf_resolved = create_transform(from_frame, to_frame, tf.header.stamp, tf.transform);
 
     geometry_msgs::Point pt;
     pt.x = what.x();
     pt.y = what.y();
     pt.z = what.z();
-    const auto tfd_pt = transformImpl(tf_resolved, pt);
+    const auto tfd_pt = transformImpl(tf_resolved, pt, latlon_frame);
     if (tfd_pt.has_value())
       return mrs_lib::geometry::toEigen(tfd_pt.value());
     else
@@ -210,6 +241,21 @@ namespace mrs_lib
 
   [[nodiscard]] std::optional<Eigen::Vector3d> Transformer::transformAsPoint(const std::string& from_frame_raw, const Eigen::Vector3d& what, const std::string& to_frame_raw, const ros::Time& time_stamp)
   {
+    // static transforms are served from the cache without locking the mutex
+    const auto static_tf_opt = getStaticTransform(from_frame_raw, to_frame_raw, time_stamp);
+    if (static_tf_opt.has_value())
+    {
+      geometry_msgs::Point pt;
+      pt.x = what.x();
+      pt.y = what.y();
+      pt.z = what.z();
+      const auto tfd_pt = transformImpl(static_tf_opt.value(), pt, "");
+      if (tfd_pt.has_value())
+        return mrs_lib::geometry::toEigen(tfd_pt.value());
+      else
+        return std::nullopt;
+    }
+
     std::scoped_lock lck(mutex_);
 
     if (!initialized_)
@@ -223,7 +269,7 @@ namespace mrs_lib
     const std::string latlon_frame = resolveFrameImpl(LATLON_ORIGIN);
 
     // get the transform
-    const auto tf_opt = getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+    const auto tf_opt = getTransformCached(from_frame_raw, to_frame_raw, from_frame, to_frame, time_stamp, latlon_frame);
     if (!tf_opt.has_value())
       return std::nullopt;
     const geometry_msgs::TransformStamped& tf = tf_opt.value();
@@ -234,7 +280,7 @@ namespace mrs_lib
     pt.x = what.x();
     pt.y = what.y();
     pt.z = what.z();
-    const auto tfd_pt = transformImpl(tf_resolved, pt);
+    const auto tfd_pt = transformImpl(tf_resolved, pt, latlon_frame);
     if (tfd_pt.has_value())
       return mrs_lib::geometry::toEigen(tfd_pt.value());
     else
@@ -249,7 +295,7 @@ namespace mrs_lib
 
   /* specialization for mrs_msgs::ReferenceStamped //{ */
   
-  std::optional<mrs_msgs::ReferenceStamped> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const mrs_msgs::ReferenceStamped& what)
+  std::optional<mrs_msgs::ReferenceStamped> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const mrs_msgs::ReferenceStamped& what, const std::string& latlon_frame)
   {
     // create a pose message
     geometry_msgs::PoseStamped pose;
@@ -261,7 +307,7 @@ namespace mrs_lib
     pose.pose.orientation = geometry::fromEigen(geometry::quaternionFromHeading(what.reference.heading));
   
     // try to transform the pose message
-    const auto pose_opt = transformImpl(tf, pose);
+    const auto pose_opt = transformImpl(tf, pose, latlon_frame);
     if (!pose_opt.has_value())
       return std::nullopt;
     // overwrite the pose with it's transformed value
@@ -282,11 +328,11 @@ namespace mrs_lib
 
   /* specialization for Eigen::Vector3d //{ */
   
-  std::optional<Eigen::Vector3d> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const Eigen::Vector3d& what)
+  std::optional<Eigen::Vector3d> Transformer::transformImpl(const geometry_msgs::TransformStamped& tf, const Eigen::Vector3d& what, const std::string& latlon_frame)
   {
     // just transform it as you would a geometry_msgs::Vector3
     const geometry_msgs::Vector3 as_vec = mrs_lib::geometry::fromEigenVec(what);
-    const auto opt = transformImpl(tf, as_vec);
+    const auto opt = transformImpl(tf, as_vec, latlon_frame);
     if (opt.has_value())
       return geometry::toEigen(opt.value());
     else
@@ -458,6 +504,136 @@ namespace mrs_lib
 
   //}
 
+  /* getTransformCached() //{ */
+
+  std::optional<geometry_msgs::TransformStamped> Transformer::getTransformCached(const std::string& from_frame_raw, const std::string& to_frame_raw, const std::string& from_frame, const std::string& to_frame, const ros::Time& time_stamp, const std::string& latlon_frame)
+  {
+    // identities, invalid queries and transforms from/to latlon coordinates are not cached
+    if (!cache_enabled_ || from_frame.empty() || to_frame.empty() || from_frame == to_frame || from_frame == latlon_frame || to_frame == latlon_frame)
+      return getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+
+    const uint64_t key = cacheKey(from_frame, to_frame);
+
+    // try the recently looked up non-static transforms (the latest transform changes in time, so it is not cached)
+    if (!time_stamp.isZero())
+    {
+      for (auto it = std::begin(dynamic_cache_); it != std::end(dynamic_cache_); ++it)
+      {
+        if (it->key == key && it->tf.header.stamp == time_stamp)
+        {
+          dynamic_hits_.fetch_add(1, std::memory_order_relaxed);
+          dynamic_cache_.splice(std::begin(dynamic_cache_), dynamic_cache_, it);
+          return it->tf;
+        }
+      }
+    }
+    cache_misses_.fetch_add(1, std::memory_order_relaxed);
+
+    const auto tf_opt = getTransformImpl(from_frame, to_frame, time_stamp, latlon_frame);
+    if (!tf_opt.has_value())
+      return std::nullopt;
+
+    // the latest transform of a chain of static transforms is stamped with zero time
+    // if a specific time was requested, the latest transform is looked up to check that (at most once per the revalidation period)
+    bool is_static = false;
+    const steady_tp now = std::chrono::steady_clock::now();
+    if (time_stamp.isZero())
+    {
+      is_static = tf_opt->header.stamp.isZero();
+    }
+    else
+    {
+      auto& next_check = next_static_check_[key];
+      if (now >= next_check)
+      {
+        next_check = now + static_revalidation_period_;
+        try
+        {
+          is_static = tf_buffer_->lookupTransform(to_frame, from_frame, ros::Time(0)).header.stamp.isZero();
+        }
+        catch (tf2::TransformException&)
+        {
+        }
+      }
+    }
+
+    if (is_static)
+    {
+      // add the transform to a new snapshot of the static cache
+      const auto cache_ptr = std::atomic_load(&static_cache_);
+      auto new_cache = cache_ptr ? std::make_shared<static_cache_t>(*cache_ptr) : std::make_shared<static_cache_t>();
+      new_cache->frame_ids[from_frame_raw] = frame_ids_.at(from_frame);
+      new_cache->frame_ids[to_frame_raw] = frame_ids_.at(to_frame);
+      new_cache->transforms[key] = {from_frame, to_frame, tf_opt->transform, now + static_revalidation_period_};
+      std::atomic_store(&static_cache_, std::shared_ptr<const static_cache_t>(std::move(new_cache)));
+    }
+    // only the transforms at the requested time are cached (not the ones found by retrying the lookup with the latest time)
+    else if (!time_stamp.isZero() && tf_opt->header.stamp == time_stamp && dynamic_cache_size_ > 0)
+    {
+      if (dynamic_cache_.size() >= dynamic_cache_size_)
+        dynamic_cache_.pop_back();
+      dynamic_cache_.push_front({key, tf_opt.value()});
+    }
+
+    return tf_opt;
+  }
+
+  //}
+
+  /* getStaticTransform() //{ */
+
+  std::optional<geometry_msgs::TransformStamped> Transformer::getStaticTransform(const std::string& from_frame_raw, const std::string& to_frame_raw, const ros::Time& time_stamp)
+  {
+    // this method does not lock the mutex - it only reads an immutable snapshot of the cache
+    const auto cache_ptr = std::atomic_load(&static_cache_);
+    if (!cache_ptr)
+      return std::nullopt;
+
+    const auto from_it = cache_ptr->frame_ids.find(from_frame_raw);
+    if (from_it == std::end(cache_ptr->frame_ids))
+      return std::nullopt;
+    const auto to_it = cache_ptr->frame_ids.find(to_frame_raw);
+    if (to_it == std::end(cache_ptr->frame_ids))
+      return std::nullopt;
+
+    const uint64_t key = (uint64_t(from_it->second) << 32) | to_it->second;
+    const auto tf_it = cache_ptr->transforms.find(key);
+    if (tf_it == std::end(cache_ptr->transforms) || std::chrono::steady_clock::now() >= tf_it->second.valid_until)
+      return std::nullopt;
+
+    static_hits_.fetch_add(1, std::memory_order_relaxed);
+    const static_transform_t& tf = tf_it->second;
+    return create_transform(tf.from_frame, tf.to_frame, time_stamp, tf.transform);
+  }
+
+  //}
+
+  /* cacheKey() //{ */
+
+  uint64_t Transformer::cacheKey(const std::string& from_frame, const std::string& to_frame)
+  {
+    // intern the resolved frame names
+    const auto from_id = frame_ids_.emplace(from_frame, uint32_t(frame_ids_.size())).first->second;
+    const auto to_id = frame_ids_.emplace(to_frame, uint32_t(frame_ids_.size())).first->second;
+    return (uint64_t(from_id) << 32) | to_id;
+  }
+
+  //}
+
+  /* resetStaticCacheImpl() //{ */
+
+  void Transformer::resetStaticCacheImpl()
+  {
+    // the static cache is keyed by the raw frame names, so it has to be dropped whenever the frame resolution changes
+    std::shared_ptr<const static_cache_t> new_cache;
+    if (initialized_ && cache_enabled_)
+      new_cache = std::make_shared<const static_cache_t>();
+    std::atomic_store(&static_cache_, new_cache);
+    next_static_check_.clear();
+  }
+
+  //}
+
   /* resolveFrameImpl() //{*/
 
   std::string Transformer::resolveFrameImpl(const std::string& frame_id)
@@ -0,0 +1,120 @@
+#include <geometry_msgs/PointStamped.h>
+#include <geometry_msgs/Vector3Stamped.h>
+#include <mrs_lib/approximate_time_synchronizer.h>
+#include <cmath>
+#include <iostream>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+using namespace mrs_lib;
+using namespace std;
+
+using synchronizer_t = mrs_lib::ApproximateTimeSynchronizer<geometry_msgs::PointStamped, geometry_msgs::Vector3Stamped, geometry_msgs::PointStamped>;
+
+/* TEST(TESTSuite, matching_test) //{ */
+
+TEST(TESTSuite, matching_test) {
+
+  ros::NodeHandle nh("~");
+
+  mrs_lib::SubscribeHandlerOptions shopts(nh);
+  shopts.queue_size = 100;
+
+  const std::array<std::string, 3> topic_names = {"/test_topic/a", "/test_topic/b", "/test_topic/c"};
+
+  std::vector<std::array<double, 3>> matches;
+  const auto callback = [&matches](const geometry_msgs::PointStamped::ConstPtr& a, const geometry_msgs::Vector3Stamped::ConstPtr& b,
+                                   const geometry_msgs::PointStamped::ConstPtr& c) { matches.push_back({a->point.x, b->vector.x, c->point.x}); };
+  synchronizer_t sync(shopts, topic_names, ros::Duration(0.005), callback, 3);
+
+  ros::Publisher pub_a = nh.advertise<geometry_msgs::PointStamped>(topic_names.at(0), 100);
+  ros::Publisher pub_b = nh.advertise<geometry_msgs::Vector3Stamped>(topic_names.at(1), 100);
+  ros::Publisher pub_c = nh.advertise<geometry_msgs::PointStamped>(topic_names.at(2), 100);
+
+  // spins until the condition holds or until the timeout runs out
+  const auto spin_until = [](const std::function<bool()>& condition) {
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(2.0);
+    while (!condition() && ros::WallTime::now() < end) {
+      ros::spinOnce();
+      ros::WallDuration(1e-3).sleep();
+    }
+    return condition();
+  };
+  ASSERT_TRUE(spin_until([&]() { return pub_a.getNumSubscribers() > 0 && pub_b.getNumSubscribers() > 0 && pub_c.getNumSubscribers() > 0; }));
+
+  // publishes a message with the specified stamp to the specified topic and waits until it's received
+  const ros::Time t0 = ros::Time::now();
+  const auto publish = [&](const int topic, const double stamp) {
+    const uint64_t n_received = sync.getStatistics().n_received.at(topic);
+    if (topic == 1) {
+      geometry_msgs::Vector3Stamped msg;
+      msg.header.stamp = t0 + ros::Duration(stamp);
+      msg.vector.x     = stamp;
+      pub_b.publish(msg);
+    } else {
+      geometry_msgs::PointStamped msg;
+      msg.header.stamp = t0 + ros::Duration(stamp);
+      msg.point.x      = stamp;
+      (topic == 0 ? pub_a : pub_c).publish(msg);
+    }
+    spin_until([&]() { return sync.getStatistics().n_received.at(topic) > n_received; });
+  };
+
+  // a simple match
+  publish(0, 0.000);
+  publish(1, 0.001);
+  publish(2, 0.002);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches.back(), (std::array<double, 3>{0.000, 0.001, 0.002}));
+
+  // a message is missing on the second topic, so the first messages of the other topics are dropped
+  publish(0, 0.010);
+  publish(2, 0.011);
+  publish(0, 0.020);
+  publish(1, 0.021);
+  EXPECT_EQ(matches.size(), 1u);
+  publish(2, 0.022);
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches.back(), (std::array<double, 3>{0.020, 0.021, 0.022}));
+
+  // a message older than the last one on its topic is dropped
+  publish(1, 0.031);
+  publish(1, 0.030);
+
+  // the oldest message is dropped when the queue is full
+  publish(0, 0.100);
+  publish(0, 0.110);
+  publish(0, 0.120);
+  publish(0, 0.130);
+  publish(1, 0.131);
+  publish(2, 0.132);
+  ASSERT_EQ(matches.size(), 3u);
+  EXPECT_EQ(matches.back(), (std::array<double, 3>{0.130, 0.131, 0.132}));
+
+  const synchronizer_t::statistics_t stats = sync.getStatistics();
+  EXPECT_EQ(stats.n_matched, 3u);
+  EXPECT_EQ(stats.n_received, (std::array<uint64_t, 3>{7, 5, 4}));
+  // the first topic: 0.010 unmatched, 0.100 overflowed and 0.110, 0.120 unmatched
+  // the second topic: 0.030 out of order, 0.031 unmatched
+  // the third topic: 0.011 unmatched
+  EXPECT_EQ(stats.n_dropped, (std::array<uint64_t, 3>{4, 2, 1}));
+  EXPECT_NEAR(stats.max_spread.toSec(), 0.002, 1e-6);
+
+  sync.resetStatistics();
+  EXPECT_EQ(sync.getStatistics().n_matched, 0u);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  ros::init(argc, argv, "ApproximateTimeSynchronizerTest");
+  ros::NodeHandle nh = ros::NodeHandle("~");
+
+  ros::Time::waitForValid();
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,187 @@
+#include <mrs_lib/iir_filter.h>
+#include <random>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace mrs_lib;
+
+using sections_t = IirSosFilter::sections_t;
+
+/* helper functions //{ */
+
+// a low-pass Butterworth filter of order 2*n_sections with the cutoff frequency given relative to the sampling frequency
+sections_t lowpassSections(const int n_sections, const double cutoff)
+{
+  sections_t sections(n_sections, 5);
+  const double w0 = 2.0 * M_PI * cutoff;
+  for (int i = 0; i < n_sections; i++)
+  {
+    const double q = 1.0 / (2.0 * std::sin(M_PI * (2 * i + 1) / (4.0 * n_sections)));
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    sections.row(i) << (1.0 - std::cos(w0)) / 2.0 / a0, (1.0 - std::cos(w0)) / a0, (1.0 - std::cos(w0)) / 2.0 / a0, -2.0 * std::cos(w0) / a0, (1.0 - alpha) / a0;
+  }
+  return sections;
+}
+
+// multiplies two polynomials in z^-1
+std::vector<double> multiply(const std::vector<double>& p, const std::vector<double>& q)
+{
+  std::vector<double> ret(p.size() + q.size() - 1, 0.0);
+  for (size_t i = 0; i < p.size(); i++)
+    for (size_t j = 0; j < q.size(); j++)
+      ret.at(i + j) += p.at(i) * q.at(j);
+  return ret;
+}
+
+// expands the sections to the transfer function (numerator b and denominator a)
+void toTransferFunction(const sections_t& sections, std::vector<double>& a, std::vector<double>& b)
+{
+  a = {1.0};
+  b = {1.0};
+  for (int i = 0; i < sections.rows(); i++)
+  {
+    a = multiply(a, {1.0, sections(i, 3), sections(i, 4)});
+    b = multiply(b, {sections(i, 0), sections(i, 1), sections(i, 2)});
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, sos_vs_direct_form) //{ */
+
+TEST(TESTSuite, sos_vs_direct_form)
+{
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  for (const int n_sections : {1, 2, 3})
+  {
+    const sections_t sections = lowpassSections(n_sections, 0.1);
+    std::vector<double> a, b;
+    toTransferFunction(sections, a, b);
+
+    IirFilter direct(a, b);
+    IirSosFilter sos(sections);
+    // the conversion from the transfer function should result in the same filter
+    IirSosFilter sos_converted(IirSosFilter::toSections(a, b));
+    EXPECT_EQ(sos_converted.sections().rows(), n_sections);
+
+    for (int it = 0; it < 1000; it++)
+    {
+      const double input = nd(gen);
+      const double output_sos = sos.iterate(input);
+      EXPECT_NEAR(direct.iterate(input), output_sos, 1e-9) << n_sections << " sections, iteration " << it;
+      EXPECT_NEAR(sos_converted.iterate(input), output_sos, 1e-9) << n_sections << " sections, iteration " << it;
+    }
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, to_sections) //{ */
+
+TEST(TESTSuite, to_sections)
+{
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  // a notch filter, a delayed first-order filter and a filter with a real pole and a complex pair
+  const std::vector<std::pair<std::vector<double>, std::vector<double>>> tfs = {
+      {{1.0, -1.8, 0.9}, {0.95, -1.8, 0.95}},
+      {{1.0, -0.5, 0.0}, {0.0, 0.5, 0.25}},
+      {{1.0, -1.2, 0.77, -0.1}, {0.1, 0.2, 0.2, 0.1}},
+  };
+
+  for (const auto& [a, b] : tfs)
+  {
+    IirFilter direct(a, b);
+    IirSosFilter sos(IirSosFilter::toSections(a, b));
+    for (int it = 0; it < 500; it++)
+    {
+      const double input = nd(gen);
+      EXPECT_NEAR(direct.iterate(input), sos.iterate(input), 1e-9) << "iteration " << it;
+    }
+  }
+
+  EXPECT_THROW(IirSosFilter::toSections({0.0, 1.0}, {1.0, 1.0}), std::invalid_argument);
+  EXPECT_THROW(IirSosFilter::toSections({1.0, 1.0}, {0.0, 0.0}), std::invalid_argument);
+}
+
+//}
+
+/* TEST(TESTSuite, block_and_channels) //{ */
+
+TEST(TESTSuite, block_and_channels)
+{
+  const int n_channels = 6;
+  const int n_samples = 1000;
+  const int block_length = 64;
+  const sections_t sections = lowpassSections(2, 0.05);
+
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+  const IirSosFilter::samples_t input = IirSosFilter::samples_t::NullaryExpr(n_channels, n_samples, [&]() { return nd(gen); });
+
+  // reference - separate single-channel filters, one sample at a time
+  IirSosFilter::samples_t expected(n_channels, n_samples);
+  for (int ch = 0; ch < n_channels; ch++)
+  {
+    IirSosFilter fil(sections);
+    for (int k = 0; k < n_samples; k++)
+      expected(ch, k) = fil.iterate(input(ch, k));
+  }
+
+  // single-channel blocks (the last block is shorter), in place
+  for (int ch = 0; ch < n_channels; ch++)
+  {
+    IirSosFilter fil(sections);
+    std::vector<double> samples(n_samples);
+    for (int k = 0; k < n_samples; k++)
+      samples.at(k) = input(ch, k);
+    for (int k = 0; k < n_samples; k += block_length)
+      fil.filter(samples.data() + k, samples.data() + k, std::min(block_length, n_samples - k));
+    for (int k = 0; k < n_samples; k++)
+      EXPECT_NEAR(samples.at(k), expected(ch, k), 1e-12);
+  }
+
+  // all channels, one sample at a time
+  {
+    IirSosFilter fil(sections, n_channels);
+    EXPECT_EQ(fil.channels(), size_t(n_channels));
+    Eigen::VectorXd output(n_channels);
+    for (int k = 0; k < n_samples; k++)
+    {
+      fil.iterate(input.col(k), output);
+      EXPECT_LT((output - expected.col(k)).cwiseAbs().maxCoeff(), 1e-12);
+    }
+  }
+
+  // all channels in blocks
+  {
+    IirSosFilter fil(sections, n_channels);
+    IirSosFilter::samples_t output(n_channels, n_samples);
+    for (int k = 0; k < n_samples; k += block_length)
+    {
+      const int length = std::min(block_length, n_samples - k);
+      fil.filter(input.middleCols(k, length), output.middleCols(k, length));
+    }
+    EXPECT_LT((output - expected).cwiseAbs().maxCoeff(), 1e-12);
+
+    // the filter should start from zero after a reset
+    fil.reset();
+    fil.filter(input, output);
+    EXPECT_LT((output - expected).cwiseAbs().maxCoeff(), 1e-12);
+  }
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
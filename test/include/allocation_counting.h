@@ -0,0 +1,74 @@
+/**  \file
+     \brief Counting of heap allocations for the tests checking that some code path is allocation-free
+
+     Including this header replaces the C allocation functions of the whole program (forwarding them to the glibc
+     allocator), so that all heap allocations are counted - including those made by operator new and by Eigen, which
+     allocates the dynamically-sized matrices using malloc directly. It therefore has to be included by exactly one
+     translation unit of a test executable and it cannot be combined with the sanitizers, which replace these functions too.
+     The number of allocations made so far is available in the \p n_allocations counter.
+ */
+#ifndef ALLOCATION_COUNTING_H
+#define ALLOCATION_COUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cerrno>
+
+// the underlying glibc allocator
+extern "C"
+{
+  void* __libc_malloc(size_t size) noexcept;
+  void* __libc_calloc(size_t n, size_t size) noexcept;
+  void* __libc_realloc(void* ptr, size_t size) noexcept;
+  void* __libc_memalign(size_t alignment, size_t size) noexcept;
+  void __libc_free(void* ptr) noexcept;
+}
+
+/* allocation counting //{ */
+
+// counts all heap allocations in the process
+inline std::atomic<size_t> n_allocations = 0;
+
+extern "C"
+{
+  void* malloc(size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t n, size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_calloc(n, size);
+  }
+
+  void* realloc(void* ptr, size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_realloc(ptr, size);
+  }
+
+  void* aligned_alloc(size_t alignment, size_t size) noexcept
+  {
+    n_allocations++;
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void** ptr, size_t alignment, size_t size) noexcept
+  {
+    n_allocations++;
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr == nullptr ? ENOMEM : 0;
+  }
+
+  void free(void* ptr) noexcept
+  {
+    __libc_free(ptr);
+  }
+}
+
+//}
+
+#endif // ALLOCATION_COUNTING_H
@@ -0,0 +1,209 @@
+#include <mrs_lib/lkf.h>
+#include <mrs_lib/batch_lkf.h>
+#include <random>
+#include <cmath>
+#include <iostream>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+using namespace mrs_lib;
+using namespace std;
+
+namespace mrs_lib
+{
+  const int n_states = 6;
+  const int n_inputs = 3;
+  const int n_measurements = 3;
+
+  using lkf_t = LKF<n_states, n_inputs, n_measurements>;
+  using batch_lkf_t = BatchLKF<n_states, n_inputs, n_measurements>;
+}  // namespace mrs_lib
+
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using u_t = lkf_t::u_t;
+using z_t = lkf_t::z_t;
+using R_t = lkf_t::R_t;
+using statecov_t = lkf_t::statecov_t;
+
+template class mrs_lib::BatchLKF<n_states, n_inputs, n_measurements>;
+
+/* generateSystem() function //{ */
+// a constant-velocity model in 3D with acceleration input and position measurement
+void generateSystem(const double dt, A_t& A, B_t& B, H_t& H)
+{
+  A = A_t::Identity();
+  A.topRightCorner<3, 3>().diagonal().setConstant(dt);
+  B = B_t::Zero();
+  B.topRows<3>().diagonal().setConstant(dt * dt / 2.0);
+  B.bottomRows<3>().diagonal().setConstant(dt);
+  H = H_t::Zero();
+  H.leftCols<3>().setIdentity();
+}
+//}
+
+/* TEST(TESTSuite, batch_equivalence) //{ */
+
+TEST(TESTSuite, batch_equivalence)
+{
+  const int n_filters = 13;
+  const int n_its = 200;
+  const double dt = 0.1;
+
+  A_t A;
+  B_t B;
+  H_t H;
+  generateSystem(dt, A, B, H);
+  // a full measurement noise covariance to exercise the whole Cholesky decomposition
+  R_t R;
+  R << 0.5, 0.1, 0.05,
+       0.1, 0.4, 0.02,
+       0.05, 0.02, 0.3;
+  const Q_t Q = 0.1 * Q_t::Identity();
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0 * P_t::Identity();
+
+  lkf_t lkf(A, B, H);
+  batch_lkf_t batch(A, B, H, n_filters, x0, P0);
+  std::vector<statecov_t> scs(n_filters, {x0, P0});
+
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+  std::uniform_real_distribution<> ud(0.0, 1.0);
+
+  batch_lkf_t::Us_t us(n_inputs, n_filters);
+  batch_lkf_t::Zs_t zs(n_measurements, n_filters);
+  batch_lkf_t::mask_t mask(n_filters);
+  double max_x_diff = 0.0;
+  double max_P_diff = 0.0;
+  for (int it = 0; it < n_its; it++)
+  {
+    us = batch_lkf_t::Us_t::NullaryExpr(n_inputs, n_filters, [&]() { return nd(gen); });
+    zs = batch_lkf_t::Zs_t::NullaryExpr(n_measurements, n_filters, [&]() { return 10.0 * nd(gen); });
+    mask = batch_lkf_t::mask_t::NullaryExpr(n_filters, [&]() { return ud(gen) < 0.7; });
+
+    batch.predict(us, Q, dt);
+    for (int f = 0; f < n_filters; f++)
+      scs.at(f) = lkf.predict(scs.at(f), us.col(f), Q, dt);
+
+    // alternate between correcting all the filters and only a subset of them
+    if (it % 2)
+    {
+      batch.correct(zs, R);
+      for (int f = 0; f < n_filters; f++)
+        scs.at(f) = lkf.correct(scs.at(f), zs.col(f), R);
+    } else
+    {
+      batch.correct(zs, R, mask);
+      for (int f = 0; f < n_filters; f++)
+        if (mask(f))
+          scs.at(f) = lkf.correct(scs.at(f), zs.col(f), R);
+    }
+
+    for (int f = 0; f < n_filters; f++)
+    {
+      const statecov_t sc = batch.get(f);
+      max_x_diff = std::max(max_x_diff, (sc.x - scs.at(f).x).cwiseAbs().maxCoeff());
+      max_P_diff = std::max(max_P_diff, (sc.P - scs.at(f).P).cwiseAbs().maxCoeff());
+    }
+  }
+
+  EXPECT_LT(max_x_diff, 1e-9);
+  EXPECT_LT(max_P_diff, 1e-9);
+
+  // set() and get() should be consistent and only affect a single filter
+  const statecov_t sc_new = {x_t::Ones(), 2.0 * P_t::Identity()};
+  batch.set(3, sc_new);
+  EXPECT_TRUE(batch.get(3).x.isApprox(sc_new.x));
+  EXPECT_TRUE(batch.get(3).P.isApprox(sc_new.P));
+  EXPECT_TRUE(batch.get(4).x.isApprox(scs.at(4).x));
+
+  // an invalid measurement covariance should throw
+  EXPECT_THROW(batch.correct(zs, -100.0 * R_t::Identity()), batch_lkf_t::inverse_exception);
+
+  // an invalid covariance of an unselected filter should neither throw nor affect the filter
+  const statecov_t sc_invalid = {x_t::Ones(), -100.0 * P_t::Identity()};
+  batch.set(5, sc_invalid);
+  mask.setConstant(true);
+  mask(5) = false;
+  EXPECT_NO_THROW(batch.correct(zs, R, mask));
+  EXPECT_TRUE(batch.get(5).x.isApprox(sc_invalid.x));
+  EXPECT_TRUE(batch.get(5).P.isApprox(sc_invalid.P));
+  mask(5) = true;
+  EXPECT_THROW(batch.correct(zs, R, mask), batch_lkf_t::inverse_exception);
+}
+
+//}
+
+/* TEST(TESTSuite, correction_modes) //{ */
+
+TEST(TESTSuite, correction_modes)
+{
+  using mode_t = lkf_t::correction_mode_t;
+  const double dt = 0.1;
+
+  A_t A;
+  B_t B;
+  H_t H;
+  generateSystem(dt, A, B, H);
+  // measure also the velocities with a different scale to make H less trivial
+  H.rightCols<3>() = 0.5 * Eigen::Matrix3d::Identity();
+
+  lkf_t lkf_standard(A, B, H);
+  std::vector<std::pair<mode_t, lkf_t>> lkfs;
+  for (const auto mode : {mode_t::joseph, mode_t::information, mode_t::sequential})
+  {
+    lkfs.push_back({mode, lkf_t(A, B, H)});
+    lkfs.back().second.setCorrectionMode(mode);
+    EXPECT_EQ(lkfs.back().second.getCorrectionMode(), mode);
+  }
+
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  for (int it = 0; it < 100; it++)
+  {
+    // a random positive definite state covariance
+    const P_t P_tmp = P_t::NullaryExpr([&]() { return nd(gen); });
+    const statecov_t sc = {x_t::NullaryExpr([&]() { return nd(gen); }), P_tmp * P_tmp.transpose() + 0.1 * P_t::Identity()};
+    const z_t z = z_t::NullaryExpr([&]() { return nd(gen); });
+
+    // alternate between a diagonal and a full measurement covariance
+    R_t R = R_t::Identity() + R_t(z_t::NullaryExpr([&]() { return std::abs(nd(gen)); }).asDiagonal());
+    if (it % 2)
+    {
+      const R_t R_tmp = R_t::NullaryExpr([&]() { return nd(gen); });
+      R += R_tmp * R_tmp.transpose();
+    }
+
+    const statecov_t sc_standard = lkf_standard.correct(sc, z, R);
+    for (const auto& [mode, lkf] : lkfs)
+    {
+      const statecov_t sc_mode = lkf.correct(sc, z, R);
+      EXPECT_LT((sc_mode.x - sc_standard.x).cwiseAbs().maxCoeff(), 1e-9) << "mode " << int(mode);
+      EXPECT_LT((sc_mode.P - sc_standard.P).cwiseAbs().maxCoeff(), 1e-9) << "mode " << int(mode);
+    }
+  }
+
+  // an invalid measurement covariance should throw in the modes, which do not regularize it
+  for (const auto& [mode, lkf] : lkfs)
+  {
+    if (mode == mode_t::joseph)
+      continue;
+    EXPECT_THROW(lkf.correct({x_t::Zero(), P_t::Identity()}, z_t::Zero(), -100.0 * R_t::Identity()), lkf_t::inverse_exception);
+  }
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -1,9 +1,14 @@
 #include <mrs_lib/median_filter.h>
+#include <mrs_lib/multi_median_filter.h>
 #include <iostream>
 
 #include <gtest/gtest.h>
 
 #include <random>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 /* randd() //{ */
 
@@ -178,6 +183,213 @@ TEST(TESTSuite, copy)
 
 //}
 
+/* TEST(TESTSuite, sliding_window) //{ */
+
+// the straightforward O(n log n) median of the buffered values for reference
+double referenceMedian(const boost::circular_buffer<double>& buffer)
+{
+  const size_t n = buffer.size();
+  if (n == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> sorted(std::begin(buffer), std::end(buffer));
+  std::sort(std::begin(sorted), std::end(sorted));
+  if (n % 2 == 0)
+    return (sorted.at(n/2) + sorted.at(n/2-1))/2.0;
+  else
+    return sorted.at(n/2);
+}
+
+TEST(TESTSuite, sliding_window)
+{
+  std::mt19937 gen(42);
+  // use a small range of integers so that there are plenty of duplicate values
+  std::uniform_int_distribution<> ud(-20, 20);
+
+  for (const size_t bfr_len : {1, 2, 3, 4, 7, 10, 31, 64})
+  {
+    mrs_lib::MedianFilter fil(bfr_len);
+    boost::circular_buffer<double> buffer(bfr_len);
+    const auto add = [&](const double value)
+    {
+      fil.add(value);
+      buffer.push_back(value);
+    };
+
+    for (int it = 0; it < 500; it++)
+    {
+      add(ud(gen));
+      ASSERT_EQ(fil.median(), referenceMedian(buffer)) << "buffer length " << bfr_len << ", iteration " << it;
+    }
+
+    // shrinking the buffer discards some of the values
+    fil.setBufferLength(bfr_len/2 + 1);
+    buffer.set_capacity(bfr_len/2 + 1);
+    EXPECT_EQ(fil.median(), referenceMedian(buffer));
+
+    // growing the buffer keeps all the values
+    fil.setBufferLength(2*bfr_len);
+    buffer.set_capacity(2*bfr_len);
+    for (int it = 0; it < 100; it++)
+    {
+      add(ud(gen));
+      ASSERT_EQ(fil.median(), referenceMedian(buffer)) << "buffer length " << 2*bfr_len << ", iteration " << it;
+    }
+
+    // a nan in the buffer results in a nan median until it is evicted
+    add(std::numeric_limits<double>::quiet_NaN());
+    EXPECT_TRUE(std::isnan(fil.median()));
+    for (size_t it = 0; it < 2*bfr_len; it++)
+      add(ud(gen));
+    EXPECT_EQ(fil.median(), referenceMedian(buffer));
+
+    fil.clear();
+    EXPECT_TRUE(std::isnan(fil.median()));
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, single_writer) //{ */
+
+TEST(TESTSuite, single_writer)
+{
+  using threading_mode_t = mrs_lib::MedianFilter::threading_mode_t;
+  constexpr size_t bfr_len = 5;
+
+  // the single-writer mode should give the same results as the default one
+  mrs_lib::MedianFilter fil_locking(bfr_len, 0, 100, 10);
+  mrs_lib::MedianFilter fil(bfr_len, 0, 100, 10);
+  EXPECT_EQ(fil.getThreadingMode(), threading_mode_t::locking);
+  fil.setThreadingMode(threading_mode_t::single_writer);
+  EXPECT_EQ(fil.getThreadingMode(), threading_mode_t::single_writer);
+  EXPECT_TRUE(std::isnan(fil.median()));
+  EXPECT_FALSE(fil.initialized());
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> ud(-10.0, 110.0);
+  for (int it = 0; it < 200; it++)
+  {
+    const double value = ud(gen);
+    EXPECT_EQ(fil.addCheck(value), fil_locking.addCheck(value));
+    EXPECT_EQ(fil.median(), fil_locking.median());
+    EXPECT_EQ(fil.full(), fil_locking.full());
+    EXPECT_EQ(fil.initialized(), fil_locking.initialized());
+  }
+  // the state of a filter filled in the locking mode should be visible after switching to the single-writer mode
+  fil_locking.setThreadingMode(threading_mode_t::single_writer);
+  EXPECT_EQ(fil_locking.median(), fil.median());
+  EXPECT_TRUE(fil_locking.full());
+  EXPECT_TRUE(fil_locking.initialized());
+
+  fil.setBufferLength(2*bfr_len);
+  EXPECT_FALSE(fil.full());
+  fil.clear();
+  EXPECT_TRUE(std::isnan(fil.median()));
+  EXPECT_FALSE(fil.initialized());
+
+  // the readers should always see a consistent median of an increasing sequence without blocking the writer
+  constexpr int n_values = 200000;
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  std::vector<bool> readers_ok(4, true);
+  fil.add(0);
+  for (size_t r = 0; r < readers_ok.size(); r++)
+  {
+    readers.emplace_back([&, r]()
+    {
+      double last_median = 0.0;
+      while (!done)
+      {
+        const double median = fil.median();
+        // the buffer contains consecutive integers, so the median is either an integer or halfway between two
+        if (std::isnan(median) || median < last_median || std::floor(2.0*median) != 2.0*median)
+          readers_ok.at(r) = false;
+        last_median = median;
+      }
+    });
+  }
+  for (int it = 1; it < n_values; it++)
+    fil.add(it);
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  for (const bool ok : readers_ok)
+    EXPECT_TRUE(ok);
+  EXPECT_EQ(fil.median(), n_values - 1 - (2.0*bfr_len - 1)/2.0);
+}
+
+//}
+
+/* TEST(TESTSuite, multi_channel) //{ */
+
+TEST(TESTSuite, multi_channel)
+{
+  constexpr size_t n_channels = 13;
+  std::mt19937 gen(42);
+  // use a small range of integers so that there are plenty of duplicate values
+  std::uniform_int_distribution<> ud(-20, 20);
+  std::uniform_real_distribution<> ud_nan(0.0, 1.0);
+
+  // cover both the sorting networks and the selection for longer buffers
+  for (const size_t bfr_len : {1, 2, 3, 4, 5, 8, 15, 16, 17, 32, 64})
+  {
+    mrs_lib::MultiMedianFilter multi_fil(n_channels, bfr_len, -18, 18, 15);
+    std::vector<mrs_lib::MedianFilter> fils(n_channels, mrs_lib::MedianFilter(bfr_len, -18, 18, 15));
+    EXPECT_TRUE(multi_fil.initialized());
+    EXPECT_EQ(multi_fil.channels(), n_channels);
+    EXPECT_TRUE(multi_fil.median().array().isNaN().all());
+
+    // use different thresholds for some channels
+    mrs_lib::MultiMedianFilter::values_t max_diffs = mrs_lib::MultiMedianFilter::values_t::Constant(n_channels, 15);
+    max_diffs(0) = 5;
+    max_diffs(1) = 100;
+    multi_fil.setMaxDifference(max_diffs);
+    fils.at(0).setMaxDifference(5);
+    fils.at(1).setMaxDifference(100);
+
+    mrs_lib::MultiMedianFilter::values_t values(n_channels);
+    for (int it = 0; it < 300; it++)
+    {
+      for (size_t ch = 0; ch < n_channels; ch++)
+        values(ch) = ud_nan(gen) < 0.005 ? std::numeric_limits<double>::quiet_NaN() : ud(gen);
+
+      const mrs_lib::MultiMedianFilter::mask_t valid = multi_fil.addCheck(values);
+      const mrs_lib::MultiMedianFilter::values_t median = multi_fil.median();
+      for (size_t ch = 0; ch < n_channels; ch++)
+      {
+        EXPECT_EQ(valid(ch), fils.at(ch).addCheck(values(ch))) << "buffer length " << bfr_len << ", iteration " << it << ", channel " << ch;
+        const double expected = fils.at(ch).median();
+        if (std::isnan(expected))
+          EXPECT_TRUE(std::isnan(median(ch)));
+        else
+          ASSERT_EQ(median(ch), expected) << "buffer length " << bfr_len << ", iteration " << it << ", channel " << ch;
+      }
+      EXPECT_EQ(multi_fil.full(), fils.front().full());
+    }
+
+    // the newest values should be kept when shrinking the buffer
+    multi_fil.setBufferLength(bfr_len + 3);
+    const mrs_lib::MultiMedianFilter::values_t median_before = multi_fil.median();
+    multi_fil.setBufferLength(bfr_len);
+    const mrs_lib::MultiMedianFilter::values_t median_after = multi_fil.median();
+    for (size_t ch = 0; ch < n_channels; ch++)
+      EXPECT_TRUE(median_before(ch) == median_after(ch) || (std::isnan(median_before(ch)) && std::isnan(median_after(ch))));
+    multi_fil.setBufferLength(1);
+    EXPECT_TRUE(multi_fil.full());
+    EXPECT_TRUE((multi_fil.median().array() == values.array() || values.array().isNaN()).all());
+
+    multi_fil.clear();
+    EXPECT_FALSE(multi_fil.full());
+    EXPECT_TRUE(multi_fil.median().array().isNaN().all());
+  }
+
+  mrs_lib::MultiMedianFilter multi_fil;
+  EXPECT_FALSE(multi_fil.initialized());
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
   // initialize the random number generator
@@ -0,0 +1,141 @@
+#include <mrs_lib/notch_filter.h>
+#include <random>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <allocation_counting.h>
+
+using namespace mrs_lib;
+
+const double sample_rate = 1000.0;
+
+/* amplitude() function //{ */
+
+// returns the amplitude of the filtered sine wave after the transient response
+double amplitude(NotchFilterBank& bank, const double frequency)
+{
+  bank.reset();
+  double max = 0.0;
+  for (int k = 0; k < 4000; k++)
+  {
+    const double output = bank.iterate(std::sin(2.0 * M_PI * frequency * k / sample_rate));
+    if (k > 3000)
+      max = std::max(max, std::abs(output));
+  }
+  return max;
+}
+
+//}
+
+/* TEST(TESTSuite, single_notch) //{ */
+
+TEST(TESTSuite, single_notch)
+{
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  // a bank with a single notch should be the same as the NotchFilter
+  for (const auto& [frequency, bandwidth] : std::vector<std::pair<double, double>>{{50.0, 10.0}, {123.0, 30.0}, {400.0, 20.0}})
+  {
+    NotchFilter notch(sample_rate, frequency, bandwidth);
+    NotchFilterBank bank(sample_rate, {frequency}, {bandwidth});
+    EXPECT_EQ(bank.size(), 1u);
+    for (int it = 0; it < 1000; it++)
+    {
+      double input = nd(gen);
+      EXPECT_NEAR(bank.iterate(input), notch.iterate(input), 1e-9) << frequency << " Hz, iteration " << it;
+    }
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, multiple_notches) //{ */
+
+TEST(TESTSuite, multiple_notches)
+{
+  const std::vector<double> frequencies = {80.0, 160.0, 240.0};
+  const std::vector<double> bandwidths = {10.0, 10.0, 10.0};
+  const int n_channels = 3;
+  const int n_samples = 1000;
+
+  // the notch frequencies should be removed, while the rest of the signal should pass
+  NotchFilterBank bank(sample_rate, frequencies, bandwidths);
+  for (const auto frequency : frequencies)
+    EXPECT_LT(amplitude(bank, frequency), 0.01) << frequency << " Hz";
+  EXPECT_GT(amplitude(bank, 20.0), 0.95);
+  EXPECT_GT(amplitude(bank, 120.0), 0.9);
+
+  // filtering blocks of all channels should be the same as filtering each channel by a series of NotchFilters
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+  const IirSosFilter::samples_t input = IirSosFilter::samples_t::NullaryExpr(n_channels, n_samples, [&]() { return nd(gen); });
+
+  IirSosFilter::samples_t expected(n_channels, n_samples);
+  for (int ch = 0; ch < n_channels; ch++)
+  {
+    std::vector<NotchFilter> notches;
+    for (size_t i = 0; i < frequencies.size(); i++)
+      notches.emplace_back(sample_rate, frequencies.at(i), bandwidths.at(i));
+    for (int k = 0; k < n_samples; k++)
+    {
+      double sample = input(ch, k);
+      for (auto& notch : notches)
+        sample = notch.iterate(sample);
+      expected(ch, k) = sample;
+    }
+  }
+
+  NotchFilterBank multi_bank(sample_rate, frequencies, bandwidths, n_channels);
+  IirSosFilter::samples_t output(n_channels, n_samples);
+  multi_bank.filter(input.leftCols(n_samples / 2), output.leftCols(n_samples / 2));
+  multi_bank.filter(input.rightCols(n_samples / 2), output.rightCols(n_samples / 2));
+  EXPECT_LT((output - expected).cwiseAbs().maxCoeff(), 1e-9);
+}
+
+//}
+
+/* TEST(TESTSuite, retuning) //{ */
+
+TEST(TESTSuite, retuning)
+{
+  NotchFilterBank bank(sample_rate, {80.0, 160.0}, {10.0, 10.0});
+  NotchFilterBank bank_expected(sample_rate, {100.0, 200.0}, {10.0, 20.0});
+
+  // invalid parameters should be refused and the notches kept
+  EXPECT_FALSE(bank.setFrequency(2, 100.0));
+  EXPECT_FALSE(bank.setFrequency(0, 600.0));
+  EXPECT_FALSE(bank.setFrequency(0, 100.0, -10.0));
+  EXPECT_FALSE(bank.setFrequencies({100.0}));
+  EXPECT_EQ(bank.getFrequency(0), 80.0);
+
+  // re-tuning should not allocate any memory
+  const std::vector<double> frequencies = {100.0, 200.0};
+  const size_t allocations_start = n_allocations;
+  EXPECT_TRUE(bank.setFrequencies(frequencies));
+  EXPECT_TRUE(bank.setFrequency(1, 200.0, 20.0));
+  const size_t allocations = n_allocations - allocations_start;
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_EQ(bank.getFrequency(0), 100.0);
+  EXPECT_EQ(bank.getFrequency(1), 200.0);
+
+  // the re-tuned bank should behave as a newly constructed one
+  bank.reset();
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+  for (int it = 0; it < 1000; it++)
+  {
+    const double input = nd(gen);
+    EXPECT_NEAR(bank.iterate(input), bank_expected.iterate(input), 1e-12);
+  }
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
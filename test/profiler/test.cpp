@@ -0,0 +1,126 @@
+#include <mrs_lib/profiler.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+using namespace mrs_lib;
+using namespace std;
+
+/* TEST(TESTSuite, aggregation_test) //{ */
+
+struct summary_obj_t
+{
+  std::mutex mtx;
+  // the summed counters of each routine over all received summaries
+  std::map<std::string, std::map<std::string, double>> totals;
+  bool percentiles_ok = true;
+
+  void callback(const diagnostic_msgs::DiagnosticArray::ConstPtr& msg)
+  {
+    std::scoped_lock lck(mtx);
+    for (const auto& status : msg->status)
+    {
+      std::map<std::string, double> values;
+      for (const auto& kv : status.values)
+        values[kv.key] = std::stod(kv.value);
+
+      for (const std::string key : {"count", "late", "overrun"})
+        totals[status.name][key] += values[key];
+
+      if (values["count"] > 0 && !(values["p50"] <= values["p95"] && values["p95"] <= values["p99"] && values["p99"] <= values["max"]))
+      {
+        ROS_ERROR_STREAM("Inconsistent percentiles of routine " << status.name << ": p50 " << values["p50"] << ", p95 " << values["p95"] << ", p99 "
+                                                                 << values["p99"] << ", max " << values["max"]);
+        percentiles_ok = false;
+      }
+      if (values["count"] > 0 && values["p50"] < 0.001)
+      {
+        ROS_ERROR_STREAM("The median duration of routine " << status.name << " is shorter than its sleep: " << values["p50"]);
+        percentiles_ok = false;
+      }
+    }
+  }
+};
+
+TEST(TESTSuite, aggregation_test)
+{
+  ros::NodeHandle nh("~");
+
+  summary_obj_t summary_obj;
+  ros::Subscriber sub = nh.subscribe("profiler_summary", 100, &summary_obj_t::callback, &summary_obj);
+
+  mrs_lib::Profiler profiler(nh, "ProfilerTest", true, 20.0);
+  // the copies of the profiler aggregate to the same summaries
+  mrs_lib::Profiler profiler_copy = profiler;
+
+  const int n_runs = 50;
+  const double period = 0.01;
+
+  // an aperiodic routine run from two threads
+  const auto run_aperiodic = [n_runs](mrs_lib::Profiler& prof) {
+    for (int it = 0; it < n_runs; it++)
+    {
+      mrs_lib::Routine routine = prof.createRoutine("aperiodic");
+      ros::Duration(0.001).sleep();
+    }
+  };
+  std::thread thread_aperiodic(run_aperiodic, std::ref(profiler_copy));
+  run_aperiodic(profiler);
+  thread_aperiodic.join();
+
+  // a routine ended by another thread than the one which started it
+  {
+    mrs_lib::Routine routine = profiler.createRoutine("aperiodic");
+    ros::Duration(0.001).sleep();
+    std::thread([&routine]() { routine.end(); }).join();
+  }
+
+  // a periodic routine, every fifth run is started late and every tenth run overruns its period
+  for (int it = 0; it < n_runs; it++)
+  {
+    ros::TimerEvent event;
+    event.current_expected = ros::Time::now();
+    event.current_real = event.current_expected + ros::Duration(it % 5 == 0 ? 0.005 : 0.0);
+    mrs_lib::Routine routine = profiler.createRoutine("periodic", 1.0 / period, 0.002, event);
+    ros::Duration(it % 10 == 0 ? 1.5 * period : 0.001).sleep();
+  }
+
+  // wait for the summaries of all the runs
+  const auto all_received = [&summary_obj]() {
+    std::scoped_lock lck(summary_obj.mtx);
+    return summary_obj.totals["ProfilerTest: aperiodic"]["count"] == 2 * n_runs + 1 && summary_obj.totals["ProfilerTest: periodic"]["count"] == n_runs;
+  };
+  const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(5.0);
+  while (!all_received() && ros::WallTime::now() < end)
+  {
+    ros::spinOnce();
+    ros::WallDuration(0.01).sleep();
+  }
+
+  std::scoped_lock lck(summary_obj.mtx);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: aperiodic"]["count"], 2 * n_runs + 1);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: aperiodic"]["late"], 0);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: aperiodic"]["overrun"], 0);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: periodic"]["count"], n_runs);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: periodic"]["late"], n_runs / 5);
+  EXPECT_EQ(summary_obj.totals["ProfilerTest: periodic"]["overrun"], n_runs / 10);
+  EXPECT_TRUE(summary_obj.percentiles_ok);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  ros::init(argc, argv, "ProfilerTest");
+  ros::NodeHandle nh("~");
+
+  ros::Time::waitForValid();
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
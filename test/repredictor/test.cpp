@@ -4,10 +4,12 @@
 
 // Include the Repredictor header
 #include <mrs_lib/repredictor.h>
+#include <mrs_lib/concurrent_repredictor.h>
 // As a model, we'll use a LKF variant
 #include <mrs_lib/lkf.h>
 #include <random>
 #include <fstream>
+#include <thread>
 #include <ros/ros.h>
 
 #include <gtest/gtest.h>
@@ -502,6 +504,448 @@ TEST(TESTSuite, dumblkf_comparison2)
 
 //}
 
+/* class FullReplayRepredictor //{ */
+
+// a reference implementation of the reprediction, which replays the whole history buffer on each request (without the cached posteriors)
+class FullReplayRepredictor : public rep_t
+{
+public:
+  using rep_t::Repredictor;
+
+  statecov_t predictToFullReplay(const ros::Time& to_stamp)
+  {
+    auto hist_it = std::begin(m_history);
+    auto cur_stamp = hist_it->stamp;
+    auto cur_sc = m_sc;
+    bool first = true;
+    do
+    {
+      cur_sc.stamp = hist_it->stamp;
+      // the first history point is already included in m_sc
+      if (hist_it->is_measurement && !first)
+        cur_sc = correctFrom(cur_sc, *hist_it);
+      first = false;
+
+      ros::Time next_stamp = to_stamp;
+      if ((hist_it + 1) != std::end(m_history) && (hist_it + 1)->stamp <= to_stamp)
+        next_stamp = (hist_it + 1)->stamp;
+
+      cur_sc = predictFrom(cur_sc, *hist_it, cur_stamp, next_stamp);
+      cur_stamp = next_stamp;
+      hist_it++;
+    } while (hist_it != std::end(m_history) && hist_it->stamp <= to_stamp);
+    cur_sc.stamp = to_stamp;
+    return cur_sc;
+  }
+};
+
+//}
+
+/* TEST(TESTSuite, cached_reprediction) //{ */
+
+TEST(TESTSuite, cached_reprediction)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_infos = 1e3;
+  // test both with and without removing of the old elements from the history buffer
+  const std::vector<unsigned> hist_lens = {n_infos, 50};
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  for (const auto hist_len : hist_lens)
+  {
+    std::cout << "Testing with history length " << hist_len << "." << std::endl;
+    // this Repredictor will be queried after each update, so it will use the cached posteriors
+    rep_t rep_cached(x0, P0, u0, Q, t0, lkf, hist_len);
+    // this Repredictor will only be queried once at the end, so it will have to go through the whole history
+    rep_t rep_full(x0, P0, u0, Q, t0, lkf, hist_len);
+    // this Repredictor replays the whole history without the cached posteriors on each query as a reference
+    FullReplayRepredictor rep_replay(x0, P0, u0, Q, t0, lkf, hist_len);
+
+    double max_x_diff = 0.0;
+    double max_P_diff = 0.0;
+
+    ros::Time stamp = t0;
+    for (int it = 0; it < n_infos; it++)
+    {
+      stamp += ros::Duration(std::abs(d(gen))*0.01);
+      // add some of the measurements with a delay to make them out-of-order
+      const double delay = d(gen) > 1.0 ? std::abs(d(gen))*0.05 : 0.0;
+      const ros::Time info_stamp = stamp - ros::Duration(std::min(delay, (stamp-t0).toSec()/2.0));
+      if (d(gen) > 0.0)
+      {
+        const z_t z = z_t::Random();
+        rep_cached.addMeasurement(z, R, info_stamp);
+        rep_full.addMeasurement(z, R, info_stamp);
+        rep_replay.addMeasurement(z, R, info_stamp);
+      }
+      else
+      {
+        const u_t u = u_t::Random();
+        rep_cached.addInputChangeWithNoise(u, Q, info_stamp);
+        rep_full.addInputChangeWithNoise(u, Q, info_stamp);
+        rep_replay.addInputChangeWithNoise(u, Q, info_stamp);
+      }
+      // query the estimate at a slightly older time to exercise predicting from the middle of the history
+      const ros::Time older_stamp = stamp - ros::Duration(std::min(0.02, (stamp-t0).toSec()));
+      for (const auto& query_stamp : {older_stamp, stamp})
+      {
+        const auto sc_cached = rep_cached.predictTo(query_stamp);
+        const auto sc_replay = rep_replay.predictToFullReplay(query_stamp);
+        max_x_diff = std::max(max_x_diff, (sc_cached.x-sc_replay.x).cwiseAbs().maxCoeff());
+        max_P_diff = std::max(max_P_diff, (sc_cached.P-sc_replay.P).cwiseAbs().maxCoeff());
+      }
+    }
+    EXPECT_LT(max_x_diff, 1e-9);
+    EXPECT_LT(max_P_diff, 1e-9);
+
+    const auto sc_cached = rep_cached.predictTo(stamp);
+    const auto sc_full = rep_full.predictTo(stamp);
+    EXPECT_DOUBLE_EQ((sc_cached.x-sc_full.x).norm(), 0.0);
+    EXPECT_DOUBLE_EQ((sc_cached.P-sc_full.P).norm(), 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, batch_measurements) //{ */
+
+TEST(TESTSuite, batch_measurements)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_bursts = 1e2;
+  const int burst_size = 8;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // this Repredictor will get the measurements one by one
+  rep_t rep_single(x0, P0, u0, Q, t0, lkf, n_bursts*(burst_size+1)+1);
+  // this Repredictor will get the measurements in bursts
+  rep_t rep_batch(x0, P0, u0, Q, t0, lkf, n_bursts*(burst_size+1)+1);
+
+  ros::Time stamp = t0;
+  std::vector<rep_t::measurement_t> burst;
+  for (int it = 0; it < n_bursts; it++)
+  {
+    // first, add a system input
+    stamp += ros::Duration(0.1 + std::abs(d(gen))*0.1);
+    const u_t u = u_t::Random();
+    rep_single.addInputChangeWithNoise(u, Q, stamp);
+    rep_batch.addInputChangeWithNoise(u, Q, stamp);
+
+    // then generate a burst of delayed measurements in random order with some of them older than the input
+    burst.clear();
+    for (int meas_it = 0; meas_it < burst_size; meas_it++)
+    {
+      const ros::Time meas_stamp = stamp - ros::Duration(0.05 + 0.01*meas_it);
+      burst.push_back({z_t::Random(), R, meas_stamp});
+    }
+    std::shuffle(std::begin(burst), std::end(burst), gen);
+
+    for (const auto& meas : burst)
+      rep_single.addMeasurement(meas.z, meas.R, meas.stamp);
+    rep_batch.addMeasurements(burst);
+
+    const auto sc_single = rep_single.predictTo(stamp);
+    const auto sc_batch = rep_batch.predictTo(stamp);
+    EXPECT_DOUBLE_EQ((sc_single.x-sc_batch.x).norm(), 0.0);
+    EXPECT_DOUBLE_EQ((sc_single.P-sc_batch.P).norm(), 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, concurrent_intake) //{ */
+
+TEST(TESTSuite, concurrent_intake)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_threads = 4;
+  const int n_meass_per_thread = 500;
+  const unsigned hist_len = n_threads*n_meass_per_thread+1;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // prepare the measurements for each thread with unique stamps
+  std::vector<std::vector<rep_t::measurement_t>> thread_meass(n_threads);
+  for (int meas_it = 0; meas_it < n_meass_per_thread; meas_it++)
+    for (int thread_it = 0; thread_it < n_threads; thread_it++)
+      thread_meass.at(thread_it).push_back({z_t::Random(), R, t0 + ros::Duration(0.01*(1 + meas_it*n_threads + thread_it))});
+
+  ConcurrentRepredictor<lkf_t> rep_concurrent(x0, P0, u0, Q, t0, lkf, hist_len, 64);
+  std::atomic<int> n_running = n_threads;
+  std::atomic<uint64_t> n_failed = 0;
+  std::vector<std::thread> threads;
+  for (int thread_it = 0; thread_it < n_threads; thread_it++)
+  {
+    threads.emplace_back([&rep_concurrent, &thread_meass, &n_running, &n_failed, thread_it]()
+        {
+          for (const auto& meas : thread_meass.at(thread_it))
+          {
+            // retry until the owner thread drains the queue
+            while (!rep_concurrent.enqueueMeasurement(meas.z, meas.R, meas.stamp))
+            {
+              n_failed++;
+              std::this_thread::yield();
+            }
+          }
+          n_running--;
+        });
+  }
+  // keep predicting from the owner thread while the producers are running
+  while (n_running > 0)
+    rep_concurrent.predictTo(t0 + ros::Duration(0.01*hist_len));
+  for (auto& thread : threads)
+    thread.join();
+
+  rep_t rep_single(x0, P0, u0, Q, t0, lkf, hist_len);
+  for (const auto& meass : thread_meass)
+    rep_single.addMeasurements(meass);
+
+  const ros::Time end_stamp = t0 + ros::Duration(0.01*(hist_len+1));
+  const auto sc_concurrent = rep_concurrent.predictTo(end_stamp);
+  const auto sc_single = rep_single.predictTo(end_stamp);
+  EXPECT_EQ(rep_concurrent.droppedCount(), n_failed);
+  EXPECT_DOUBLE_EQ((sc_concurrent.x-sc_single.x).norm(), 0.0);
+  EXPECT_DOUBLE_EQ((sc_concurrent.P-sc_single.P).norm(), 0.0);
+}
+
+//}
+
+/* TEST(TESTSuite, model_registry) //{ */
+
+TEST(TESTSuite, model_registry)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_infos = 1e3;
+  const int n_models = 100;
+  const unsigned hist_len = 50;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  // Instantiate many identical copies of the model so that the registry of models has to be cleaned up
+  std::vector<std::shared_ptr<lkf_t>> lkfs;
+  for (int it = 0; it < n_models; it++)
+    lkfs.push_back(std::make_shared<lkf_t>(generateA, generateB, H));
+
+  // this Repredictor will only use the default model
+  rep_t rep_default(x0, P0, u0, Q, t0, lkf, hist_len);
+  // this Repredictor will use the copies of the model
+  rep_t rep_models(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  ros::Time stamp = t0;
+  std::uniform_int_distribution<> ud(0, n_models-1);
+  for (int it = 0; it < n_infos; it++)
+  {
+    stamp += ros::Duration(std::abs(d(gen))*0.01);
+    // cycle through the models so that some of them get out of the history buffer
+    const auto& model = lkfs.at((it/10) % n_models);
+    if (d(gen) > 0.0)
+    {
+      const z_t z = z_t::Random();
+      rep_default.addMeasurement(z, R, stamp);
+      rep_models.addMeasurement(z, R, stamp, model);
+    }
+    else
+    {
+      const u_t u = u_t::Random();
+      rep_default.addInputChangeWithNoise(u, Q, stamp);
+      rep_models.addInputChangeWithNoise(u, Q, stamp, lkfs.at(ud(gen)));
+    }
+    const auto sc_default = rep_default.predictTo(stamp);
+    const auto sc_models = rep_models.predictTo(stamp);
+    EXPECT_DOUBLE_EQ((sc_default.x-sc_models.x).norm(), 0.0);
+    EXPECT_DOUBLE_EQ((sc_default.P-sc_models.P).norm(), 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, model_registry_batch) //{ */
+
+TEST(TESTSuite, model_registry_batch)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_bursts = 5;
+  // more models than the initial size of the registry, at which the unused models are removed
+  const int n_models = 60;
+  const unsigned hist_len = 2*n_models;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // this Repredictor will only use the default model
+  rep_t rep_default(x0, P0, u0, Q, t0, lkf, hist_len);
+  // this Repredictor will use a different copy of the model for each measurement of a burst
+  rep_t rep_models(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  ros::Time stamp = t0;
+  std::vector<rep_t::measurement_t> burst_default;
+  std::vector<rep_t::measurement_t> burst_models;
+  for (int it = 0; it < n_bursts; it++)
+  {
+    burst_default.clear();
+    burst_models.clear();
+    for (int meas_it = 0; meas_it < n_models; meas_it++)
+    {
+      stamp += ros::Duration(0.01);
+      const z_t z = z_t::Random();
+      burst_default.push_back({z, R, stamp});
+      burst_models.push_back({z, R, stamp, std::make_shared<lkf_t>(generateA, generateB, H)});
+    }
+    std::shuffle(std::begin(burst_models), std::end(burst_models), gen);
+    rep_default.addMeasurements(burst_default);
+    rep_models.addMeasurements(burst_models);
+    // the models of the burst are now only owned by the Repredictor
+    burst_models.clear();
+
+    const auto sc_default = rep_default.predictTo(stamp);
+    const auto sc_models = rep_models.predictTo(stamp);
+    EXPECT_DOUBLE_EQ((sc_default.x-sc_models.x).norm(), 0.0);
+    EXPECT_DOUBLE_EQ((sc_default.P-sc_models.P).norm(), 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, rts_smoothing) //{ */
+
+TEST(TESTSuite, rts_smoothing)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_infos = 2e2;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf, n_infos+1);
+
+  // run a standard forward LKF pass while filling the Repredictor
+  std::vector<statecov_t> filts = {{x0, P0, t0}};
+  std::vector<statecov_t> preds = {{x0, P0, t0}};
+  std::vector<A_t> As = {A_t::Identity()};
+  u_t u = u0;
+  ros::Time stamp = t0;
+  for (int it = 0; it < n_infos; it++)
+  {
+    const double dt = 0.01 + std::abs(d(gen))*0.1;
+    stamp += ros::Duration(dt);
+    As.push_back(generateA(dt));
+    preds.push_back(lkf->predict(filts.back(), u, Q, dt));
+    if (d(gen) > 0.0)
+    {
+      const z_t z = z_t::Random();
+      rep.addMeasurement(z, R, stamp);
+      filts.push_back(lkf->correct(preds.back(), z, R));
+    }
+    else
+    {
+      u = u_t::Random();
+      rep.addInputChangeWithNoise(u, Q, stamp);
+      filts.push_back(preds.back());
+    }
+  }
+
+  // run a standard backward RTS pass
+  std::vector<statecov_t> smooths(filts.size());
+  smooths.back() = filts.back();
+  for (int it = (int)filts.size()-2; it >= 0; it--)
+  {
+    const P_t C = filts.at(it).P * As.at(it+1).transpose() * preds.at(it+1).P.inverse();
+    smooths.at(it).x = filts.at(it).x + C*(smooths.at(it+1).x - preds.at(it+1).x);
+    smooths.at(it).P = filts.at(it).P + C*(smooths.at(it+1).P - preds.at(it+1).P)*C.transpose();
+  }
+
+  const auto rep_smooths = rep.smooth();
+  ASSERT_EQ(rep_smooths.size(), smooths.size());
+  for (size_t it = 0; it < smooths.size(); it++)
+  {
+    EXPECT_NEAR((smooths.at(it).x-rep_smooths.at(it).x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((smooths.at(it).P-rep_smooths.at(it).P).norm(), 0.0, 1e-6);
+  }
+
+  // check that a shorter lag only returns the newer part of the smoothed history
+  const auto rep_smooths_lag = rep.smooth(stamp - ros::Duration(1.0));
+  ASSERT_LE(rep_smooths_lag.size(), rep_smooths.size());
+  for (size_t it = 0; it < rep_smooths_lag.size(); it++)
+  {
+    const auto& smooth = rep_smooths.at(rep_smooths.size() - rep_smooths_lag.size() + it);
+    EXPECT_GE(rep_smooths_lag.at(it).stamp, stamp - ros::Duration(1.0));
+    EXPECT_DOUBLE_EQ((smooth.x-rep_smooths_lag.at(it).x).norm(), 0.0);
+    EXPECT_DOUBLE_EQ((smooth.P-rep_smooths_lag.at(it).P).norm(), 0.0);
+  }
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,197 @@
+#include <mrs_lib/scope_timer.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+using namespace mrs_lib;
+using namespace std;
+
+// returns the lines of a text file
+std::vector<std::string> readLines(const std::string& path)
+{
+  std::ifstream file(path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(file, line))
+    lines.push_back(line);
+  return lines;
+}
+
+/* TEST(TESTSuite, binary_logger_test) //{ */
+
+TEST(TESTSuite, binary_logger_test)
+{
+  const std::string dir = std::filesystem::temp_directory_path().string();
+  const std::string csv_path = dir + "/scope_timer_test.csv";
+  const std::string binary_path = dir + "/scope_timer_test.bin";
+  const std::string converted_path = dir + "/scope_timer_test_converted.csv";
+
+  // log the same times using both loggers
+  {
+    const auto csv_logger = std::make_shared<mrs_lib::ScopeTimerLogger>(csv_path, true, 6);
+    const auto binary_logger = std::make_shared<mrs_lib::ScopeTimerLogger>(binary_path, true, 6, true);
+    ASSERT_TRUE(csv_logger->loggingEnabled());
+    ASSERT_TRUE(binary_logger->loggingEnabled());
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int it = 0; it < 100; it++)
+    {
+      const auto t1 = t0 + std::chrono::microseconds(137 * it);
+      const auto t2 = t1 + std::chrono::nanoseconds(12345 * it);
+      for (const auto& logger : {csv_logger, binary_logger})
+      {
+        logger->log("scope " + std::to_string(it % 3), "from", "to " + std::to_string(it % 7), t1, t2);
+        logger->log("scope " + std::to_string(it % 3), t0, t2);
+      }
+    }
+
+    // the interned labels may be used in both modes
+    for (const auto& logger : {csv_logger, binary_logger})
+      logger->log(logger->internLabel("interned scope"), logger->internLabel(""), logger->internLabel("interned label"), t0, t0 + std::chrono::seconds(1));
+  }
+
+  ASSERT_TRUE(mrs_lib::ScopeTimerLogger::convertToCsv(binary_path, converted_path, 6));
+  const auto csv_lines = readLines(csv_path);
+  const auto converted_lines = readLines(converted_path);
+  EXPECT_EQ(csv_lines.size(), 202u);
+  EXPECT_EQ(csv_lines, converted_lines);
+
+  // the records of multiple threads (including ScopeTimer checkpoints) are all written
+  const int n_threads = 4;
+  const int n_timers = 500;
+  {
+    const auto binary_logger = std::make_shared<mrs_lib::ScopeTimerLogger>(binary_path, true, 6, true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++)
+    {
+      threads.emplace_back([&binary_logger, t]() {
+        for (int it = 0; it < n_timers; it++)
+        {
+          mrs_lib::ScopeTimer timer("thread " + std::to_string(t), binary_logger);
+          timer.checkpoint("checkpoint");
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  ASSERT_TRUE(mrs_lib::ScopeTimerLogger::convertToCsv(binary_path, converted_path, 6));
+  const auto thread_lines = readLines(converted_path);
+  // the header and two lines per timer (the checkpoint and the whole scope)
+  EXPECT_EQ(thread_lines.size(), 1u + 2u * n_threads * n_timers);
+
+  // a thread may log into many successively created loggers (dropping the cached rings of the destroyed ones)
+  for (int it = 0; it < 100; it++)
+  {
+    {
+      const auto binary_logger = std::make_shared<mrs_lib::ScopeTimerLogger>(binary_path, true, 6, true);
+      const auto t0 = std::chrono::steady_clock::now();
+      binary_logger->log("scope", "from", "to", t0, t0);
+      binary_logger->log(binary_logger->internLabel("interned scope"), binary_logger->internLabel(""), binary_logger->internLabel(""), t0, t0);
+    }
+    ASSERT_TRUE(mrs_lib::ScopeTimerLogger::convertToCsv(binary_path, converted_path, 6));
+    ASSERT_EQ(readLines(converted_path).size(), 3u);
+  }
+
+  // conversion of a file, which is not a binary log, should fail
+  EXPECT_FALSE(mrs_lib::ScopeTimerLogger::convertToCsv(csv_path, converted_path));
+
+  std::filesystem::remove(csv_path);
+  std::filesystem::remove(binary_path);
+  std::filesystem::remove(converted_path);
+}
+
+//}
+
+/* TEST(TESTSuite, fast_scope_timer_test) //{ */
+
+TEST(TESTSuite, fast_scope_timer_test)
+{
+  const std::string dir = std::filesystem::temp_directory_path().string();
+  const std::string csv_path = dir + "/fast_scope_timer_test.csv";
+
+  // the interned labels are shared
+  const char* label = mrs_lib::FastScopeTimer::intern("dynamic " + std::to_string(42));
+  EXPECT_STREQ(label, "dynamic 42");
+  EXPECT_EQ(label, mrs_lib::FastScopeTimer::intern("dynamic 42"));
+
+  {
+    const auto logger = std::make_shared<mrs_lib::ScopeTimerLogger>(csv_path, true, 6);
+
+    // the checkpoints over the limit are ignored
+    mrs_lib::FastScopeTimer timer(label, logger);
+    for (size_t it = 0; it < mrs_lib::FastScopeTimer::max_checkpoints + 5; it++)
+      timer.checkpoint(it % 2 ? "odd" : "even");
+    EXPECT_GT(timer.getLifetime(), 0.0f);
+  }
+
+  const auto lines = readLines(csv_path);
+  // the header, the checkpoints and the whole scope
+  ASSERT_EQ(lines.size(), 1u + (mrs_lib::FastScopeTimer::max_checkpoints - 1) + 1u);
+  EXPECT_EQ(lines.at(1).substr(0, 17), "dynamic 42,,even,");
+  EXPECT_EQ(lines.at(2).substr(0, 20), "dynamic 42,even,odd,");
+  EXPECT_EQ(lines.back().substr(0, 13), "dynamic 42,,,");
+
+  // a buffer reused for another label is not mistaken for the previous label
+  {
+    const auto logger = std::make_shared<mrs_lib::ScopeTimerLogger>(csv_path, true, 6);
+    char buffer[16];
+    for (const char* text : {"first", "second"})
+    {
+      std::strcpy(buffer, text);
+      mrs_lib::FastScopeTimer timer(buffer, logger);
+    }
+  }
+  const auto reused_lines = readLines(csv_path);
+  ASSERT_EQ(reused_lines.size(), 3u);
+  EXPECT_EQ(reused_lines.at(1).substr(0, 6), "first,");
+  EXPECT_EQ(reused_lines.at(2).substr(0, 7), "second,");
+
+  // the same holds for the throttling table (both timers are printed)
+  for (const char* text : {"first throttled", "second throttled"})
+  {
+    char buffer[32];
+    std::strcpy(buffer, text);
+    mrs_lib::FastScopeTimer timer(buffer, ros::Duration(1000.0));
+  }
+
+  // the throttled timers may be used from multiple threads and are printed only once
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++)
+  {
+    threads.emplace_back([]() {
+      for (int it = 0; it < 1000; it++)
+      {
+        mrs_lib::FastScopeTimer timer("throttled", ros::Duration(1000.0));
+        timer.checkpoint("checkpoint");
+        mrs_lib::ScopeTimer slow_timer("throttled", ros::Duration(1000.0));
+        slow_timer.checkpoint("checkpoint");
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  std::filesystem::remove(csv_path);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  ros::init(argc, argv, "ScopeTimerTest");
+  ros::NodeHandle nh("~");
+
+  ros::Time::waitForValid();
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -1,6 +1,8 @@
 #include <geometry_msgs/PointStamped.h>
 #include <mrs_lib/subscribe_handler.h>
 #include <cmath>
+#include <atomic>
+#include <thread>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -108,6 +110,136 @@ TEST(TESTSuite, main_test) {
 
 //}
 
+/* TEST(TESTSuite, lockfree_test) //{ */
+
+TEST(TESTSuite, lockfree_test) {
+
+  ros::NodeHandle nh("~");
+
+  mrs_lib::SubscribeHandlerOptions shopts(nh);
+  shopts.lockfree = true;
+
+  const std::string topic_name = "/test_topic/lockfree";
+  mrs_lib::SubscribeHandler<geometry_msgs::PointStamped> sh(shopts, topic_name);
+
+  EXPECT_FALSE(sh.hasMsg());
+  EXPECT_FALSE(sh.newMsg());
+  EXPECT_FALSE(sh.usedMsg());
+  EXPECT_EQ(sh.peekMsg(), nullptr);
+  EXPECT_EQ(sh.waitForNew(ros::WallDuration(0.01)), nullptr);
+
+  ros::Publisher pub = nh.advertise<geometry_msgs::PointStamped>(topic_name, 100);
+
+  // spins until the condition holds or until the timeout runs out
+  const auto spin_until = [](const std::function<bool()>& condition) {
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(2.0);
+    while (!condition() && ros::WallTime::now() < end) {
+      ros::spinOnce();
+      ros::WallDuration(1e-3).sleep();
+    }
+    return condition();
+  };
+  ASSERT_TRUE(spin_until([&pub]() { return pub.getNumSubscribers() > 0; }));
+
+  // poll the handler from another thread while the messages are being received
+  std::atomic<bool> done = false;
+  bool monotonic = true;
+  std::thread poller([&sh, &done, &monotonic]() {
+    double last_x = 0.0;
+    while (!done) {
+      if (!sh.hasMsg())
+        continue;
+      const auto msg = sh.newMsg() ? sh.getMsg() : sh.peekMsg();
+      if (msg == nullptr || msg->point.x < last_x)
+        monotonic = false;
+      else
+        last_x = msg->point.x;
+    }
+  });
+
+  const int n_msgs = 100;
+  geometry_msgs::PointStamped msg;
+  for (int n = 1; n <= n_msgs; n++) {
+    msg.header.stamp = ros::Time::now();
+    msg.point.x = msg.point.y = msg.point.z = n;
+    pub.publish(msg);
+    spin_until([&sh, n]() { return sh.hasMsg() && sh.peekMsg()->point.x == n; });
+  }
+  done = true;
+  poller.join();
+
+  EXPECT_TRUE(monotonic);
+  ASSERT_TRUE(sh.hasMsg());
+  EXPECT_EQ(sh.peekMsg()->point.x, n_msgs);
+
+  // the flags should behave the same as with the mutexed implementation
+  msg.point.x = n_msgs + 1;
+  pub.publish(msg);
+  EXPECT_TRUE(spin_until([&sh]() { return sh.newMsg(); }));
+  EXPECT_EQ(sh.getMsg()->point.x, n_msgs + 1);
+  EXPECT_FALSE(sh.newMsg());
+  EXPECT_TRUE(sh.usedMsg());
+  EXPECT_GE(sh.lastMsgTime(), msg.header.stamp);
+  EXPECT_EQ(sh.waitForNew(ros::WallDuration(0.01)), nullptr);
+}
+
+//}
+
+/* TEST(TESTSuite, history_test) //{ */
+
+TEST(TESTSuite, history_test) {
+
+  ros::NodeHandle nh("~");
+
+  for (const bool lockfree : {false, true}) {
+    mrs_lib::SubscribeHandlerOptions shopts(nh);
+    shopts.lockfree       = lockfree;
+    shopts.history_length = 5;
+
+    const std::string topic_name = "/test_topic/history" + std::to_string(lockfree);
+    mrs_lib::SubscribeHandler<geometry_msgs::PointStamped> sh(shopts, topic_name);
+    EXPECT_EQ(sh.getMsgAt(ros::Time::now()), nullptr);
+    EXPECT_TRUE(sh.getMsgsInterval(ros::Time(0), ros::Time::now()).empty());
+
+    ros::Publisher pub = nh.advertise<geometry_msgs::PointStamped>(topic_name, 100);
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(2.0);
+    while (pub.getNumSubscribers() == 0 && ros::WallTime::now() < end) {
+      ros::spinOnce();
+      ros::WallDuration(1e-3).sleep();
+    }
+
+    // publish messages with stamps 0.1s apart, one of them out of order
+    const ros::Time t0 = ros::Time::now();
+    geometry_msgs::PointStamped msg;
+    for (const int n : {0, 1, 2, 3, 5, 4, 6, 7}) {
+      msg.header.stamp = t0 + ros::Duration(0.1 * n);
+      msg.point.x      = n;
+      pub.publish(msg);
+      const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(2.0);
+      while (!(sh.hasMsg() && sh.peekMsg()->point.x == n) && ros::WallTime::now() < end) {
+        ros::spinOnce();
+        ros::WallDuration(1e-3).sleep();
+      }
+    }
+
+    // only the five messages with the newest stamps should be kept
+    ASSERT_NE(sh.getMsgAt(t0), nullptr);
+    EXPECT_EQ(sh.getMsgAt(t0)->point.x, 3);
+    EXPECT_EQ(sh.getMsgAt(t0 + ros::Duration(0.42))->point.x, 4);
+    EXPECT_EQ(sh.getMsgAt(t0 + ros::Duration(0.48))->point.x, 5);
+    EXPECT_EQ(sh.getMsgAt(t0 + ros::Duration(10.0))->point.x, 7);
+
+    const auto msgs = sh.getMsgsInterval(t0 + ros::Duration(0.35), t0 + ros::Duration(0.6));
+    ASSERT_EQ(msgs.size(), 3u);
+    for (size_t it = 0; it < msgs.size(); it++)
+      EXPECT_EQ(msgs.at(it)->point.x, it + 4);
+    EXPECT_EQ(sh.getMsgsInterval(t0 + ros::Duration(0.3), t0 + ros::Duration(0.7)).size(), 5u);
+    EXPECT_TRUE(sh.getMsgsInterval(t0 + ros::Duration(0.71), t0 + ros::Duration(10.0)).empty());
+  }
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
   ros::init(argc, argv, "SubscribeHandlerTest");
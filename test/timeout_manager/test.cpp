@@ -7,6 +7,7 @@
 #include <gtest/gtest.h>
 #include <log4cxx/logger.h>
 #include <mutex>
+#include <thread>
 #include <mrs_lib/utils.h>
 
 using namespace mrs_lib;
@@ -252,6 +253,74 @@ TEST(TESTSuite, timeout_test)
   }
 }
 
+TEST(TESTSuite, many_timeouts_test)
+{
+  const ros::Duration update_period(0.001);
+  const ros::Duration test_dur(0.5);
+  const int n_timeouts = 3000;
+
+  mrs_lib::TimeoutManager tom_many(*nh, ros::Rate(update_period));
+  std::vector<int> n_cbks(n_timeouts, 0);
+  std::vector<ros::Duration> tos(n_timeouts);
+
+  // every third timeout is reset from another thread, every third is periodic and every third is oneshot
+  const ros::Time start = ros::Time::now();
+  for (int it = 0; it < n_timeouts; it++)
+  {
+    tos.at(it) = ros::Duration(0.02 + 0.01 * (it % 10));
+    const bool oneshot = it % 3 == 2;
+    const auto id = tom_many.registerNew(tos.at(it), [&n_cbks, it](const ros::Time&) { n_cbks.at(it)++; }, start, oneshot);
+    EXPECT_EQ(id, size_t(it));
+  }
+  EXPECT_THROW(tom_many.reset(n_timeouts), std::out_of_range);
+
+  std::atomic<bool> done = false;
+  std::thread resetter([&tom_many, &done, n_timeouts]()
+  {
+    while (!done)
+    {
+      const ros::Time now = ros::Time::now();
+      for (int it = 0; it < n_timeouts; it += 3)
+        tom_many.reset(it, now);
+      ros::Duration(0.001).sleep();
+    }
+  });
+
+  while (ros::Time::now() - start < test_dur)
+  {
+    ros::Duration(0.0001).sleep();
+    ros::spinOnce();
+  }
+  tom_many.pauseAll();
+  done = true;
+  resetter.join();
+
+  int n_wrong = 0;
+  for (int it = 0; it < n_timeouts; it++)
+  {
+    const double to_s = tos.at(it).toSec();
+    int min_cbks = 0;
+    int max_cbks = 0;
+    switch (it % 3)
+    {
+      case 1:
+        // each callback may be delayed by up to a few update periods
+        min_cbks = std::floor(test_dur.toSec() / (to_s + 3 * update_period.toSec())) - 1;
+        max_cbks = std::floor(test_dur.toSec() / to_s);
+        break;
+      case 2:
+        min_cbks = max_cbks = 1;
+        break;
+    }
+    if (n_cbks.at(it) < min_cbks || n_cbks.at(it) > max_cbks)
+    {
+      n_wrong++;
+      cout << "Timeout " << it << " (" << to_s << "s) called " << n_cbks.at(it) << " callbacks (expected " << min_cbks << " to " << max_cbks << ")" << std::endl;
+    }
+  }
+  EXPECT_EQ(n_wrong, 0);
+}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
   ros::init(argc, argv, "TimerTest");
@@ -163,6 +163,64 @@ TEST(TESTSuite, thread_timer_test)
 
 //}
 
+/* TEST(TESTSuite, thread_timer_drift_test) //{ */
+
+TEST(TESTSuite, thread_timer_drift_test)
+{
+  ros::NodeHandle nh("~");
+
+  struct drift_obj_t
+  {
+    std::atomic<int> n_cbks = 0;
+    std::atomic<int> long_cbk = -1;
+    void callback([[maybe_unused]] const ros::TimerEvent& evt)
+    {
+      // the callbacks take a considerable portion of the period, one of them even several periods
+      if (n_cbks++ == long_cbk)
+        ros::Duration(0.027).sleep();
+      else
+        ros::Duration(0.002).sleep();
+    }
+  };
+
+  drift_obj_t cbk_obj;
+  const ros::Duration period(0.005);
+  mrs_lib::ThreadTimer thread_timer(nh, period, &drift_obj_t::callback, &cbk_obj, false, false);
+
+  const ros::Duration test_dur(0.5);
+  thread_timer.start();
+  test_dur.sleep();
+  thread_timer.stop();
+
+  // the period should not be prolonged by the duration of the callbacks
+  const int expected_cbks = std::floor(test_dur.toSec() / period.toSec());
+  const auto stats = thread_timer.getStatistics();
+  cout << "\tcallbacks: " << cbk_obj.n_cbks << " (expected: " << expected_cbks << "), missed: " << stats.n_missed << ", lateness p50: " << stats.lateness_p50
+       << "s, p99: " << stats.lateness_p99 << "s, max: " << stats.max_lateness << "s" << std::endl;
+  EXPECT_GE(cbk_obj.n_cbks, expected_cbks - 3);
+  EXPECT_LE(cbk_obj.n_cbks, expected_cbks);
+  EXPECT_EQ(stats.n_callbacks, uint64_t(cbk_obj.n_cbks));
+  EXPECT_LT(stats.lateness_p50, period * 0.5);
+
+  // the deadlines missed during a long callback should be skipped and counted
+  thread_timer.resetStatistics();
+  cbk_obj.n_cbks = 0;
+  cbk_obj.long_cbk = 10;
+  thread_timer.start();
+  test_dur.sleep();
+  thread_timer.stop();
+  const auto stats_long = thread_timer.getStatistics();
+  cout << "\tcallbacks: " << cbk_obj.n_cbks << ", missed: " << stats_long.n_missed << std::endl;
+  EXPECT_GE(stats_long.n_missed, 4u);
+  EXPECT_GE(cbk_obj.n_cbks, expected_cbks - 4 - 3);
+  EXPECT_LE(cbk_obj.n_cbks, expected_cbks - 4);
+
+  // setting the affinity to the current CPU should always be possible
+  EXPECT_TRUE(thread_timer.setAffinity({sched_getcpu()}));
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
   ros::init(argc, argv, "TimerTest");
@@ -0,0 +1,162 @@
+#include <mrs_lib/tracer.h>
+#include <mrs_lib/scope_timer.h>
+#include <mrs_lib/profiler.h>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+using namespace mrs_lib;
+using namespace std;
+
+struct event_t
+{
+  std::string name;
+  double ts = 0.0;
+  double dur = 0.0;
+  long tid = 0;
+};
+
+// parses the complete events from a trace file written by the Tracer (one event per line)
+std::vector<event_t> readEvents(const std::string& path, std::string& first_line, std::string& last_line)
+{
+  std::ifstream file(path);
+  std::vector<event_t> events;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (first_line.empty())
+      first_line = line;
+    last_line = line;
+    if (line.find("\"ph\":\"X\"") == std::string::npos)
+      continue;
+    event_t event;
+    const size_t name_start = line.find("\"name\":\"") + 8;
+    event.name = line.substr(name_start, line.find('"', name_start) - name_start);
+    event.ts = std::stod(line.substr(line.find("\"ts\":") + 5));
+    event.dur = std::stod(line.substr(line.find("\"dur\":") + 6));
+    event.tid = std::stol(line.substr(line.find("\"tid\":") + 6));
+    events.push_back(event);
+  }
+  return events;
+}
+
+/* TEST(TESTSuite, tracer_test) //{ */
+
+TEST(TESTSuite, tracer_test)
+{
+  ros::NodeHandle nh("~");
+
+  const std::string dir = std::filesystem::temp_directory_path().string();
+  const std::string trace_path = dir + "/tracer_test.json";
+  const std::string other_trace_path = dir + "/tracer_test_other.json";
+  const std::string merged_path = dir + "/tracer_test_merged.json";
+
+  // nothing is recorded before the tracing starts
+  {
+    mrs_lib::FastScopeTimer timer("not traced");
+  }
+
+  ASSERT_TRUE(mrs_lib::Tracer::start(trace_path));
+  EXPECT_TRUE(mrs_lib::Tracer::enabled());
+
+  mrs_lib::Profiler profiler(nh, "TracerTest", false);
+  const auto traced_fcn = [&profiler]() {
+    mrs_lib::Routine routine = profiler.createRoutine("routine");
+    mrs_lib::ScopeTimer outer("outer", ros::Duration(1000.0));
+    ros::Duration(0.002).sleep();
+    outer.checkpoint("first");
+    {
+      mrs_lib::FastScopeTimer inner("inner", ros::Duration(1000.0));
+      ros::Duration(0.002).sleep();
+      inner.checkpoint("second");
+    }
+  };
+  std::thread thread(traced_fcn);
+  traced_fcn();
+  thread.join();
+
+  // the disabled timers are traced too, like the routines of a disabled profiler
+  {
+    mrs_lib::ScopeTimer timer("disabled", ros::Duration(0), false);
+    timer.checkpoint("disabled checkpoint");
+    mrs_lib::FastScopeTimer fast_timer("disabled fast", ros::Duration(0), false);
+    fast_timer.checkpoint("disabled fast checkpoint");
+  }
+
+  // the labels of a FastScopeTimer only have to outlive the timer
+  {
+    const std::string label = "temporary label";
+    mrs_lib::FastScopeTimer timer(label.c_str());
+  }
+
+  mrs_lib::Tracer::stop();
+  EXPECT_FALSE(mrs_lib::Tracer::enabled());
+
+  std::string first_line, last_line;
+  const auto events = readEvents(trace_path, first_line, last_line);
+  EXPECT_EQ(first_line, "[");
+  EXPECT_EQ(last_line, "]");
+
+  std::map<std::string, std::vector<event_t>> by_name;
+  for (const auto& event : events)
+    by_name[event.name].push_back(event);
+
+  EXPECT_EQ(by_name.count("not traced"), 0u);
+  EXPECT_EQ(by_name["temporary label"].size(), 1u);
+  for (const std::string name : {"disabled", "disabled checkpoint", "disabled fast", "disabled fast checkpoint"})
+    EXPECT_EQ(by_name[name].size(), 1u) << name;
+  // the routine, two scopes and their checkpoints in each thread
+  for (const std::string name : {"routine", "outer", "first", "inner", "second"})
+    EXPECT_EQ(by_name[name].size(), 2u) << name;
+
+  // the scopes of the same thread are nested
+  for (const auto& inner : by_name["inner"])
+  {
+    bool nested = false;
+    for (const auto& outer : by_name["outer"])
+      nested |= outer.tid == inner.tid && outer.ts <= inner.ts && inner.ts + inner.dur <= outer.ts + outer.dur;
+    EXPECT_TRUE(nested);
+    EXPECT_GT(inner.dur, 1500.0);
+  }
+  EXPECT_NE(by_name["outer"].at(0).tid, by_name["outer"].at(1).tid);
+
+  // the events are recorded in the system clock (in microseconds)
+  const double now_us = std::chrono::duration<double, std::micro>(std::chrono::system_clock::now().time_since_epoch()).count();
+  EXPECT_NEAR(by_name["outer"].at(0).ts, now_us, 10e6);
+
+  // the traces of multiple processes may be merged
+  ASSERT_TRUE(mrs_lib::Tracer::start(other_trace_path));
+  {
+    mrs_lib::FastScopeTimer timer("other");
+  }
+  mrs_lib::Tracer::stop();
+
+  ASSERT_TRUE(mrs_lib::Tracer::merge({trace_path, other_trace_path}, merged_path));
+  first_line.clear();
+  const auto merged_events = readEvents(merged_path, first_line, last_line);
+  EXPECT_EQ(merged_events.size(), events.size() + 1);
+  EXPECT_EQ(first_line, "[");
+  EXPECT_EQ(last_line, "]");
+
+  std::filesystem::remove(trace_path);
+  std::filesystem::remove(other_trace_path);
+  std::filesystem::remove(merged_path);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  ros::init(argc, argv, "TracerTest");
+  ros::NodeHandle nh("~");
+
+  ros::Time::waitForValid();
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
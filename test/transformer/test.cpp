@@ -3,6 +3,7 @@
 #include <mrs_lib/geometry/conversions.h>
 #include <mrs_lib/attitude_converter.h>
 #include <tf2_ros/transform_broadcaster.h>
+#include <tf2_ros/static_transform_broadcaster.h>
 #include <geometry_msgs/PointStamped.h>
 #include <geometry_msgs/Quaternion.h>
 
@@ -1013,6 +1014,104 @@ TEST(TESTSuite, default_frame_test)
 
 //}
 
+/* TEST(TESTSuite, cache_test) //{ */
+
+TEST(TESTSuite, cache_test)
+{
+
+  ROS_INFO("[%s]: Testing the transform cache", ros::this_node::getName().c_str());
+
+  auto tfr = mrs_lib::Transformer("Transformer_cache_test");
+  tfr.setDefaultPrefix("uav66");
+
+  // the reference results are looked up without the cache
+  auto tfr_uncached = mrs_lib::Transformer("Transformer_cache_test_uncached");
+  tfr_uncached.setDefaultPrefix("uav66");
+  tfr_uncached.setCaching(false);
+
+  // a static transform of a sensor mount
+  tf2_ros::StaticTransformBroadcaster static_bc;
+  Eigen::Isometry3d cam2rangefinder = Eigen::Isometry3d::Identity();
+  cam2rangefinder.translation() = vec3_t(0.1, 0.2, 0.3);
+  geometry_msgs::TransformStamped static_tf = tf2::eigenToTransform(cam2rangefinder);
+  static_tf.child_frame_id = "uav66/camera";
+  static_tf.header.frame_id = "uav66/rangefinder";
+  static_tf.header.stamp = ros::Time::now();
+  static_bc.sendTransform(static_tf);
+
+  const ros::Time t = ros::Time::now();
+  ASSERT_TRUE(wait_for_tf("camera", "rangefinder", tfr).has_value());
+  ASSERT_TRUE(wait_for_tf("camera", "rangefinder", tfr_uncached).has_value());
+  ASSERT_TRUE(wait_for_tf("camera", "local_origin", tfr, t, t).has_value());
+  ASSERT_TRUE(wait_for_tf("camera", "local_origin", tfr_uncached, t, t).has_value());
+
+  // the static transform is served from the cache at any time
+  const auto stats_before = tfr.getCacheStatistics();
+  for (int it = 0; it < 100; it++)
+  {
+    const ros::Time stamp = t + ros::Duration(0.01 * it);
+    const auto tf_opt = tfr.getTransform("camera", "rangefinder", stamp);
+    const auto tf_uncached_opt = tfr_uncached.getTransform("camera", "rangefinder", stamp);
+    ASSERT_TRUE(tf_opt.has_value());
+    ASSERT_TRUE(tf_uncached_opt.has_value());
+    EXPECT_EQ(Transformer::frame_from(tf_opt.value()), "uav66/camera");
+    EXPECT_EQ(Transformer::frame_to(tf_opt.value()), "uav66/rangefinder");
+    EXPECT_EQ(tf_opt->header.stamp, tf_uncached_opt->header.stamp);
+    EXPECT_NEAR((toEigen(tf_opt->transform.translation) - toEigen(tf_uncached_opt->transform.translation)).norm(), 0.0, 1e-9);
+  }
+
+  // the transformed data match the uncached transformation as well
+  geometry_msgs::PointStamped pt;
+  pt.header.frame_id = "camera";
+  pt.header.stamp = t;
+  pt.point.x = 1.0;
+  const auto pt_opt = tfr.transformSingle(pt, "rangefinder");
+  const auto pt_uncached_opt = tfr_uncached.transformSingle(pt, "rangefinder");
+  ASSERT_TRUE(pt_opt.has_value());
+  ASSERT_TRUE(pt_uncached_opt.has_value());
+  EXPECT_EQ(pt_opt->header.frame_id, pt_uncached_opt->header.frame_id);
+  EXPECT_NEAR((toEigen(pt_opt->point) - toEigen(pt_uncached_opt->point)).norm(), 0.0, 1e-9);
+
+  // the dynamic transform looked up repeatedly at the same time is cached as well
+  for (int it = 0; it < 10; it++)
+  {
+    const auto tf_opt = tfr.getTransform("camera", "local_origin", t);
+    const auto tf_uncached_opt = tfr_uncached.getTransform("camera", "local_origin", t);
+    ASSERT_TRUE(tf_opt.has_value());
+    ASSERT_TRUE(tf_uncached_opt.has_value());
+    EXPECT_EQ(tf_opt->header.stamp, t);
+    EXPECT_NEAR((toEigen(tf_opt->transform.translation) - toEigen(tf_uncached_opt->transform.translation)).norm(), 0.0, 1e-9);
+  }
+
+  const auto stats = tfr.getCacheStatistics();
+  EXPECT_EQ(stats.static_hits - stats_before.static_hits, 101u);
+  EXPECT_EQ(stats.dynamic_hits - stats_before.dynamic_hits, 10u);
+  EXPECT_EQ(stats.misses, stats_before.misses);
+  EXPECT_EQ(tfr_uncached.getCacheStatistics().static_hits, 0u);
+
+  // a republished static transform is used after the cache is cleared
+  cam2rangefinder.translation() = vec3_t(-1.0, 0.0, 0.0);
+  static_tf = tf2::eigenToTransform(cam2rangefinder);
+  static_tf.child_frame_id = "uav66/camera";
+  static_tf.header.frame_id = "uav66/rangefinder";
+  static_tf.header.stamp = ros::Time::now();
+  static_bc.sendTransform(static_tf);
+
+  std::optional<geometry_msgs::TransformStamped> tf_opt;
+  for (int it = 0; it < 20 && ros::ok(); it++)
+  {
+    ros::Duration(0.05).sleep();
+    tfr.clearCache();
+    tf_opt = tfr.getTransform("camera", "rangefinder");
+    if (tf_opt.has_value() && tf_opt->transform.translation.x < 0.0)
+      break;
+  }
+  ASSERT_TRUE(tf_opt.has_value());
+  EXPECT_NEAR(tf_opt->transform.translation.x, -1.0, 1e-9);
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
   // Set up ROS.
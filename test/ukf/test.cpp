@@ -1,4 +1,5 @@
 #include <mrs_lib/ukf.h>
+#include <mrs_lib/srukf.h>
 #include <mrs_lib/lkf.h>
 #include <random>
 #include <cmath>
@@ -6,6 +7,7 @@
 
 #include <gtest/gtest.h>
 #include <log4cxx/logger.h>
+#include <allocation_counting.h>
 
 using namespace mrs_lib;
 using namespace std;
@@ -17,6 +19,7 @@ namespace mrs_lib
   const int n_measurements = 2;
 
   using ukf_t = UKF<n_states, n_inputs, n_measurements>;
+  using srukf_t = SRUKF<n_states, n_inputs, n_measurements>;
   using lkf_t = LKF<n_states, n_inputs, n_measurements>;
 }  // namespace mrs_lib
 
@@ -35,6 +38,7 @@ using B_t = lkf_t::B_t;
 using H_t = lkf_t::H_t;
 
 template class mrs_lib::UKF<n_states, n_inputs, n_measurements>;
+template class mrs_lib::SRUKF<n_states, n_inputs, n_measurements>;
 template class mrs_lib::LKF<n_states, n_inputs, n_measurements>;
 
 H_t H;
@@ -210,6 +214,185 @@ TEST(TESTSuite, main_test) {
 
 //}
 
+/* TEST(TESTSuite, srukf_test) //{ */
+
+TEST(TESTSuite, srukf_test) {
+
+  const double alpha = 1e-3;
+  const double kappa = 0;
+  const double beta = 2;
+  const double dt = 0.1;
+
+  Q_t Q;
+  Q << 1e-3, 0, 0, 0, 0, 1e-3, 0, 0, 0, 0, 1e-2, 0, 0, 0, 0, 1e-2;
+  R_t R;
+  R << 1e-2, 2e-3, 2e-3, 1e-2;
+  H << 1, 0, 0, 0, 0, 1, 0, 0;
+
+  // a linear constant-velocity model, for which the SRUKF should produce the same results as the LKF
+  // (the LKF scales the process noise by dt, while the UKF variants do not)
+  A_t A;
+  A << 1, 0, dt, 0,
+       0, 1, 0, dt,
+       0, 0, 1, 0,
+       0, 0, 0, 1;
+  B_t B;
+  B << 0, 0, dt, dt;
+  const tra_model_t lin_tra_model = [&A, &B](const x_t& x, const u_t& u, const double) -> x_t { return A * x + B * u; };
+  const obs_model_t obs_model(obs_model_f);
+
+  const lkf_t lkf(A, B, H);
+  const srukf_t srukf(lin_tra_model, obs_model, alpha, kappa, beta);
+  const srukf_t srukf_nonlin(tra_model_t(tra_model_f), obs_model, alpha, kappa, beta);
+
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  x_t x0;
+  x0 << 1.0, -2.0, 0.3, 5.0;
+  const P_t P0 = P_t::Identity();
+
+  lkf_t::statecov_t lsc{x0, P0};
+  srukf_t::sqrt_statecov_t ssc = srukf_t::toSqrtStatecov({x0, P0});
+  srukf_t::statecov_t nsc{x0, P0};
+  srukf_t::sqrt_statecov_t nssc = srukf_t::toSqrtStatecov({x0, P0});
+  double max_lin_diff = 0.0;
+  double max_nonlin_diff = 0.0;
+  for (int it = 0; it < 200; it++)
+  {
+    const u_t u(0.1 * nd(gen));
+    const z_t z = (z_t() << nd(gen), nd(gen)).finished();
+
+    lsc = lkf.correct(lkf.predict(lsc, u, Q / dt, dt), z, R);
+    ssc = srukf.correct(srukf.predict(ssc, u, Q, dt), z, R);
+    const auto sc = srukf_t::fromSqrtStatecov(ssc);
+    max_lin_diff = std::max(max_lin_diff, (sc.x - lsc.x).cwiseAbs().maxCoeff());
+    max_lin_diff = std::max(max_lin_diff, (sc.P - lsc.P).cwiseAbs().maxCoeff());
+    // the factor has to stay lower-triangular
+    EXPECT_TRUE(ssc.S.isLowerTriangular(0.0));
+
+    // the full-covariance API should produce the same results as the square-root one for a nonlinear model
+    nsc = srukf_nonlin.correct(srukf_nonlin.predict(nsc, u, Q, dt), z, R);
+    nssc = srukf_nonlin.correct(srukf_nonlin.predict(nssc, u, Q, dt), z, R);
+    const auto nsc2 = srukf_t::fromSqrtStatecov(nssc);
+    max_nonlin_diff = std::max(max_nonlin_diff, (nsc.x - nsc2.x).cwiseAbs().maxCoeff());
+    max_nonlin_diff = std::max(max_nonlin_diff, (nsc.P - nsc2.P).cwiseAbs().maxCoeff());
+  }
+
+  EXPECT_LT(max_lin_diff, 1e-6);
+  EXPECT_LT(max_nonlin_diff, 1e-6);
+
+  // a non-positive-definite covariance cannot be factorized
+  EXPECT_THROW(srukf.predict(srukf_t::statecov_t{x0, -P0}, u_t::Zero(), Q, dt), srukf_t::square_root_exception);
+}
+
+//}
+
+/* TEST(TESTSuite, workspace_allocations) //{ */
+
+TEST(TESTSuite, workspace_allocations) {
+
+  using dukf_t = UKF<-1, -1, -1>;
+  const double dt = 0.1;
+
+  // the in-place variant of the nonlinear model from the main test
+  const dukf_t::transition_model_inplace_t tra_model = [](const dukf_t::x_t& x, const dukf_t::u_t& u, const double dt, dukf_t::x_t& ret)
+  {
+    ret(x_x) = x(x_x) + dt * std::cos(x(x_alpha)) * x(x_speed);
+    ret(x_y) = x(x_y) + dt * std::sin(x(x_alpha)) * x(x_speed);
+    ret(x_alpha) = x(x_alpha) + dt * u(u_alpha);
+    ret(x_speed) = x(x_speed);
+  };
+  const dukf_t::observation_model_inplace_t obs_model = [](const dukf_t::x_t& x, dukf_t::z_t& ret)
+  {
+    ret = x.head(n_measurements);
+  };
+
+  dukf_t ukf;
+  ukf.setConstants(1e-3, 0, 2);
+  ukf.setTransitionModelInPlace(tra_model);
+  ukf.setObservationModelInPlace(obs_model);
+
+  // the same filter with fixed sizes as a reference
+  const ukf_t ukf_ref(tra_model_f, obs_model_f, 1e-3, 0, 2);
+  H << 1, 0, 0, 0, 0, 1, 0, 0;
+
+  dukf_t::statecov_t sc{dukf_t::x_t(n_states), dukf_t::P_t::Identity(n_states, n_states)};
+  sc.x << 1.0, -2.0, 0.3, 5.0;
+  ukf_t::statecov_t sc_ref{sc.x, sc.P};
+  const dukf_t::Q_t Q = 1e-2 * dukf_t::Q_t::Identity(n_states, n_states);
+  const dukf_t::R_t R = 1e-2 * dukf_t::R_t::Identity(n_measurements, n_measurements);
+  const dukf_t::u_t u = dukf_t::u_t::Constant(n_inputs, 0.1);
+  dukf_t::z_t z(n_measurements);
+
+  dukf_t::workspace_t ws(n_states, n_measurements);
+  ukf_t::workspace_t ws_ref;
+  std::mt19937 gen(42);
+  std::normal_distribution<> nd(0.0, 1.0);
+
+  double max_diff = 0.0;
+  size_t allocations = 0;
+  for (int it = 0; it < 100; it++)
+  {
+    z << nd(gen), nd(gen);
+
+    const size_t allocations_start = n_allocations;
+    ukf.predictInPlace(sc, u, Q, dt, ws);
+    ukf.correctInPlace(sc, z, R, ws);
+    allocations += n_allocations - allocations_start;
+
+    sc_ref = ukf_ref.predict(sc_ref, u, Q, dt);
+    ukf_ref.correctInPlace(sc_ref, z, R, ws_ref);
+    max_diff = std::max(max_diff, (sc.x - sc_ref.x).cwiseAbs().maxCoeff());
+    max_diff = std::max(max_diff, (sc.P - sc_ref.P).cwiseAbs().maxCoeff());
+  }
+
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_LT(max_diff, 1e-9);
+}
+
+//}
+
+/* TEST(TESTSuite, kalman_gain_override) //{ */
+
+// a filter ignoring all measurements by customizing the Kalman gain
+class zero_gain_ukf_t : public ukf_t
+{
+public:
+  using ukf_t::ukf_t;
+
+protected:
+  K_t computeKalmanGain([[maybe_unused]] const x_t& x, [[maybe_unused]] const z_t& inn, [[maybe_unused]] const K_t& Pxz, [[maybe_unused]] const Pzz_t& Pzz) const override
+  {
+    return K_t::Zero();
+  }
+
+  void computeKalmanGain(const x_t& x, workspace_t& ws) const override
+  {
+    ws.K = computeKalmanGain(x, ws.inn, ws.Pxz, ws.Pzz);
+  }
+};
+
+TEST(TESTSuite, kalman_gain_override) {
+
+  const zero_gain_ukf_t ukf(tra_model_f, obs_model_f, 1e-3, 0, 2);
+
+  ukf_t::statecov_t sc{ukf_t::x_t(1.0, -2.0, 0.3, 5.0), ukf_t::P_t::Identity()};
+  const ukf_t::R_t R = 1e-2 * ukf_t::R_t::Identity();
+  const ukf_t::z_t z(10.0, 10.0);
+
+  // the overridden gain has to be used by both variants of the correction
+  const auto sc_corr = ukf.correct(sc, z, R);
+  EXPECT_TRUE(sc_corr.x.isApprox(sc.x));
+
+  ukf_t::workspace_t ws;
+  const ukf_t::x_t x_orig = sc.x;
+  ukf.correctInPlace(sc, z, R, ws);
+  EXPECT_TRUE(sc.x.isApprox(x_orig));
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
   testing::InitGoogleTest(&argc, argv);